@@ -0,0 +1,274 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// benchmark runner, runs every benchmark or just the ones named on the command line
+
+#define ENET_IMPLEMENTATION
+#include "net_common.h"
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+// all the benchmarks we know about
+static Benchmark Benchmarks[] =
+{
+	{ "rate", "adaptive send rate over a constrained link", BenchRateControl },
+	{ "movement", "server movement step over a large world", BenchMovement },
+	{ "primitives", "packet reading, creation, sending and round trips", BenchPrimitives },
+	{ "batching", "snapshots as one packet per message or one batched packet", BenchBatching },
+	{ "priority", "snapshot priority accumulation over a large world", BenchPriority },
+	{ "lod", "snapshot bandwidth with distance based level of detail", BenchLod },
+	{ "join", "time for a new player to get the whole world", BenchJoin },
+	{ "connect", "connect floods with and without connect cookies", BenchConnect },
+	{ "reconnect", "4000 clients connecting to one server at once", BenchReconnect },
+	{ "resume", "time to get back into the game after a drop, with and without a session", BenchResume },
+	{ "client", "the headless client reconnecting with a new host and a kept one, and its network stats", BenchClient },
+	{ "world", "getting every visible entity for drawing, per id and in one bulk call", BenchWorldState },
+	{ "resolve", "looking up the server address on a worker thread, and from the cache", BenchResolve },
+	{ "latest", "queue depth and position age for a slow client, with and without latest only sends", BenchLatest },
+	{ "backpressure", "a client that stalls, with and without backpressure cutting back and then disconnecting it", BenchBackpressure },
+};
+
+#define BenchmarkCount (sizeof(Benchmarks) / sizeof(Benchmarks[0]))
+
+bool BenchCsv = false;
+
+uint64_t BenchAllocations = 0;
+uint64_t BenchAllocatedBytes = 0;
+
+double BenchNow()
+{
+	return GetPreciseTime();
+}
+
+void BenchYield()
+{
+#ifdef _WIN32
+	Sleep(0);
+#else
+	sched_yield();
+#endif
+}
+
+void BenchPrintf(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vfprintf(BenchCsv ? stderr : stdout, format, args);
+	va_end(args);
+}
+
+bool ConnectLoopback(LoopbackPair* pair)
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+	address.port = 0;
+
+	pair->Server = enet_host_create(&address, 1, 1, 0, 0);
+	pair->Client = enet_host_create(NULL, 1, 1, 0, 0);
+	if (pair->Server == NULL || pair->Client == NULL)
+		return false;
+
+	enet_socket_get_address(pair->Server->socket, &address);
+	pair->ClientPeer = enet_host_connect(pair->Client, &address, 1, 0);
+	if (pair->ClientPeer == NULL)
+		return false;
+
+	double start = BenchNow();
+	while (BenchNow() - start < LoopbackTimeout && (pair->ServerPeer == NULL || pair->ClientPeer->state != ENET_PEER_STATE_CONNECTED))
+	{
+		ENetEvent event = { 0 };
+		if (enet_host_service(pair->Server, &event, 1) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
+			pair->ServerPeer = event.peer;
+		enet_host_service(pair->Client, &event, 1);
+	}
+
+	return pair->ServerPeer != NULL && pair->ClientPeer->state == ENET_PEER_STATE_CONNECTED;
+}
+
+void CloseLoopback(LoopbackPair* pair)
+{
+	if (pair->Client != NULL)
+		enet_host_destroy(pair->Client);
+	if (pair->Server != NULL)
+		enet_host_destroy(pair->Server);
+
+	pair->Client = NULL;
+	pair->Server = NULL;
+}
+
+void DrainHost(ENetHost* host)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(host, &event, 0) > 0)
+	{
+		if (event.type == ENET_EVENT_TYPE_RECEIVE)
+			enet_packet_destroy(event.packet);
+	}
+}
+
+size_t WriteConnectDatagram(uint8_t* data, uint32_t connectID)
+{
+	ENetProtocolHeader header = { 0 };
+	header.peerID = ENET_HOST_TO_NET_16(ENET_PROTOCOL_MAXIMUM_PEER_ID);
+
+	ENetProtocolConnect connect = { 0 };
+	connect.header.command = ENET_PROTOCOL_COMMAND_CONNECT | ENET_PROTOCOL_COMMAND_FLAG_ACKNOWLEDGE;
+	connect.header.channelID = 0xFF;
+	connect.header.reliableSequenceNumber = ENET_HOST_TO_NET_16(1);
+	connect.incomingSessionID = 0xFF;
+	connect.outgoingSessionID = 0xFF;
+	connect.mtu = ENET_HOST_TO_NET_32(ENET_HOST_DEFAULT_MTU);
+	connect.windowSize = ENET_HOST_TO_NET_32(ENET_PROTOCOL_MAXIMUM_WINDOW_SIZE);
+	connect.channelCount = ENET_HOST_TO_NET_32(1);
+	connect.packetThrottleInterval = ENET_HOST_TO_NET_32(ENET_PEER_PACKET_THROTTLE_INTERVAL);
+	connect.packetThrottleAcceleration = ENET_HOST_TO_NET_32(ENET_PEER_PACKET_THROTTLE_ACCELERATION);
+	connect.packetThrottleDeceleration = ENET_HOST_TO_NET_32(ENET_PEER_PACKET_THROTTLE_DECELERATION);
+	connect.connectID = connectID;
+
+	// only the peer id goes in the header, there is no sent time
+	size_t headerSize = sizeof(header.peerID);
+	memcpy(data, &header, headerSize);
+	memcpy(data + headerSize, &connect, sizeof(connect));
+	return headerSize + sizeof(connect);
+}
+
+// enet allocates through these, so the benchmarks can see how much each operation allocates
+static void* ENET_CALLBACK BenchMalloc(size_t size)
+{
+	BenchAllocations++;
+	BenchAllocatedBytes += size;
+	return malloc(size);
+}
+
+static void ENET_CALLBACK BenchFree(void* memory)
+{
+	free(memory);
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+	double left = *(const double*)a;
+	double right = *(const double*)b;
+	return (left > right) - (left < right);
+}
+
+void BenchMeasure(const char* group, const char* name, BenchOperation operation, void* context)
+{
+	// warm up caches and let anything lazy get set up
+	operation(context, 1);
+
+	// find how many operations fill a run, so short operations aren't lost in the timer resolution
+	int count = 1;
+	for (;;)
+	{
+		double start = BenchNow();
+		operation(context, count);
+		double elapsed = BenchNow() - start;
+
+		if (elapsed >= BenchMinRunTime || count >= (1 << 30))
+			break;
+
+		count *= 2;
+	}
+
+	double nsPerOp[BenchRuns] = { 0 };
+	uint64_t allocations = BenchAllocations;
+	uint64_t bytes = BenchAllocatedBytes;
+
+	for (int run = 0; run < BenchRuns; run++)
+	{
+		double start = BenchNow();
+		operation(context, count);
+		nsPerOp[run] = (BenchNow() - start) * 1000000000.0 / count;
+	}
+
+	double ops = (double)count * BenchRuns;
+	double allocsPerOp = (BenchAllocations - allocations) / ops;
+	double bytesPerOp = (BenchAllocatedBytes - bytes) / ops;
+
+	// the median is what we report, the spread shows how noisy the runs were
+	qsort(nsPerOp, BenchRuns, sizeof(double), CompareDoubles);
+	double median = nsPerOp[BenchRuns / 2];
+
+	if (BenchCsv)
+		printf("%s,%s,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d\n", group, name, median, nsPerOp[0], nsPerOp[BenchRuns - 1], allocsPerOp, bytesPerOp, count, BenchRuns);
+	else
+		printf("%-28s %12.2f ns/op  (%.2f - %.2f)  %8.2f allocs/op  %10.1f bytes/op\n", name, median, nsPerOp[0], nsPerOp[BenchRuns - 1], allocsPerOp, bytesPerOp);
+}
+
+int main(int argc, char* argv[])
+{
+	ENetCallbacks callbacks = { 0 };
+	callbacks.malloc = BenchMalloc;
+	callbacks.free = BenchFree;
+
+	if (enet_initialize_with_callbacks(ENET_VERSION, &callbacks) != 0)
+		return 1;
+
+	// with no benchmark names we run everything, otherwise only what was asked for
+	bool runAll = true;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], "--csv") == 0)
+			BenchCsv = true;
+		else
+			runAll = false;
+	}
+
+	if (BenchCsv)
+		printf("group,name,ns_per_op,min_ns_per_op,max_ns_per_op,allocs_per_op,bytes_per_op,ops_per_run,runs\n");
+
+	for (size_t i = 0; i < BenchmarkCount; i++)
+	{
+		bool run = runAll;
+		for (int arg = 1; arg < argc; arg++)
+		{
+			if (strcmp(argv[arg], Benchmarks[i].Name) == 0)
+				run = true;
+		}
+
+		if (!run)
+			continue;
+
+		BenchPrintf("== %s : %s\n", Benchmarks[i].Name, Benchmarks[i].Description);
+		Benchmarks[i].Run();
+	}
+
+	enet_deinitialize();
+	return 0;
+}
@@ -0,0 +1,167 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// benchmarks for the networking systems
+// these run without a window so they can be used on build machines and compared between changes
+#pragma once
+
+#include "net_common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// one benchmark that can be run by name from the command line
+typedef struct
+{
+	const char* Name;
+	const char* Description;
+	void (*Run)();
+}Benchmark;
+
+// an operation that BenchMeasure times, it should do whatever it measures count times
+typedef void (*BenchOperation)(void* context, int count);
+
+// how many timed runs BenchMeasure does of each operation, the median is reported
+#define BenchRuns 9
+
+// how long each timed run should take at least, the number of operations per run is picked to fill this
+#define BenchMinRunTime 0.02
+
+// true when results should be printed as CSV rows instead of a table (--csv on the command line)
+extern bool BenchCsv;
+
+// every allocation enet makes while benchmarks run is counted here
+extern uint64_t BenchAllocations;
+extern uint64_t BenchAllocatedBytes;
+
+// the current time in seconds from a high resolution clock, for timing benchmarks
+double BenchNow();
+
+// give up the rest of this thread's time slice, for loops that wait on another thread or another host, on a machine with one core spinning would starve them
+void BenchYield();
+
+// print information that isn't a result, when printing CSV this goes to stderr so the results can be piped straight to a file
+void BenchPrintf(const char* format, ...);
+
+// how long to wait for the loopback connection to come up, or a message to arrive over it, in seconds
+#define LoopbackTimeout 2.0
+
+// a client and server host talking to each other over loopback
+typedef struct
+{
+	ENetHost* Server;
+	ENetHost* Client;
+	ENetPeer* ServerPeer;
+	ENetPeer* ClientPeer;
+}LoopbackPair;
+
+/// <summary>
+/// Make a server and client host on loopback and connect them
+/// </summary>
+/// <param name="pair">Filled out with the hosts and the peers on each end</param>
+/// <returns>True if they connected, call CloseLoopback either way</returns>
+bool ConnectLoopback(LoopbackPair* pair);
+
+/// <summary>
+/// Destroy the hosts of a loopback pair
+/// </summary>
+/// <param name="pair">The pair to close</param>
+void CloseLoopback(LoopbackPair* pair);
+
+/// <summary>
+/// Read everything that has arrived at a host and throw it away
+/// </summary>
+/// <param name="host">The host to read from</param>
+void DrainHost(ENetHost* host);
+
+// the most a connect datagram written by WriteConnectDatagram can take
+#define ConnectDatagramSize (sizeof(ENetProtocolHeader) + sizeof(ENetProtocolConnect))
+
+/// <summary>
+/// Write a connect datagram the way enet_host_connect makes one, for sending from a plain socket to connects that never finish
+/// </summary>
+/// <param name="data">Where to write it, at least ConnectDatagramSize bytes</param>
+/// <param name="connectID">The connect ID, a new one each time so none of them look like a resend</param>
+/// <returns>The size of the datagram</returns>
+size_t WriteConnectDatagram(uint8_t* data, uint32_t connectID);
+
+/// <summary>
+/// Time an operation and print how long it takes, and how much enet allocates, for each time it is done.
+/// The operation is run once to warm up, then enough times per run to fill BenchMinRunTime, then BenchRuns runs are timed
+/// </summary>
+/// <param name="group">The benchmark this result is part of</param>
+/// <param name="name">The name of the operation</param>
+/// <param name="operation">The function that does the operation</param>
+/// <param name="context">Passed through to the operation</param>
+void BenchMeasure(const char* group, const char* name, BenchOperation operation, void* context);
+
+// simulates a bandwidth limited link and shows how the rate controller keeps latency in check
+void BenchRateControl();
+
+// moves a world full of entities with the server movement step
+void BenchMovement();
+
+// the small things every message goes through: reading, packet create and destroy, sending, and a loopback round trip
+void BenchPrimitives();
+
+// snapshots sent as one packet per message against one batched packet
+void BenchBatching();
+
+// building up snapshot priority over a large world and picking what to send
+void BenchPriority();
+
+// snapshot bandwidth with and without distance based level of detail
+void BenchLod();
+
+// how long it takes a new player to get the whole world, as AddPlayer packets, batched messages, and join snapshots
+void BenchJoin();
+
+// a flood of connects that never finish, with and without connect cookies
+void BenchConnect();
+
+// thousands of clients connecting to one server at once, the way they do after a restart
+void BenchReconnect();
+
+// getting back into the game after a connection drops, as a new player and by resuming the session
+void BenchResume();
+
+// looking up the server address without stalling the game loop
+void BenchResolve();
+
+// the real client code reconnecting after a drop, with and without keeping its enet host
+void BenchClient();
+
+// copying the visible entities out for drawing, one id at a time and in one call
+void BenchWorldState();
+
+// sending positions to a slow client with plain reliable sends and with latest only sends
+void BenchLatest();
+
+// a client that stalls, with plain sends and with backpressure cutting its updates back and then disconnecting it
+void BenchBackpressure();
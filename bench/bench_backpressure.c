@@ -0,0 +1,417 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// backpressure on a stalled client
+// a server sends the position of every entity every tick to a few clients, and after a second one of them stalls
+// it only reads its socket every so often over a link with one datagram in flight, so it can't take anything like what the server sends
+// with plain sends everything for it queues up for as long as it stays connected
+// with backpressure each client goes through the same checks as a player on the server (server_backpressure.c), so the stalled client's updates are cut back and then it is disconnected
+// this reports how much waits for the stalled client, how long it takes to be dealt with, and what the healthy clients get while it happens
+
+#include "net_common.h"
+#include "net_batch.h"
+#include "net_rate.h"
+#include "server_backpressure.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// how many clients there are, the last one is the one that stalls
+#define PressureClients 4
+#define StalledClient (PressureClients - 1)
+
+// how many entities the server sends every tick, and how fast it ticks
+#define PressureEntities 64
+#define PressureTickRate 60.0
+
+// how long each run is, and how far into it the client stalls, in seconds
+#define PressureRunTime 7.0
+#define StallStart 1.0
+
+// once stalled, the client only reads its socket this often, in seconds
+#define StallReadInterval 2.0
+
+// the stalled client is given up on after this long reduced, instead of the default, so the run doesn't take as long
+#define PressureSlowTimeout 3.0
+
+// each update is the command, the entity id and the tick it was sent on
+#define PressureMessageSize 6
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+typedef struct
+{
+	// the most that waited for the stalled client, the longest it would have taken to get through, and the longest anything waited
+	size_t BacklogMax;
+	uint32_t CommandsMax;
+	double DrainMax;
+	double WaitMax;
+
+	// how long the stalled client spent latest only and reduced, and how long after stalling it was disconnected, -1 if it wasn't
+	double LatestOnlyTime;
+	double ReducedTime;
+	double DisconnectTime;
+
+	// how old the positions the healthy clients have are, sampled every tick, in milliseconds, and how many updates they got
+	NetHistogram HealthyAge;
+	uint32_t HealthyDelivered;
+
+	// the time the server spent sending each tick
+	double SendTimeSum;
+	double SendTimeMax;
+	uint32_t Ticks;
+}PressureResult;
+
+// the newest tick each client has seen for each entity
+static uint32_t ClientTicks[PressureClients][PressureEntities];
+static bool ClientHas[PressureClients][PressureEntities];
+
+// read everything a client has, keeping the newest tick for each entity, returns how many updates it got
+static uint32_t ReceiveUpdates(ENetHost* host, int client)
+{
+	uint32_t delivered = 0;
+
+	ENetEvent event = { 0 };
+	while (enet_host_service(host, &event, 0) > 0)
+	{
+		if (event.type != ENET_EVENT_TYPE_RECEIVE)
+			continue;
+
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event.packet);
+
+		size_t offset = 0;
+		while (ReadNextMessage(&reader, &offset) > 0)
+		{
+			ReadByte(event.packet, &offset);
+			uint8_t id = ReadByte(event.packet, &offset);
+			uint32_t tick = (uint32_t)ReadInt(event.packet, &offset);
+			if (id >= PressureEntities)
+				continue;
+
+			delivered++;
+			if (!ClientHas[client][id] || tick > ClientTicks[client][id])
+				ClientTicks[client][id] = tick;
+			ClientHas[client][id] = true;
+		}
+
+		enet_packet_destroy(event.packet);
+	}
+
+	return delivered;
+}
+
+// send every entity's update for one tick to one peer, batched, or latest only with the entity as the key, the way the server finishes each update
+static void SendTick(ENetPeer* peer, bool latestOnly, uint32_t tick, MessageBatch* batch)
+{
+	uint8_t message[PressureMessageSize] = { (uint8_t)UpdatePlayer };
+	memcpy(message + 2, &tick, sizeof(tick));
+
+	for (int id = 0; id < PressureEntities; id++)
+	{
+		message[1] = (uint8_t)id;
+		BatchMessage(batch, peer, message, sizeof(message));
+		EndSnapshotUpdate(batch, peer, latestOnly, (uint32_t)id + 1);
+	}
+
+	FlushMessageBatch(batch, peer);
+}
+
+// make a server and connect every client to it, one at a time so we know which server peer goes with which client
+static bool ConnectClients(ENetHost** server, ENetHost* clients[PressureClients], ENetPeer* serverPeers[PressureClients])
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+	address.port = 0;
+
+	*server = enet_host_create(&address, PressureClients, 1, 0, 0);
+	if (*server == NULL)
+		return false;
+
+	enet_socket_get_address((*server)->socket, &address);
+
+	for (int c = 0; c < PressureClients; c++)
+	{
+		clients[c] = enet_host_create(NULL, 1, 1, 0, 0);
+		if (clients[c] == NULL)
+			return false;
+
+		ENetPeer* clientPeer = enet_host_connect(clients[c], &address, 1, 0);
+		if (clientPeer == NULL)
+			return false;
+
+		double start = BenchNow();
+		while (BenchNow() - start < LoopbackTimeout && (serverPeers[c] == NULL || clientPeer->state != ENET_PEER_STATE_CONNECTED))
+		{
+			ENetEvent event = { 0 };
+			if (enet_host_service(*server, &event, 1) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
+				serverPeers[c] = event.peer;
+			enet_host_service(clients[c], &event, 1);
+		}
+
+		if (serverPeers[c] == NULL || clientPeer->state != ENET_PEER_STATE_CONNECTED)
+			return false;
+	}
+
+	return true;
+}
+
+static void CloseClients(ENetHost* server, ENetHost* clients[PressureClients])
+{
+	for (int c = 0; c < PressureClients; c++)
+	{
+		if (clients[c] != NULL)
+			enet_host_destroy(clients[c]);
+	}
+
+	if (server != NULL)
+		enet_host_destroy(server);
+}
+
+// run the server and the clients, with or without backpressure on the server
+static bool RunPressureSession(bool backpressure, PressureResult* result)
+{
+	memset(result, 0, sizeof(PressureResult));
+	memset(ClientTicks, 0, sizeof(ClientTicks));
+	memset(ClientHas, 0, sizeof(ClientHas));
+	result->DisconnectTime = -1;
+
+	ENetHost* server = NULL;
+	ENetHost* clients[PressureClients] = { 0 };
+	ENetPeer* serverPeers[PressureClients] = { 0 };
+	if (!ConnectClients(&server, clients, serverPeers))
+	{
+		CloseClients(server, clients);
+		return false;
+	}
+
+	BackpressureConfig config = DefaultBackpressureConfig();
+	config.SlowTimeout = PressureSlowTimeout;
+
+	// the server checks every player's backpressure and rate controller before their snapshot
+	RateControlConfig rateConfig = DefaultRateControlConfig();
+	RateControl rates[PressureClients];
+	BackpressureControl controls[PressureClients];
+	bool connected[PressureClients];
+	for (int c = 0; c < PressureClients; c++)
+	{
+		InitRateControl(&rates[c], &rateConfig);
+		InitBackpressure(&controls[c]);
+		connected[c] = true;
+	}
+
+	static MessageBatch batch;
+	ResetMessageBatch(&batch);
+
+	double start = BenchNow();
+	double lastStalledRead = start;
+	bool stalled = false;
+	double lastTick = start - 1.0 / PressureTickRate;
+	uint32_t tick = 0;
+
+	while (BenchNow() - start < PressureRunTime)
+	{
+		double now = BenchNow();
+
+		// from here on the client barely reads, and enet only lets one datagram at a time go to it, as if it were on a very slow link
+		if (!stalled && now - start >= StallStart)
+		{
+			serverPeers[StalledClient]->windowSize = serverPeers[StalledClient]->mtu;
+			stalled = true;
+		}
+
+		// ticks are timed like the server's, at least a tick period apart, so the rate controller sees the same gaps it does there
+		if (now - lastTick >= 1.0 / PressureTickRate)
+		{
+			lastTick = now;
+			double sendStart = BenchNow();
+
+			for (int c = 0; c < PressureClients; c++)
+			{
+				if (!connected[c])
+					continue;
+
+				bool latestOnly = false;
+				if (backpressure)
+				{
+					// DropSlowPlayers on the server
+					if (CheckSlowPeer(&controls[c], &config, now, serverPeers[c]))
+					{
+						connected[c] = false;
+						if (c == StalledClient)
+							result->DisconnectTime = now - start - StallStart;
+						continue;
+					}
+
+					if (c == StalledClient && controls[c].Level == BackpressureLatestOnly)
+						result->LatestOnlyTime += 1.0 / PressureTickRate;
+					if (c == StalledClient && controls[c].Level == BackpressureReduced)
+						result->ReducedTime += 1.0 / PressureTickRate;
+
+					// and SendSnapshots
+					if (!BeginPeerSnapshot(&controls[c], &config, &rates[c], &rateConfig, now, serverPeers[c], &batch, &latestOnly))
+						continue;
+				}
+				else
+				{
+					// the server as it was, with only the rate controller
+					UpdateRateControl(&rates[c], &rateConfig, now, serverPeers[c]);
+					if (!RateControlShouldSend(&rates[c], now))
+						continue;
+				}
+
+				SendTick(serverPeers[c], latestOnly, tick, &batch);
+			}
+
+			enet_host_flush(server);
+
+			double sendTime = BenchNow() - sendStart;
+			result->SendTimeSum += sendTime;
+			if (sendTime > result->SendTimeMax)
+				result->SendTimeMax = sendTime;
+			result->Ticks++;
+
+			// how much is waiting for the stalled client
+			if (connected[StalledClient])
+			{
+				PeerBackpressure pressure = { 0 };
+				GetPeerBackpressure(serverPeers[StalledClient], &pressure);
+
+				size_t backlog = pressure.QueuedBytes + pressure.InTransitBytes;
+				uint32_t commands = pressure.QueuedCommands + pressure.InTransitCommands;
+				if (backlog > result->BacklogMax)
+					result->BacklogMax = backlog;
+				if (commands > result->CommandsMax)
+					result->CommandsMax = commands;
+				if (pressure.DrainTime > result->DrainMax)
+					result->DrainMax = pressure.DrainTime;
+				if (pressure.OldestWait > result->WaitMax)
+					result->WaitMax = pressure.OldestWait;
+			}
+
+			// and how old what the healthy clients have is
+			for (int c = 0; c < StalledClient; c++)
+			{
+				for (int id = 0; id < PressureEntities; id++)
+				{
+					if (ClientHas[c][id])
+						RecordHistogram(&result->HealthyAge, (uint32_t)((tick - ClientTicks[c][id]) * 1000.0 / PressureTickRate));
+				}
+			}
+
+			tick++;
+		}
+
+		DrainHost(server);
+
+		for (int c = 0; c < StalledClient; c++)
+			result->HealthyDelivered += ReceiveUpdates(clients[c], c);
+
+		if (!stalled || now - lastStalledRead >= StallReadInterval)
+		{
+			ReceiveUpdates(clients[StalledClient], StalledClient);
+			lastStalledRead = now;
+		}
+
+		// one core is enough for everyone, don't spin
+		BenchYield();
+	}
+
+	Sink += result->HealthyDelivered;
+
+	CloseClients(server, clients);
+	return true;
+}
+
+static void PrintPressureResult(const char* name, const PressureResult* result)
+{
+	uint32_t ticks = result->Ticks > 0 ? result->Ticks : 1;
+
+	char outcome[64];
+	if (result->DisconnectTime >= 0)
+		snprintf(outcome, sizeof(outcome), "disconnected %.1fs after stalling", result->DisconnectTime);
+	else
+		snprintf(outcome, sizeof(outcome), "still connected");
+
+	BenchPrintf("  %-12s stalled: max %7zu bytes, %5u commands, %5.1fs to drain, %4.1fs waited  latest only %.1fs, reduced %.1fs, %s\n", name,
+		result->BacklogMax, result->CommandsMax, result->DrainMax, result->WaitMax, result->LatestOnlyTime, result->ReducedTime, outcome);
+	BenchPrintf("  %-12s healthy: age %5.1fms (p99 %4u, max %4u), %5.0f updates a second each  sending %5.1fus a tick (max %6.1f)\n", "",
+		GetHistogramMean(&result->HealthyAge), GetHistogramPercentile(&result->HealthyAge, 99), result->HealthyAge.Max,
+		result->HealthyDelivered / (double)StalledClient / PressureRunTime, result->SendTimeSum / ticks * 1e6, result->SendTimeMax * 1e6);
+}
+
+// reads the backpressure of a peer over and over
+static void ReadPressure(void* context, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		PeerBackpressure pressure = { 0 };
+		GetPeerBackpressure((ENetPeer*)context, &pressure);
+		Sink += pressure.QueuedCommands;
+	}
+}
+
+void BenchBackpressure()
+{
+	BenchPrintf("%d entities at %.0f ticks a second to %d clients, after %.0f second one reads every %.0fms with one datagram in flight, %.0f seconds each, slow timeout %.0f seconds\n",
+		PressureEntities, PressureTickRate, PressureClients, StallStart, StallReadInterval * 1000, PressureRunTime, PressureSlowTimeout);
+
+	static const char* names[] = { "plain", "backpressure" };
+	for (int mode = 0; mode < 2; mode++)
+	{
+		PressureResult result = { 0 };
+		if (!RunPressureSession(mode == 1, &result))
+		{
+			BenchPrintf("could not connect over loopback, skipping the backpressure benchmarks\n");
+			return;
+		}
+
+		PrintPressureResult(names[mode], &result);
+	}
+
+	// what reading the backpressure of a peer costs, with an update waiting for every entity
+	LoopbackPair pair = { 0 };
+	if (!ConnectLoopback(&pair))
+	{
+		CloseLoopback(&pair);
+		return;
+	}
+
+	pair.ServerPeer->windowSize = pair.ServerPeer->mtu;
+	static MessageBatch batch;
+	ResetMessageBatch(&batch);
+	SendTick(pair.ServerPeer, true, 0, &batch);
+
+	char name[64];
+	snprintf(name, sizeof(name), "read with %d waiting", PressureEntities);
+	BenchMeasure("backpressure", name, ReadPressure, pair.ServerPeer);
+
+	CloseLoopback(&pair);
+}
@@ -0,0 +1,170 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// message batching benchmark
+// a server with lots of players sends each one a snapshot with an update for everyone else, every tick
+// this sends those snapshots over loopback as one enet packet per message, and as one batched packet, and reads them on the other end
+// besides the time, it reports how many enet commands and wire bytes each snapshot took, which is where batching saves the most
+
+#include "net_common.h"
+#include "net_batch.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+// one message per player in the snapshot, the same size as the server's UpdatePlayer
+#define SnapshotMessageSize 10
+
+// the snapshot being sent, and how it is sent
+typedef struct
+{
+	LoopbackPair* Pair;
+	int Messages;
+	MessageBatch Batch;
+}SnapshotContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+// read every message out of everything that has arrived, the way the client does
+static void ReceiveSnapshots(ENetHost* host)
+{
+	uint32_t sum = 0;
+	ENetEvent event = { 0 };
+	while (enet_host_service(host, &event, 0) > 0)
+	{
+		if (event.type != ENET_EVENT_TYPE_RECEIVE)
+			continue;
+
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event.packet);
+
+		size_t offset = 0;
+		while (ReadNextMessage(&reader, &offset) > 0)
+			sum += ReadByte(event.packet, &offset);
+
+		enet_packet_destroy(event.packet);
+	}
+	Sink += sum;
+}
+
+// get the snapshot out to the socket, read it on the other side, and let the acknowledgements come back
+static void DeliverSnapshot(LoopbackPair* pair)
+{
+	enet_host_flush(pair->Server);
+	ReceiveSnapshots(pair->Client);
+	DrainHost(pair->Server);
+}
+
+// every message is its own reliable packet, the way the server used to send
+static void SendUnbatched(void* context, int count)
+{
+	SnapshotContext* snapshot = (SnapshotContext*)context;
+	uint8_t message[SnapshotMessageSize] = { UpdatePlayer };
+
+	for (int i = 0; i < count; i++)
+	{
+		for (int m = 0; m < snapshot->Messages; m++)
+		{
+			message[1] = (uint8_t)m;
+			enet_peer_send(snapshot->Pair->ServerPeer, 0, enet_packet_create(message, sizeof(message), ENET_PACKET_FLAG_RELIABLE));
+		}
+		DeliverSnapshot(snapshot->Pair);
+	}
+}
+
+// all the messages go in a batch, and the batch is sent as one packet
+static void SendBatched(void* context, int count)
+{
+	SnapshotContext* snapshot = (SnapshotContext*)context;
+	uint8_t message[SnapshotMessageSize] = { UpdatePlayer };
+
+	for (int i = 0; i < count; i++)
+	{
+		for (int m = 0; m < snapshot->Messages; m++)
+		{
+			message[1] = (uint8_t)m;
+			BatchMessage(&snapshot->Batch, snapshot->Pair->ServerPeer, message, sizeof(message));
+		}
+		FlushMessageBatch(&snapshot->Batch, snapshot->Pair->ServerPeer);
+		DeliverSnapshot(snapshot->Pair);
+	}
+}
+
+// send one snapshot and count what went over the wire for it
+static void PrintSnapshotCost(const char* name, BenchOperation operation, SnapshotContext* snapshot)
+{
+	ENetHost* host = snapshot->Pair->Server;
+	uint64_t commands = host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count;
+	uint64_t commandBytes = host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Bytes;
+	uint64_t datagrams = host->totalSentPackets;
+	uint64_t wireBytes = host->totalSentData;
+
+	operation(snapshot, 1);
+
+	commands = host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count - commands;
+	commandBytes = host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Bytes - commandBytes;
+
+	// the header and data of each reliable send is counted as the command, take the messages out to get just the overhead
+	uint64_t payload = (uint64_t)snapshot->Messages * SnapshotMessageSize;
+	BenchPrintf("  %-10s %3llu send commands, %llu datagrams, %5llu wire bytes, %4lld bytes of command overhead and framing\n", name,
+		(unsigned long long)commands, (unsigned long long)(host->totalSentPackets - datagrams), (unsigned long long)(host->totalSentData - wireBytes),
+		(long long)commandBytes - (long long)payload);
+}
+
+void BenchBatching()
+{
+	LoopbackPair pair = { 0 };
+	if (!ConnectLoopback(&pair))
+	{
+		BenchPrintf("could not connect over loopback, skipping the batching benchmarks\n");
+		CloseLoopback(&pair);
+		return;
+	}
+
+	static const int players[] = { 64, 128 };
+	for (size_t i = 0; i < sizeof(players) / sizeof(players[0]); i++)
+	{
+		SnapshotContext snapshot = { 0 };
+		snapshot.Pair = &pair;
+		snapshot.Messages = players[i];
+
+		char name[64];
+		BenchPrintf("snapshot of %d players\n", players[i]);
+		PrintSnapshotCost("unbatched", SendUnbatched, &snapshot);
+		PrintSnapshotCost("batched", SendBatched, &snapshot);
+
+		snprintf(name, sizeof(name), "%d players, unbatched", players[i]);
+		BenchMeasure("batching", name, SendUnbatched, &snapshot);
+
+		snprintf(name, sizeof(name), "%d players, batched", players[i]);
+		BenchMeasure("batching", name, SendBatched, &snapshot);
+	}
+
+	CloseLoopback(&pair);
+}
@@ -0,0 +1,288 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// headless client benchmark
+// runs the real client code (net_client.c) without a window against a small loopback server that lets everyone in
+// the server drops the client, and the client connects again, the way it does when a player gets booted
+// this is done with the client making a new enet host for every connection, and keeping one host open across them
+// then the server moves another player around for a while, and the client's network stats are read the way the overlay does
+
+#include "net_common.h"
+#include "net_client.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+// how many drops and reconnects to average over for the printed results
+#define ClientBenchReconnects 200
+
+// how long the server moves another player around for before the stats are read, a bit over one stats period
+#define ClientBenchStatsTime 1.2
+
+// how often the server sends the other player's position, and how fast they move, in pixels a second
+#define ClientBenchUpdateRate 30.0
+#define ClientBenchMoveSpeed 200
+
+// how long the other player goes one way before turning around, this is between updates so the client overshoots at each turn
+#define ClientBenchTurnTime 0.45
+
+typedef struct
+{
+	ENetHost* Server;
+	ENetPeer* ServerPeer;
+	NetClient* Client;
+
+	// the time and allocations from calling connect until the server let us in, for the last reconnect
+	double ReconnectTime;
+	uint64_t ReconnectAllocations;
+	uint64_t ReconnectBytes;
+	bool Failed;
+}ClientBenchContext;
+
+// let anyone who connects in as player 0, the same message the real server sends
+static void ServeClients(ClientBenchContext* bench)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(bench->Server, &event, 0) > 0)
+	{
+		if (event.type == ENET_EVENT_TYPE_CONNECT)
+		{
+			bench->ServerPeer = event.peer;
+
+			uint8_t accept[AcceptPlayerSize] = { (uint8_t)AcceptPlayer, 0, 0 };
+			enet_peer_send(event.peer, 0, enet_packet_create(accept, sizeof(accept), ENET_PACKET_FLAG_RELIABLE));
+			enet_host_flush(bench->Server);
+		}
+		else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+		{
+			enet_packet_destroy(event.packet);
+		}
+	}
+}
+
+// connect and update the client until the server has let it in, returning false if it took too long
+static bool ConnectClient(ClientBenchContext* bench)
+{
+	ClientConnect(bench->Client, "127.0.0.1");
+
+	double start = BenchNow();
+	while (ClientGetLocalPlayerId(bench->Client) < 0)
+	{
+		double now = BenchNow();
+		if (now - start > LoopbackTimeout)
+			return false;
+
+		ServeClients(bench);
+		ClientUpdate(bench->Client, now, 0);
+	}
+
+	return true;
+}
+
+// the server drops the client, and it connects again
+static void DropAndReconnect(void* context, int count)
+{
+	ClientBenchContext* bench = (ClientBenchContext*)context;
+	for (int c = 0; c < count && !bench->Failed; c++)
+	{
+		if (bench->ServerPeer != NULL)
+			enet_peer_disconnect_now(bench->ServerPeer, 0);
+		bench->ServerPeer = NULL;
+
+		double start = BenchNow();
+		while (ClientConnected(bench->Client) && BenchNow() - start < LoopbackTimeout)
+			ClientUpdate(bench->Client, BenchNow(), 0);
+
+		uint64_t allocations = BenchAllocations;
+		uint64_t bytes = BenchAllocatedBytes;
+		start = BenchNow();
+
+		bench->Failed = !ConnectClient(bench);
+
+		bench->ReconnectTime = BenchNow() - start;
+		bench->ReconnectAllocations = BenchAllocations - allocations;
+		bench->ReconnectBytes = BenchAllocatedBytes - bytes;
+	}
+}
+
+// what the overlay does every frame
+static void GetStats(void* context, int count)
+{
+	NetClient* client = (NetClient*)context;
+	for (int c = 0; c < count; c++)
+	{
+		NetStats stats = { 0 };
+		ClientGetNetStats(client, &stats);
+		Sink += stats.RoundTripTime + stats.EventBacklog;
+	}
+}
+
+static void RunClientBench(ENetHost* server, bool keepHost)
+{
+	const char* name = keepHost ? "reconnect, kept host" : "reconnect, new host";
+
+	ClientBenchContext bench = { 0 };
+	bench.Server = server;
+	bench.Client = CreateNetClient();
+	if (bench.Client == NULL)
+		return;
+
+	ClientSetKeepHost(bench.Client, keepHost);
+	if (!ConnectClient(&bench))
+	{
+		BenchPrintf("  %s: the client could not connect\n", name);
+		DestroyNetClient(bench.Client);
+		return;
+	}
+
+	// the average and best of many reconnects, counting only from connect until we are let in
+	double total = 0;
+	double best = 1e9;
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+	for (int i = 0; i < ClientBenchReconnects && !bench.Failed; i++)
+	{
+		DropAndReconnect(&bench, 1);
+		total += bench.ReconnectTime;
+		allocations += bench.ReconnectAllocations;
+		bytes += bench.ReconnectBytes;
+		if (bench.ReconnectTime < best)
+			best = bench.ReconnectTime;
+	}
+
+	if (bench.Failed)
+	{
+		BenchPrintf("  %s: the client did not get back in\n", name);
+	}
+	else
+	{
+		BenchPrintf("  %-22s %7.1fus average, %7.1fus best, %5.1f allocations and %8.1f bytes a reconnect\n", name,
+			total * 1000000.0 / ClientBenchReconnects, best * 1000000.0, (double)allocations / ClientBenchReconnects, (double)bytes / ClientBenchReconnects);
+
+		BenchMeasure("client", name, DropAndReconnect, &bench);
+	}
+
+	if (bench.ServerPeer != NULL)
+		enet_peer_reset(bench.ServerPeer);
+	DestroyNetClient(bench.Client);
+}
+
+// a message about player 1, an AddPlayer or an UpdatePlayer
+static void SendPlayer(ClientBenchContext* bench, NetworkCommands command, int16_t x, int16_t dx)
+{
+	uint8_t message[10] = { (uint8_t)command, 1 };
+	*(int16_t*)(message + 2) = x;
+	*(int16_t*)(message + 4) = 400;
+	*(int16_t*)(message + 6) = dx;
+	*(int16_t*)(message + 8) = 0;
+	enet_peer_send(bench->ServerPeer, 0, enet_packet_create(message, sizeof(message), ENET_PACKET_FLAG_RELIABLE));
+}
+
+// move another player back and forth for a while, then read the stats
+static void RunStatsSession(ENetHost* server)
+{
+	ClientBenchContext bench = { 0 };
+	bench.Server = server;
+	bench.Client = CreateNetClient();
+	if (bench.Client == NULL)
+		return;
+
+	if (!ConnectClient(&bench) || bench.ServerPeer == NULL)
+	{
+		BenchPrintf("  the client could not connect for the stats session\n");
+		DestroyNetClient(bench.Client);
+		return;
+	}
+
+	// the updates come in on time, but the player turns around now and then, which the client can't see coming
+	SendPlayer(&bench, AddPlayer, 100, ClientBenchMoveSpeed);
+	double start = BenchNow();
+	double nextSend = start;
+	while (BenchNow() - start < ClientBenchStatsTime)
+	{
+		double now = BenchNow();
+		if (now >= nextSend)
+		{
+			double t = now - start;
+			int leg = (int)(t / ClientBenchTurnTime);
+			double legTime = t - leg * ClientBenchTurnTime;
+			int16_t dx = (leg % 2) == 0 ? ClientBenchMoveSpeed : -ClientBenchMoveSpeed;
+			int16_t x = (int16_t)((leg % 2) == 0 ? 100 + legTime * ClientBenchMoveSpeed : 100 + (ClientBenchTurnTime - legTime) * ClientBenchMoveSpeed);
+			SendPlayer(&bench, UpdatePlayer, x, dx);
+			nextSend += 1.0 / ClientBenchUpdateRate;
+		}
+
+		ServeClients(&bench);
+		ClientUpdate(bench.Client, now, 0);
+	}
+
+	NetStats stats = { 0 };
+	if (ClientGetNetStats(bench.Client, &stats))
+	{
+		BenchPrintf("  net stats after %.1fs: rtt %ums (+/- %u, p99 %u), jitter %.2fms (p99 %u), loss %.1f%%\n", ClientBenchStatsTime,
+			stats.RoundTripTime, stats.RoundTripVariance, stats.RoundTripP99, stats.JitterMean, stats.JitterP99, stats.PacketLoss);
+		BenchPrintf("  in %.0f bytes/s, out %.0f bytes/s, %u bytes pending, %u events waiting, extrapolation error %.1fpx (max %.1f)\n",
+			stats.BytesInPerSecond, stats.BytesOutPerSecond, stats.PendingReliableBytes, stats.EventBacklog, stats.ExtrapolationErrorMean, stats.ExtrapolationErrorMax);
+
+		BenchMeasure("client", "get net stats", GetStats, bench.Client);
+	}
+	else
+	{
+		BenchPrintf("  the client dropped during the stats session\n");
+	}
+
+	if (bench.ServerPeer != NULL)
+		enet_peer_reset(bench.ServerPeer);
+	DestroyNetClient(bench.Client);
+}
+
+void BenchClient()
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+
+	// the real server asks for connect cookies, so every connect pays for that round trip
+	address.port = 4545;
+	ENetHost* server = enet_host_create(&address, 4, 1, 0, 0);
+	if (server == NULL)
+	{
+		BenchPrintf("could not make a server on port 4545, skipping the client benchmarks (is the server running?)\n");
+		return;
+	}
+	enet_host_connect_cookies(server, 1, NULL);
+
+	BenchPrintf("the server drops the client and it connects again over loopback, %d times, counting from connect until the server lets it in\n", ClientBenchReconnects);
+	RunClientBench(server, false);
+	RunClientBench(server, true);
+	RunStatsSession(server);
+
+	enet_host_destroy(server);
+}
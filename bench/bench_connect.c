@@ -0,0 +1,194 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// connect flood benchmark
+// sends a server host a stream of connects that never finish the handshake, the way spoofed connects would
+// with connect cookies off every one takes a peer until the server is full, then every one is a scan of all the peers
+// with cookies on the server only hashes the address and sends a cookie back, and never keeps anything about the connect
+
+#include "net_common.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+// how many peers the flooded server has, a big server
+#define FloodPeers 1024
+
+// how many connects are sent before the server gets to read them, the socket buffer has to hold them all
+#define FloodBurst 32
+
+// the server being flooded, and the socket the connects come from
+typedef struct
+{
+	ENetHost* Server;
+	ENetAddress ServerAddress;
+	ENetSocket Socket;
+	uint32_t NextConnectID;
+	bool Junk;
+
+	// how long the server spent reading and answering connects, without the time spent sending them
+	double ServerTime;
+}FloodContext;
+
+// send connects in bursts and let the server read each burst
+static void FloodConnects(void* context, int count)
+{
+	FloodContext* flood = (FloodContext*)context;
+	uint8_t data[ConnectDatagramSize];
+
+	for (int i = 0; i < count; i++)
+	{
+		ENetBuffer buffer = { 0 };
+		buffer.data = data;
+		buffer.dataLength = WriteConnectDatagram(data, ++flood->NextConnectID);
+
+		// a datagram the server throws away as soon as it reads the header, to see what just getting it through the socket costs
+		if (flood->Junk)
+			data[0] = data[1] = 0xFF;
+
+		enet_socket_send(flood->Socket, &flood->ServerAddress, &buffer, 1);
+
+		if ((i + 1) % FloodBurst == 0 || i + 1 == count)
+		{
+			double start = BenchNow();
+			DrainHost(flood->Server);
+			flood->ServerTime += BenchNow() - start;
+		}
+	}
+}
+
+// count the peers the flood is holding on to
+static int CountTakenPeers(ENetHost* host)
+{
+	int taken = 0;
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		if (host->peers[i].state != ENET_PEER_STATE_DISCONNECTED)
+			taken++;
+	}
+	return taken;
+}
+
+// try to connect a real client to the flooded server, returns how long it took or a negative number if it couldn't
+static double ConnectRealClient(FloodContext* flood)
+{
+	ENetHost* client = enet_host_create(NULL, 1, 1, 0, 0);
+	if (client == NULL)
+		return -1;
+
+	double start = BenchNow();
+	double connected = -1;
+	enet_host_connect(client, &flood->ServerAddress, 1, 0);
+
+	while (connected < 0 && BenchNow() - start < LoopbackTimeout)
+	{
+		ENetEvent event = { 0 };
+		DrainHost(flood->Server);
+		if (enet_host_service(client, &event, 1) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
+			connected = BenchNow() - start;
+	}
+
+	enet_host_destroy(client);
+	DrainHost(flood->Server);
+	return connected;
+}
+
+static bool StartFlood(FloodContext* flood, bool cookies)
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+
+	flood->Server = enet_host_create(&address, FloodPeers, 1, 0, 0);
+	flood->Socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+	if (flood->Server == NULL || flood->Socket == ENET_SOCKET_NULL)
+		return false;
+
+	enet_socket_get_address(flood->Server->socket, &flood->ServerAddress);
+	flood->ServerAddress.host = address.host;
+	enet_host_connect_cookies(flood->Server, cookies, NULL);
+	return true;
+}
+
+static void StopFlood(FloodContext* flood)
+{
+	if (flood->Server != NULL)
+		enet_host_destroy(flood->Server);
+	if (flood->Socket != ENET_SOCKET_NULL)
+		enet_socket_destroy(flood->Socket);
+}
+
+// flood a server with and without cookies, then see if a real player can still get in
+static void RunFlood(const char* name, bool cookies)
+{
+	FloodContext flood = { 0 };
+	flood.Socket = ENET_SOCKET_NULL;
+	if (!StartFlood(&flood, cookies))
+	{
+		BenchPrintf("could not set up a server on loopback, skipping the connect flood benchmarks\n");
+		StopFlood(&flood);
+		return;
+	}
+
+	// the first connects are the expensive ones when they each get a peer, time them on their own
+	uint64_t allocations = BenchAllocations;
+	FloodConnects(&flood, FloodPeers);
+	BenchPrintf("%s: the server handled the first %d connects in %.2fus each (%.0f connects/s) with %.1f allocs each, %d of %d peers taken\n", name, FloodPeers,
+		flood.ServerTime * 1000000.0 / FloodPeers, FloodPeers / flood.ServerTime, (double)(BenchAllocations - allocations) / FloodPeers, CountTakenPeers(flood.Server), FloodPeers);
+
+	// then the server is full, or still empty with cookies, and keeps getting more
+	flood.ServerTime = 0;
+	FloodConnects(&flood, FloodPeers * 4);
+	BenchPrintf("%s: the server handled the next %d connects in %.2fus each (%.0f connects/s)\n", name, FloodPeers * 4,
+		flood.ServerTime * 1000000.0 / (FloodPeers * 4), FloodPeers * 4 / flood.ServerTime);
+
+	// the same again with the time spent sending the connects, the way BenchMeasure times everything
+	char measureName[64];
+	snprintf(measureName, sizeof(measureName), "%s, flooded", name);
+	BenchMeasure("connect", measureName, FloodConnects, &flood);
+
+	double connectTime = ConnectRealClient(&flood);
+	if (connectTime < 0)
+		BenchPrintf("%s: a real client could not connect during the flood\n", name);
+	else
+		BenchPrintf("%s: a real client connected in %.2fms during the flood\n", name, connectTime * 1000.0);
+
+	StopFlood(&flood);
+}
+
+void BenchConnect()
+{
+	FloodContext junk = { 0 };
+	junk.Socket = ENET_SOCKET_NULL;
+	junk.Junk = true;
+	if (StartFlood(&junk, false))
+		BenchMeasure("connect", "junk datagrams", FloodConnects, &junk);
+	StopFlood(&junk);
+
+	RunFlood("no cookies", false);
+	RunFlood("cookies", true);
+}
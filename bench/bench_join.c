@@ -0,0 +1,281 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// join benchmark
+// a new player needs to hear about everyone who is already in the game before they can see the world
+// this sends a whole world over loopback as one packet per AddPlayer, as batched AddPlayer messages, and as join snapshots,
+// and times how long it takes until the client has read every player, along with how many packets it took
+
+#include "net_common.h"
+#include "net_batch.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// the server sends this many join snapshot packets a tick, so a big world comes in over a few ticks
+#define JoinBenchChunksPerTick 4
+#define JoinBenchTickRate 60
+
+// the world being sent, and what the client has read of it
+typedef struct
+{
+	LoopbackPair* Pair;
+	int Entities;
+	MessageBatch Batch;
+	int Received;
+	bool Complete;
+}JoinContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+// read an entry the way the client does, the id and then the position and direction
+static void ReadEntry(JoinContext* join, ENetPacket* packet, size_t* offset)
+{
+	uint32_t sum = 0;
+	for (int i = 0; i < 4; i++)
+		sum += (uint16_t)ReadShort(packet, offset);
+
+	Sink += sum;
+	join->Received++;
+}
+
+// read everything that has arrived at the client
+static void ReceiveJoin(JoinContext* join)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(join->Pair->Client, &event, 0) > 0)
+	{
+		if (event.type != ENET_EVENT_TYPE_RECEIVE)
+			continue;
+
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event.packet);
+
+		size_t offset = 0;
+		while (ReadNextMessage(&reader, &offset) > 0)
+		{
+			uint8_t command = ReadByte(event.packet, &offset);
+			if (command == AddPlayer)
+			{
+				ReadByte(event.packet, &offset);
+				ReadEntry(join, event.packet, &offset);
+			}
+			else if (command == JoinSnapshot)
+			{
+				uint8_t flags = ReadByte(event.packet, &offset);
+				uint16_t count = (uint16_t)ReadShort(event.packet, &offset);
+				for (uint16_t i = 0; i < count; i++)
+				{
+					ReadShort(event.packet, &offset);
+					ReadEntry(join, event.packet, &offset);
+				}
+				join->Complete = (flags & JoinSnapshotLast) != 0;
+			}
+		}
+
+		enet_packet_destroy(event.packet);
+	}
+}
+
+// keep both hosts going until the client has the whole world
+// enet only lets so many reliable packets be in flight, so the server has to see acknowledgements to send the rest
+static void WaitForWorld(JoinContext* join)
+{
+	double start = BenchNow();
+	while (!join->Complete && BenchNow() - start < LoopbackTimeout)
+	{
+		DrainHost(join->Pair->Server);
+		ReceiveJoin(join);
+	}
+	DrainHost(join->Pair->Server);
+}
+
+// fill out an AddPlayer message for an entity, made up positions are fine, only the size matters
+static void WriteAddPlayer(uint8_t message[10], int entity)
+{
+	message[0] = (uint8_t)AddPlayer;
+	message[1] = (uint8_t)entity;
+	*(int16_t*)(message + 2) = (int16_t)(entity % 1000);
+	*(int16_t*)(message + 4) = (int16_t)(entity / 1000);
+	*(int16_t*)(message + 6) = 1;
+	*(int16_t*)(message + 8) = -1;
+}
+
+// every player is its own reliable packet, the way the server did it before batching
+static void JoinUnbatched(void* context, int count)
+{
+	JoinContext* join = (JoinContext*)context;
+	for (int c = 0; c < count; c++)
+	{
+		join->Received = 0;
+		join->Complete = false;
+
+		uint8_t message[10];
+		for (int i = 0; i < join->Entities; i++)
+		{
+			WriteAddPlayer(message, i);
+			enet_peer_send(join->Pair->ServerPeer, 0, enet_packet_create(message, sizeof(message), ENET_PACKET_FLAG_RELIABLE));
+		}
+
+		// the client has no way to know when it has everyone, so it is done when the count matches
+		enet_host_flush(join->Pair->Server);
+		double start = BenchNow();
+		while (join->Received < join->Entities && BenchNow() - start < LoopbackTimeout)
+		{
+			DrainHost(join->Pair->Server);
+			ReceiveJoin(join);
+		}
+		join->Complete = join->Received == join->Entities;
+		DrainHost(join->Pair->Server);
+	}
+}
+
+// every player is an AddPlayer message in the new player's batch, the batch is sent whenever it fills up
+static void JoinBatched(void* context, int count)
+{
+	JoinContext* join = (JoinContext*)context;
+	for (int c = 0; c < count; c++)
+	{
+		join->Received = 0;
+		join->Complete = false;
+
+		uint8_t message[10];
+		for (int i = 0; i < join->Entities; i++)
+		{
+			WriteAddPlayer(message, i);
+			BatchMessage(&join->Batch, join->Pair->ServerPeer, message, sizeof(message));
+		}
+		FlushMessageBatch(&join->Batch, join->Pair->ServerPeer);
+
+		enet_host_flush(join->Pair->Server);
+		double start = BenchNow();
+		while (join->Received < join->Entities && BenchNow() - start < LoopbackTimeout)
+		{
+			DrainHost(join->Pair->Server);
+			ReceiveJoin(join);
+		}
+		join->Complete = join->Received == join->Entities;
+		DrainHost(join->Pair->Server);
+	}
+}
+
+// the world goes out as join snapshots, each as full as a packet can be, the last one says the world is complete
+static void JoinSnapshots(void* context, int count)
+{
+	JoinContext* join = (JoinContext*)context;
+	for (int c = 0; c < count; c++)
+	{
+		join->Received = 0;
+		join->Complete = false;
+
+		int entity = 0;
+		do
+		{
+			uint8_t buffer[MessageBatchCapacity];
+			size_t length = JoinSnapshotHeaderSize;
+			uint16_t entries = 0;
+			for (; entity < join->Entities && length + JoinSnapshotEntrySize <= sizeof(buffer); entity++)
+			{
+				uint8_t message[10];
+				WriteAddPlayer(message, entity);
+				*(uint16_t*)(buffer + length) = (uint16_t)entity;
+				memcpy(buffer + length + 2, message + 2, JoinSnapshotEntrySize - 2);
+				length += JoinSnapshotEntrySize;
+				entries++;
+			}
+
+			buffer[0] = (uint8_t)JoinSnapshot;
+			buffer[1] = entity < join->Entities ? 0 : JoinSnapshotLast;
+			*(uint16_t*)(buffer + 2) = entries;
+			enet_peer_send(join->Pair->ServerPeer, 0, enet_packet_create(buffer, length, ENET_PACKET_FLAG_RELIABLE));
+		} while (entity < join->Entities);
+
+		enet_host_flush(join->Pair->Server);
+		WaitForWorld(join);
+	}
+}
+
+// send the world once and count what went over the wire for it
+static void PrintJoinCost(const char* name, BenchOperation operation, JoinContext* join)
+{
+	ENetHost* host = join->Pair->Server;
+	uint64_t commands = host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count;
+	uint64_t datagrams = host->totalSentPackets;
+	uint64_t wireBytes = host->totalSentData;
+
+	operation(join, 1);
+
+	BenchPrintf("  %-15s %5llu packets, %5llu datagrams, %7llu wire bytes%s\n", name,
+		(unsigned long long)(host->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count - commands),
+		(unsigned long long)(host->totalSentPackets - datagrams), (unsigned long long)(host->totalSentData - wireBytes),
+		join->Complete ? "" : " (did not finish)");
+}
+
+void BenchJoin()
+{
+	LoopbackPair pair = { 0 };
+	if (!ConnectLoopback(&pair))
+	{
+		BenchPrintf("could not connect over loopback, skipping the join benchmarks\n");
+		CloseLoopback(&pair);
+		return;
+	}
+
+	static const int entities[] = { 1000, 5000 };
+	for (size_t i = 0; i < sizeof(entities) / sizeof(entities[0]); i++)
+	{
+		JoinContext join = { 0 };
+		join.Pair = &pair;
+		join.Entities = entities[i];
+
+		int entriesPerChunk = (MessageBatchCapacity - JoinSnapshotHeaderSize) / JoinSnapshotEntrySize;
+		int chunks = (join.Entities + entriesPerChunk - 1) / entriesPerChunk;
+		int ticks = (chunks + JoinBenchChunksPerTick - 1) / JoinBenchChunksPerTick;
+
+		char name[64];
+		BenchPrintf("joining a world of %d players\n", entities[i]);
+		PrintJoinCost("unbatched", JoinUnbatched, &join);
+		PrintJoinCost("batched", JoinBatched, &join);
+		PrintJoinCost("join snapshot", JoinSnapshots, &join);
+		BenchPrintf("  the server streams the join snapshot %d packets a tick, so the world is complete after %d ticks (%.1fms at %d ticks a second)\n",
+			JoinBenchChunksPerTick, ticks, ticks * 1000.0 / JoinBenchTickRate, JoinBenchTickRate);
+
+		snprintf(name, sizeof(name), "%d players, unbatched", entities[i]);
+		BenchMeasure("join", name, JoinUnbatched, &join);
+
+		snprintf(name, sizeof(name), "%d players, batched", entities[i]);
+		BenchMeasure("join", name, JoinBatched, &join);
+
+		snprintf(name, sizeof(name), "%d players, join snapshot", entities[i]);
+		BenchMeasure("join", name, JoinSnapshots, &join);
+	}
+
+	CloseLoopback(&pair);
+}
@@ -0,0 +1,308 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// latest only sends to a slow peer
+// a server sends the position of every entity every tick to a client that only reads its socket every so often, over a link that loses some datagrams
+// the reliable window fills up and everything else queues behind it, so with plain reliable sends the client works through old positions
+// with latest only sends, an update that hasn't gone out yet is replaced by the newer one, and lost ones that are already out of date are resent empty
+// this reports how deep the queue gets, how old the positions the client has are, and how many bytes went over the wire for each way of sending
+
+#include "net_common.h"
+#include "net_batch.h"
+#include "net_rate.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// how many entities the server sends every tick, and how fast it ticks
+#define LatestEntities 64
+#define LatestTickRate 60.0
+
+// how long each way of sending runs for, in seconds
+#define LatestRunTime 2.0
+
+// the client only reads its socket this often, in seconds, so the acks it sends are late and the reliable window stays full
+#define LatestReceiveInterval 0.1
+
+// one datagram in this many going to the client is lost, so some reliable sends have to go again
+#define LatestLossEvery 20
+
+// each update is the command, the entity id and the tick it was sent on
+#define LatestMessageSize 6
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+typedef enum
+{
+	SendModeBatched = 0,  // every update in one batched packet a tick, the way the server sends a healthy player
+	SendModePerEntity,    // every update in its own reliable packet
+	SendModeLatest,       // every update in its own packet, sent latest only with the entity as the key
+}LatestSendMode;
+
+typedef struct
+{
+	// the queue to the client, sampled every tick, in commands and in bytes
+	uint64_t QueueSum;
+	uint32_t QueueMax;
+	uint64_t BacklogSum;
+	size_t BacklogMax;
+	uint32_t Samples;
+
+	// how old the newest position the client has for each entity is, sampled every tick, in milliseconds
+	NetHistogram Age;
+
+	// what the client got, and what went over the wire to it
+	uint32_t Delivered;
+	uint32_t EmptyPackets;
+	uint32_t Replaced;
+	uint64_t WireBytes;
+}LatestResult;
+
+// the newest tick the client has seen for each entity
+static uint32_t ClientTicks[LatestEntities];
+static bool ClientHas[LatestEntities];
+
+// counts datagrams coming in to the client, and throws one away every so often
+static uint32_t ClientDatagrams = 0;
+
+static int ENET_CALLBACK LoseDatagrams(ENetHost* host, void* event)
+{
+	(void)host;
+	(void)event;
+	return (++ClientDatagrams % LatestLossEvery) == 0 ? 1 : 0;
+}
+
+// read everything the client has, the way the real client does, keeping the newest tick for each entity
+static void ReceiveUpdates(ENetHost* host, LatestResult* result)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(host, &event, 0) > 0)
+	{
+		if (event.type != ENET_EVENT_TYPE_RECEIVE)
+			continue;
+
+		// superseded sends that had to go again come through with nothing in them
+		if (event.packet->dataLength < 1)
+		{
+			result->EmptyPackets++;
+			enet_packet_destroy(event.packet);
+			continue;
+		}
+
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event.packet);
+
+		size_t offset = 0;
+		while (ReadNextMessage(&reader, &offset) > 0)
+		{
+			ReadByte(event.packet, &offset);
+			uint8_t id = ReadByte(event.packet, &offset);
+			uint32_t tick = (uint32_t)ReadInt(event.packet, &offset);
+			if (id >= LatestEntities)
+				continue;
+
+			result->Delivered++;
+			if (!ClientHas[id] || tick > ClientTicks[id])
+				ClientTicks[id] = tick;
+			ClientHas[id] = true;
+		}
+
+		enet_packet_destroy(event.packet);
+	}
+}
+
+// send every entity's update for one tick
+static void SendTick(ENetPeer* peer, LatestSendMode mode, uint32_t tick, MessageBatch* batch, LatestResult* result)
+{
+	uint8_t message[LatestMessageSize] = { (uint8_t)UpdatePlayer };
+	memcpy(message + 2, &tick, sizeof(tick));
+
+	for (int id = 0; id < LatestEntities; id++)
+	{
+		message[1] = (uint8_t)id;
+
+		if (mode == SendModeBatched)
+		{
+			BatchMessage(batch, peer, message, sizeof(message));
+			continue;
+		}
+
+		ENetPacket* packet = enet_packet_create(message, sizeof(message), ENET_PACKET_FLAG_RELIABLE);
+		int sent = mode == SendModeLatest ? enet_peer_send_latest(peer, 0, packet, (uint32_t)id + 1) : enet_peer_send(peer, 0, packet);
+		if (sent < 0)
+			enet_packet_destroy(packet);
+		else if (sent == 1)
+			result->Replaced++;
+	}
+
+	FlushMessageBatch(batch, peer);
+}
+
+// run the server and the slow client for a while with one way of sending
+static bool RunLatestSession(LatestSendMode mode, LatestResult* result)
+{
+	memset(result, 0, sizeof(LatestResult));
+	memset(ClientTicks, 0, sizeof(ClientTicks));
+	memset(ClientHas, 0, sizeof(ClientHas));
+
+	LoopbackPair pair = { 0 };
+	if (!ConnectLoopback(&pair))
+	{
+		CloseLoopback(&pair);
+		return false;
+	}
+
+	// enet always lets one datagram of data be in flight, squeeze the window down to that, as if the client had a very slow link
+	// with the client only acknowledging every so often, that is much less than the server wants to send
+	pair.ServerPeer->windowSize = pair.ServerPeer->mtu;
+	ClientDatagrams = 0;
+	enet_host_set_intercept(pair.Client, LoseDatagrams);
+
+	static MessageBatch batch;
+	ResetMessageBatch(&batch);
+
+	uint64_t wireStart = pair.Server->totalSentData;
+	double start = BenchNow();
+	double lastReceive = start;
+	uint32_t tick = 0;
+
+	while (BenchNow() - start < LatestRunTime)
+	{
+		double now = BenchNow();
+
+		if (now - start >= tick / LatestTickRate)
+		{
+			SendTick(pair.ServerPeer, mode, tick, &batch, result);
+
+			// how much is waiting, and how old what the client has is
+			ENetPeer* peer = pair.ServerPeer;
+			uint32_t queued = (uint32_t)(enet_list_size(&peer->outgoingReliableCommands) + enet_list_size(&peer->sentReliableCommands));
+			size_t backlog = GetPeerOutgoingBacklog(peer);
+			result->QueueSum += queued;
+			result->BacklogSum += backlog;
+			if (queued > result->QueueMax)
+				result->QueueMax = queued;
+			if (backlog > result->BacklogMax)
+				result->BacklogMax = backlog;
+			result->Samples++;
+
+			for (int id = 0; id < LatestEntities; id++)
+			{
+				if (ClientHas[id])
+					RecordHistogram(&result->Age, (uint32_t)((tick - ClientTicks[id]) * 1000.0 / LatestTickRate));
+			}
+
+			tick++;
+		}
+
+		DrainHost(pair.Server);
+
+		if (now - lastReceive >= LatestReceiveInterval)
+		{
+			ReceiveUpdates(pair.Client, result);
+			lastReceive = now;
+		}
+
+		// one core is enough for both ends, don't spin
+		BenchYield();
+	}
+
+	result->WireBytes = pair.Server->totalSentData - wireStart;
+	Sink += result->Delivered;
+
+	CloseLoopback(&pair);
+	return true;
+}
+
+static void PrintLatestResult(const char* name, const LatestResult* result)
+{
+	uint32_t samples = result->Samples > 0 ? result->Samples : 1;
+	BenchPrintf("  %-11s queue %6.1f commands (max %5u), %7.0f bytes (max %6zu)  age %6.1fms (p99 %5u, max %5u)  %6u delivered, %4u empty, %5u replaced  %6.1f KB/s\n", name,
+		(double)result->QueueSum / samples, result->QueueMax, (double)result->BacklogSum / samples, result->BacklogMax,
+		GetHistogramMean(&result->Age), GetHistogramPercentile(&result->Age, 99), result->Age.Max,
+		result->Delivered, result->EmptyPackets, result->Replaced, result->WireBytes / LatestRunTime / 1024.0);
+}
+
+// the time to send latest only when there is already an update waiting for every entity, and the new one replaces one of them
+typedef struct
+{
+	ENetPeer* Peer;
+	uint32_t Key;
+}ReplaceContext;
+
+static void ReplaceWaiting(void* context, int count)
+{
+	ReplaceContext* replace = (ReplaceContext*)context;
+	uint8_t message[LatestMessageSize] = { (uint8_t)UpdatePlayer };
+
+	for (int i = 0; i < count; i++)
+	{
+		replace->Key = replace->Key % LatestEntities + 1;
+		ENetPacket* packet = enet_packet_create(message, sizeof(message), ENET_PACKET_FLAG_RELIABLE);
+		if (enet_peer_send_latest(replace->Peer, 0, packet, replace->Key) < 0)
+			enet_packet_destroy(packet);
+	}
+}
+
+void BenchLatest()
+{
+	BenchPrintf("%d entities at %.0f ticks a second to a client that reads every %.0fms, with one datagram in flight and one in %d lost, %.0f seconds each\n",
+		LatestEntities, LatestTickRate, LatestReceiveInterval * 1000, LatestLossEvery, LatestRunTime);
+
+	static const char* names[] = { "batched", "per entity", "latest only" };
+	for (int mode = SendModeBatched; mode <= SendModeLatest; mode++)
+	{
+		LatestResult result = { 0 };
+		if (!RunLatestSession((LatestSendMode)mode, &result))
+		{
+			BenchPrintf("could not connect over loopback, skipping the latest only benchmarks\n");
+			return;
+		}
+
+		PrintLatestResult(names[mode], &result);
+	}
+
+	// what the search for an older update costs, with one waiting for every entity and nothing ever going out
+	LoopbackPair pair = { 0 };
+	if (!ConnectLoopback(&pair))
+	{
+		CloseLoopback(&pair);
+		return;
+	}
+
+	ReplaceContext replace = { pair.ServerPeer, 0 };
+	ReplaceWaiting(&replace, LatestEntities);
+
+	char name[64];
+	snprintf(name, sizeof(name), "replace one of %d waiting", LatestEntities);
+	BenchMeasure("latest", name, ReplaceWaiting, &replace);
+
+	CloseLoopback(&pair);
+}
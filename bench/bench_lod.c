@@ -0,0 +1,172 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// benchmark for distance based level of detail
+// a world full of moving players, where everyone has news every tick, sent with and without the level of detail tiers
+// reports how much snapshot bandwidth each client needs both ways, and how long working out who is due takes
+
+#include "server_lod.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+// how many ticks of movement to count over
+#define LodTicks 600
+
+// how many of the players we count snapshots for, every player is the same so a sample is enough
+#define LodViewers 16
+
+// what one update costs in a batch, the message and its length prefix
+#define LodMessageBytes 11
+
+#define LodTimedEntities 10000
+
+typedef struct
+{
+	LodConfig Config;
+	MovementStore Store;
+	uint64_t* LastSent;
+	uint8_t* Due;
+	uint64_t Tick;
+}LodContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile int Sink = 0;
+
+// fill a store with players scattered over the field, all moving
+static void ScatterPlayers(MovementStore* store, int count)
+{
+	srand(1234);
+	for (int i = 0; i < count; i++)
+	{
+		float x = (float)(rand() % FieldSizeWidth);
+		float y = (float)(rand() % FieldSizeHeight);
+		float vx = (float)(rand() % 400 - 200);
+		float vy = (float)(rand() % 400 - 200);
+		SetMovementInput(store, i, x, y, vx, vy, -1);
+	}
+}
+
+// count the updates a few players get over a run, with the tiers, returns the average updates per player per tick
+static double CountLodUpdates(const LodConfig* config, int players)
+{
+	MovementStore store = { 0 };
+	uint64_t* lastSent = (uint64_t*)calloc((size_t)players * LodViewers, sizeof(uint64_t));
+	uint8_t* due = (uint8_t*)malloc(players);
+	if (lastSent == NULL || due == NULL || !InitMovementStore(&store, players))
+	{
+		free(lastSent);
+		free(due);
+		return 0;
+	}
+
+	ScatterPlayers(&store, players);
+
+	uint64_t sent = 0;
+	for (uint64_t tick = 1; tick <= LodTicks; tick++)
+	{
+		StepMovement(&store, 1.0f / 60.0f, MaxPlayerSpeed);
+
+		for (int viewer = 0; viewer < LodViewers && viewer < players; viewer++)
+		{
+			uint64_t* viewerSent = lastSent + (size_t)viewer * players;
+			GetLodDue(config, &store, players, store.X[viewer], store.Y[viewer], tick, viewerSent, due);
+
+			for (int i = 0; i < players; i++)
+			{
+				if (i == viewer || !due[i])
+					continue;
+
+				viewerSent[i] = tick;
+				sent++;
+			}
+		}
+	}
+
+	int viewers = players < LodViewers ? players : LodViewers;
+	FreeMovementStore(&store);
+	free(lastSent);
+	free(due);
+
+	return (double)sent / ((double)viewers * LodTicks);
+}
+
+// work out who is due for one player, over a big world
+static void LodDueTicks(void* context, int count)
+{
+	LodContext* world = (LodContext*)context;
+	for (int i = 0; i < count; i++)
+	{
+		world->Tick++;
+		GetLodDue(&world->Config, &world->Store, LodTimedEntities, FieldSizeWidth / 2.0f, FieldSizeHeight / 2.0f, world->Tick, world->LastSent, world->Due);
+		Sink += world->Due[world->Tick % LodTimedEntities];
+	}
+}
+
+void BenchLod()
+{
+	LodConfig tiers = DefaultLodConfig();
+	LodConfig everyTick = { 0 };
+	ParseLodConfig("off", &everyTick);
+
+	BenchPrintf("tiers:");
+	for (int t = 0; t < tiers.TierCount; t++)
+	{
+		if (t < tiers.TierCount - 1)
+			BenchPrintf(" up to %.0fpx every %u ticks,", tiers.Tiers[t].MaxDistance, tiers.Tiers[t].Interval);
+		else
+			BenchPrintf(" further every %u ticks", tiers.Tiers[t].Interval);
+	}
+	BenchPrintf("\n");
+
+	static const int playerCounts[] = { 64, 256, 1024 };
+	for (size_t p = 0; p < sizeof(playerCounts) / sizeof(playerCounts[0]); p++)
+	{
+		int players = playerCounts[p];
+		double full = CountLodUpdates(&everyTick, players);
+		double lod = CountLodUpdates(&tiers, players);
+
+		// at 60 ticks a second
+		BenchPrintf("%5d players: %7.1f updates per client per tick without tiers (%6.1f KB/s), %7.1f with (%6.1f KB/s), %.0f%% saved\n", players,
+			full, full * LodMessageBytes * 60 / 1024, lod, lod * LodMessageBytes * 60 / 1024, full > 0 ? 100.0 * (1.0 - lod / full) : 0);
+	}
+
+	LodContext world = { 0 };
+	world.Config = tiers;
+	world.LastSent = (uint64_t*)calloc(LodTimedEntities, sizeof(uint64_t));
+	world.Due = (uint8_t*)malloc(LodTimedEntities);
+	if (world.LastSent != NULL && world.Due != NULL && InitMovementStore(&world.Store, LodTimedEntities))
+	{
+		ScatterPlayers(&world.Store, LodTimedEntities);
+		BenchMeasure("lod", "GetLodDue 10000 entities", LodDueTicks, &world);
+		FreeMovementStore(&world.Store);
+	}
+
+	free(world.LastSent);
+	free(world.Due);
+}
@@ -0,0 +1,74 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// benchmark for the server movement step at the scale of a large world
+
+#include "server_movement.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define MovementEntities 10000
+
+// one tick of the whole world
+static void StepWorld(void* context, int count)
+{
+	MovementStore* store = (MovementStore*)context;
+	for (int i = 0; i < count; i++)
+		StepMovement(store, 1.0f / 60.0f, MaxPlayerSpeed);
+}
+
+void BenchMovement()
+{
+	MovementStore store = { 0 };
+	if (!InitMovementStore(&store, MovementEntities))
+		return;
+
+	// scatter everyone over the field with random velocities, some of them too fast so the speed limit has work to do
+	srand(1234);
+	for (int i = 0; i < MovementEntities; i++)
+	{
+		float x = (float)(rand() % FieldSizeWidth);
+		float y = (float)(rand() % FieldSizeHeight);
+		float vx = (float)(rand() % 800 - 400);
+		float vy = (float)(rand() % 800 - 400);
+		SetMovementInput(&store, i, x, y, vx, vy, -1);
+	}
+
+	BenchPrintf("%d entities per tick\n", MovementEntities);
+	BenchMeasure("movement", "StepMovement", StepWorld, &store);
+
+	// use the result so the work can't be thrown away
+	double checksum = 0;
+	for (int i = 0; i < MovementEntities; i++)
+		checksum += store.X[i] + store.Y[i];
+	BenchPrintf("checksum %.0f\n", checksum);
+
+	FreeMovementStore(&store);
+}
@@ -0,0 +1,196 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// microbenchmarks for the primitives every message goes through
+// reading from a packet, making and destroying packets, queuing sends, and a full round trip through enet_host_service over loopback
+
+#include "net_common.h"
+#include "bench.h"
+
+#include <string.h>
+
+// big enough that the reads don't just hit the same few bytes
+#define ReadPacketSize 1024
+
+// how many sends are queued before they are flushed out to the socket, small enough to fit in one datagram
+#define SendBatch 32
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+static void ReadBytes(void* context, int count)
+{
+	ENetPacket* packet = (ENetPacket*)context;
+	size_t offset = 0;
+	uint32_t sum = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (offset >= ReadPacketSize)
+			offset = 0;
+		sum += ReadByte(packet, &offset);
+	}
+	Sink += sum;
+}
+
+static void ReadShorts(void* context, int count)
+{
+	ENetPacket* packet = (ENetPacket*)context;
+	size_t offset = 0;
+	uint32_t sum = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (offset + 2 > ReadPacketSize)
+			offset = 0;
+		sum += (uint16_t)ReadShort(packet, &offset);
+	}
+	Sink += sum;
+}
+
+// reads an UpdateInput message the way the server does
+static void ReadUpdateInputs(void* context, int count)
+{
+	ENetPacket* packet = (ENetPacket*)context;
+	uint32_t sum = 0;
+	for (int i = 0; i < count; i++)
+	{
+		size_t offset = 0;
+		sum += ReadByte(packet, &offset);
+		sum += (uint16_t)ReadShort(packet, &offset);
+		sum += (uint16_t)ReadShort(packet, &offset);
+		sum += (uint16_t)ReadShort(packet, &offset);
+		sum += (uint16_t)ReadShort(packet, &offset);
+	}
+	Sink += sum;
+}
+
+// makes and destroys an UpdatePlayer sized packet
+static void CreateDestroyPackets(void* context, int count)
+{
+	(void)context;
+
+	uint8_t buffer[10] = { UpdatePlayer };
+	for (int i = 0; i < count; i++)
+	{
+		ENetPacket* packet = enet_packet_create(buffer, sizeof(buffer), ENET_PACKET_FLAG_RELIABLE);
+		enet_packet_destroy(packet);
+	}
+}
+
+// queue unreliable UpdatePlayer messages to the server, flushing them out to the socket every batch so the queue doesn't grow forever
+// the flush, and the server reading the datagram, are part of the time, spread out over the batch
+static void SendPackets(void* context, int count)
+{
+	LoopbackPair* pair = (LoopbackPair*)context;
+	uint8_t buffer[10] = { UpdatePlayer };
+	for (int i = 0; i < count; i++)
+	{
+		ENetPacket* packet = enet_packet_create(buffer, sizeof(buffer), 0);
+		enet_peer_send(pair->ClientPeer, 0, packet);
+
+		if ((i + 1) % SendBatch == 0)
+		{
+			enet_host_flush(pair->Client);
+			DrainHost(pair->Server);
+		}
+	}
+
+	enet_host_flush(pair->Client);
+	DrainHost(pair->Server);
+}
+
+// wait for a message to arrive at a host, spinning on enet_host_service
+static ENetPacket* WaitForPacket(ENetHost* host)
+{
+	double start = BenchNow();
+	ENetEvent event = { 0 };
+	while (BenchNow() - start < LoopbackTimeout)
+	{
+		if (enet_host_service(host, &event, 0) > 0 && event.type == ENET_EVENT_TYPE_RECEIVE)
+			return event.packet;
+	}
+	return NULL;
+}
+
+// the client sends a reliable message, the server gets it and sends it back, and the client gets the echo
+static void RoundTrips(void* context, int count)
+{
+	LoopbackPair* pair = (LoopbackPair*)context;
+	uint8_t buffer[10] = { UpdatePlayer };
+	for (int i = 0; i < count; i++)
+	{
+		enet_peer_send(pair->ClientPeer, 0, enet_packet_create(buffer, sizeof(buffer), ENET_PACKET_FLAG_RELIABLE));
+		enet_host_flush(pair->Client);
+
+		ENetPacket* received = WaitForPacket(pair->Server);
+		if (received == NULL)
+			return;
+
+		// send the same packet back, enet lets go of it when it has been sent
+		enet_peer_send(pair->ServerPeer, 0, received);
+		enet_host_flush(pair->Server);
+
+		ENetPacket* echo = WaitForPacket(pair->Client);
+		if (echo == NULL)
+			return;
+		enet_packet_destroy(echo);
+	}
+}
+
+void BenchPrimitives()
+{
+	// a packet full of known bytes to read from
+	uint8_t data[ReadPacketSize];
+	for (int i = 0; i < ReadPacketSize; i++)
+		data[i] = (uint8_t)i;
+	ENetPacket* readPacket = enet_packet_create(data, sizeof(data), 0);
+
+	uint8_t input[9] = { UpdateInput, 1, 0, 2, 0, 3, 0, 4, 0 };
+	ENetPacket* inputPacket = enet_packet_create(input, sizeof(input), 0);
+
+	BenchMeasure("primitives", "ReadByte", ReadBytes, readPacket);
+	BenchMeasure("primitives", "ReadShort", ReadShorts, readPacket);
+	BenchMeasure("primitives", "read UpdateInput", ReadUpdateInputs, inputPacket);
+	BenchMeasure("primitives", "packet create/destroy", CreateDestroyPackets, NULL);
+
+	enet_packet_destroy(readPacket);
+	enet_packet_destroy(inputPacket);
+
+	LoopbackPair pair = { 0 };
+	if (ConnectLoopback(&pair))
+	{
+		BenchMeasure("primitives", "peer_send (flush every 32)", SendPackets, &pair);
+		BenchMeasure("primitives", "loopback round trip", RoundTrips, &pair);
+	}
+	else
+	{
+		BenchPrintf("could not connect over loopback, skipping the send benchmarks\n");
+	}
+
+	CloseLoopback(&pair);
+}
@@ -0,0 +1,129 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// benchmark for the snapshot priority accumulator at the scale of a large world
+// one player's view of thousands of entities, building up priority and picking what fits in a snapshot, every tick
+
+#include "server_priority.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define PriorityEntities 10000
+
+// about what fits in one player's byte budget for a tick
+#define PrioritySnapshotSize 100
+
+typedef struct
+{
+	MovementStore Store;
+	PriorityAccumulator Accumulator;
+	PriorityConfig Config;
+	uint8_t* Changed;
+	int Selected[PrioritySnapshotSize];
+}PriorityContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile int Sink = 0;
+
+// one tick for one player, build up priority for everyone, then send the top of the list
+static void PriorityTicks(void* context, int count)
+{
+	PriorityContext* world = (PriorityContext*)context;
+	for (int i = 0; i < count; i++)
+	{
+		AccumulatePriorities(&world->Accumulator, &world->Config, &world->Store, PriorityEntities,
+			FieldSizeWidth / 2.0f, FieldSizeHeight / 2.0f, world->Changed, 1.0f / 60.0f);
+
+		int selected = SelectTopPriorities(&world->Accumulator, PriorityEntities, PrioritySnapshotSize, world->Selected);
+		for (int s = 0; s < selected; s++)
+			ResetPriority(&world->Accumulator, world->Selected[s]);
+
+		Sink += selected;
+	}
+}
+
+void BenchPriority()
+{
+	PriorityContext world = { 0 };
+	world.Config = DefaultPriorityConfig();
+	world.Changed = (uint8_t*)malloc(PriorityEntities);
+
+	if (world.Changed == NULL || !InitMovementStore(&world.Store, PriorityEntities) || !InitPriorityAccumulator(&world.Accumulator, PriorityEntities))
+	{
+		BenchPrintf("out of memory\n");
+		free(world.Changed);
+		FreeMovementStore(&world.Store);
+		return;
+	}
+
+	// scatter everyone over the field, everyone always has news so nobody drops out of the running
+	srand(1234);
+	for (int i = 0; i < PriorityEntities; i++)
+	{
+		float x = (float)(rand() % FieldSizeWidth);
+		float y = (float)(rand() % FieldSizeHeight);
+		float vx = (float)(rand() % 400 - 200);
+		float vy = (float)(rand() % 400 - 200);
+		SetMovementInput(&world.Store, i, x, y, vx, vy, -1);
+		world.Changed[i] = 1;
+	}
+
+	BenchPrintf("%d entities, the top %d sent each tick\n", PriorityEntities, PrioritySnapshotSize);
+	BenchMeasure("priority", "accumulate and select", PriorityTicks, &world);
+
+	// with everyone waiting, how long until every entity has been sent at least once
+	ClearPriorities(&world.Accumulator);
+	int* lastSent = (int*)calloc(PriorityEntities, sizeof(int));
+	int longestWait = 0;
+	if (lastSent != NULL)
+	{
+		for (int tick = 1; tick <= 1000; tick++)
+		{
+			AccumulatePriorities(&world.Accumulator, &world.Config, &world.Store, PriorityEntities,
+				FieldSizeWidth / 2.0f, FieldSizeHeight / 2.0f, world.Changed, 1.0f / 60.0f);
+
+			int selected = SelectTopPriorities(&world.Accumulator, PriorityEntities, PrioritySnapshotSize, world.Selected);
+			for (int s = 0; s < selected; s++)
+			{
+				int entity = world.Selected[s];
+				if (tick - lastSent[entity] > longestWait)
+					longestWait = tick - lastSent[entity];
+				lastSent[entity] = tick;
+				ResetPriority(&world.Accumulator, entity);
+			}
+		}
+		BenchPrintf("longest wait between updates for any entity over 1000 ticks: %d ticks (%d would be perfectly fair)\n",
+			longestWait, PriorityEntities / PrioritySnapshotSize);
+		free(lastSent);
+	}
+
+	free(world.Changed);
+	FreePriorityAccumulator(&world.Accumulator);
+	FreeMovementStore(&world.Store);
+}
@@ -0,0 +1,134 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// simulated network benchmark for the adaptive rate controller
+// the link is modeled as a fixed latency plus a bottleneck queue that drains at a fixed number of bytes per second
+// when the sender sends faster than the link can drain, the queue grows and so does the latency
+
+#include "net_rate.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+// the link we are simulating
+#define LinkBytesPerSecond 4000       // a badly constrained link
+#define LinkLatency 0.040             // one way latency of an empty link in seconds
+#define LinkQueueLimit (64 * 1024)    // how many bytes the bottleneck can hold before it drops
+
+// what one snapshot costs on the wire
+#define UpdateSize 10                 // one UpdatePlayer message
+#define CommandOverhead 12            // enet command header
+#define PacketOverhead 40             // UDP/IP and enet protocol headers
+
+#define SimulatedSeconds 60.0
+#define SimulatedStep 0.001
+
+typedef struct
+{
+	double MaxLatency;
+	double MeanLatency;
+	double SendsPerSecond;
+	double UpdatesPerSecond;
+	int Dropped;
+}RateSimResult;
+
+// run the link for a while with the sender either following the controller or sending as fast as it can
+static RateSimResult SimulateLink(bool adaptive)
+{
+	RateSimResult result = { 0 };
+
+	RateControlConfig config = DefaultRateControlConfig();
+	RateControl rate = { 0 };
+	InitRateControl(&rate, &config);
+
+	double queuedBytes = 0;
+	double smoothedRTT = LinkLatency * 2;
+	int sends = 0;
+	int updates = 0;
+	double latencyTotal = 0;
+
+	for (double now = 0; now < SimulatedSeconds; now += SimulatedStep)
+	{
+		// the link drains at its fixed rate
+		queuedBytes -= LinkBytesPerSecond * SimulatedStep;
+		if (queuedBytes < 0)
+			queuedBytes = 0;
+
+		// a packet sent now has to wait for everything in front of it, this is what the acks will tell the sender
+		double queueDelay = queuedBytes / LinkBytesPerSecond;
+		double rtt = LinkLatency * 2 + queueDelay;
+		smoothedRTT += (rtt - smoothedRTT) / 8;
+
+		if (adaptive)
+			UpdateRateControlSample(&rate, &config, now, (uint32_t)(smoothedRTT * 1000), 0, (size_t)queuedBytes);
+
+		if (!RateControlShouldSend(&rate, now))
+			continue;
+
+		int detail = adaptive ? rate.Detail : config.MaxDetail;
+		double size = PacketOverhead + detail * (UpdateSize + CommandOverhead);
+
+		if (queuedBytes + size > LinkQueueLimit)
+		{
+			result.Dropped++;
+			continue;
+		}
+
+		queuedBytes += size;
+
+		// the latency of this snapshot is the time it takes to get through the queue and across the link
+		double latency = LinkLatency + queuedBytes / LinkBytesPerSecond;
+		latencyTotal += latency;
+		if (latency > result.MaxLatency)
+			result.MaxLatency = latency;
+
+		sends++;
+		updates += detail;
+	}
+
+	result.MeanLatency = sends > 0 ? latencyTotal / sends : 0;
+	result.SendsPerSecond = sends / SimulatedSeconds;
+	result.UpdatesPerSecond = updates / SimulatedSeconds;
+
+	return result;
+}
+
+static void PrintResult(const char* name, RateSimResult result)
+{
+	BenchPrintf("%-10s mean latency %7.1f ms  max latency %7.1f ms  %5.1f sends/s  %6.1f updates/s  %d dropped\n",
+		name, result.MeanLatency * 1000, result.MaxLatency * 1000, result.SendsPerSecond, result.UpdatesPerSecond, result.Dropped);
+}
+
+void BenchRateControl()
+{
+	BenchPrintf("link: %d bytes/s, %.0f ms one way, %.0f simulated seconds\n", LinkBytesPerSecond, LinkLatency * 1000, SimulatedSeconds);
+
+	PrintResult("fixed", SimulateLink(false));
+	PrintResult("adaptive", SimulateLink(true));
+}
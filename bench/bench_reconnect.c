@@ -0,0 +1,252 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// mass reconnect benchmark
+// after a server restarts, everyone who was playing connects again at about the same time
+// first this sends a server with room for 4000 players a connect for each of them, and times how long the server takes to handle each quarter of them,
+// which stays flat when handling a connect doesn't depend on how many peers there are
+// then 4000 real clients connect, disconnect and connect again, to see how long it takes for everyone to get in
+
+#include "net_common.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ReconnectClients 4000
+
+// the clients are spread over hosts with a few connections each, so the benchmark doesn't need thousands of sockets
+#define ReconnectPeersPerHost 16
+#define ReconnectHosts (ReconnectClients / ReconnectPeersPerHost)
+
+// how long a whole round can take before we give up on it, in seconds
+#define ReconnectTimeout 10.0
+
+// the server, the clients, and where a round is at
+typedef struct
+{
+	ENetHost* Server;
+	ENetAddress ServerAddress;
+	ENetHost* Hosts[ReconnectHosts];
+	ENetPeer* Peers[ReconnectClients];
+
+	int Connected;
+	int Disconnected;
+	bool Failed;
+}ReconnectContext;
+
+// run the server until it has nothing more to say, counting who connects and disconnects
+static void ServiceServer(ReconnectContext* reconnect)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(reconnect->Server, &event, 0) > 0)
+	{
+		if (event.type == ENET_EVENT_TYPE_CONNECT)
+			reconnect->Connected++;
+		else if (event.type == ENET_EVENT_TYPE_DISCONNECT || event.type == ENET_EVENT_TYPE_DISCONNECT_TIMEOUT)
+			reconnect->Disconnected++;
+		else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+			enet_packet_destroy(event.packet);
+	}
+}
+
+// connect every client, a host at a time so the server's socket buffer isn't overrun, then wait for them all
+static void ConnectAll(ReconnectContext* reconnect)
+{
+	reconnect->Connected = 0;
+
+	for (int h = 0; h < ReconnectHosts; h++)
+	{
+		for (int p = 0; p < ReconnectPeersPerHost; p++)
+			reconnect->Peers[h * ReconnectPeersPerHost + p] = enet_host_connect(reconnect->Hosts[h], &reconnect->ServerAddress, 1, 0);
+
+		enet_host_flush(reconnect->Hosts[h]);
+		ServiceServer(reconnect);
+	}
+
+	double start = BenchNow();
+	while (reconnect->Connected < ReconnectClients && BenchNow() - start < ReconnectTimeout)
+	{
+		// the server runs after every client host, or the replies from all of them at once overflow its socket and get resent much later
+		for (int h = 0; h < ReconnectHosts; h++)
+		{
+			DrainHost(reconnect->Hosts[h]);
+			ServiceServer(reconnect);
+		}
+	}
+
+	reconnect->Failed |= reconnect->Connected < ReconnectClients;
+}
+
+// drop every client, and let the server see them go
+static void DisconnectAll(ReconnectContext* reconnect)
+{
+	reconnect->Disconnected = 0;
+
+	for (int h = 0; h < ReconnectHosts; h++)
+	{
+		for (int p = 0; p < ReconnectPeersPerHost; p++)
+		{
+			ENetPeer* peer = reconnect->Peers[h * ReconnectPeersPerHost + p];
+			if (peer != NULL)
+				enet_peer_disconnect_now(peer, 0);
+		}
+		ServiceServer(reconnect);
+	}
+
+	double start = BenchNow();
+	while (reconnect->Disconnected < ReconnectClients && BenchNow() - start < ReconnectTimeout)
+		ServiceServer(reconnect);
+
+	reconnect->Failed |= reconnect->Disconnected < ReconnectClients;
+}
+
+// how many connects go out before the server gets to run, enough that one service call takes them all
+// enet reads up to 256 datagrams a call, and every call walks all the peers to send, which we don't want to count once per connect
+#define FillBurst 256
+
+// send a server a connect for every slot it has, from a socket for each client host, and time the server for each quarter
+static void FillServer(ENetAddress* address)
+{
+	ENetSocket sockets[ReconnectHosts];
+	int socketCount = 0;
+	while (socketCount < ReconnectHosts && (sockets[socketCount] = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM)) != ENET_SOCKET_NULL)
+		socketCount++;
+
+	ENetHost* server = enet_host_create(address, ReconnectClients, 1, 0, 0);
+	if (server == NULL || socketCount < ReconnectHosts)
+	{
+		BenchPrintf("could not set up a server on loopback, skipping the connect handling part\n");
+		if (server != NULL)
+			enet_host_destroy(server);
+		for (int i = 0; i < socketCount; i++)
+			enet_socket_destroy(sockets[i]);
+		return;
+	}
+
+	ENetAddress serverAddress = { 0 };
+	enet_socket_get_address(server->socket, &serverAddress);
+	serverAddress.host = address->host;
+
+	double quarterTimes[4] = { 0 };
+	uint8_t data[ConnectDatagramSize];
+	for (int i = 0; i < ReconnectClients; i += FillBurst)
+	{
+		int count = ReconnectClients - i < FillBurst ? ReconnectClients - i : FillBurst;
+		for (int c = i; c < i + count; c++)
+		{
+			ENetBuffer buffer = { 0 };
+			buffer.data = data;
+			buffer.dataLength = WriteConnectDatagram(data, (uint32_t)(c + 1));
+			enet_socket_send(sockets[c / ReconnectPeersPerHost], &serverAddress, &buffer, 1);
+		}
+
+		double start = BenchNow();
+		DrainHost(server);
+		quarterTimes[i * 4 / ReconnectClients] += BenchNow() - start;
+	}
+
+	int taken = 0;
+	for (size_t i = 0; i < server->peerCount; i++)
+	{
+		if (server->peers[i].state != ENET_PEER_STATE_DISCONNECTED)
+			taken++;
+	}
+
+	BenchPrintf("server time for each connect as the server fills:");
+	for (int q = 0; q < 4; q++)
+		BenchPrintf(" %.2fus", quarterTimes[q] * 1000000.0 / (ReconnectClients / 4));
+	BenchPrintf(" (%d of %d peers taken)\n", taken, ReconnectClients);
+
+	// and once it's full, what turning away one more costs
+	for (int i = 0; i < FillBurst; i++)
+	{
+		ENetBuffer buffer = { 0 };
+		buffer.data = data;
+		buffer.dataLength = WriteConnectDatagram(data, (uint32_t)(ReconnectClients + i + 1));
+		enet_socket_send(sockets[i % ReconnectHosts], &serverAddress, &buffer, 1);
+	}
+	double start = BenchNow();
+	DrainHost(server);
+	BenchPrintf("server time to turn away a connect when full: %.2fus\n", (BenchNow() - start) * 1000000.0 / FillBurst);
+
+	for (int i = 0; i < socketCount; i++)
+		enet_socket_destroy(sockets[i]);
+	enet_host_destroy(server);
+}
+
+void BenchReconnect()
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+
+	FillServer(&address);
+
+	ReconnectContext* reconnect = (ReconnectContext*)calloc(1, sizeof(ReconnectContext));
+	if (reconnect == NULL)
+		return;
+
+	bool ready = (reconnect->Server = enet_host_create(&address, ReconnectClients, 1, 0, 0)) != NULL;
+	for (int h = 0; h < ReconnectHosts && ready; h++)
+		ready = (reconnect->Hosts[h] = enet_host_create(NULL, ReconnectPeersPerHost, 1, 0, 0)) != NULL;
+
+	if (ready)
+	{
+		enet_socket_get_address(reconnect->Server->socket, &reconnect->ServerAddress);
+		reconnect->ServerAddress.host = address.host;
+
+		double start = BenchNow();
+		ConnectAll(reconnect);
+		double connectTime = BenchNow() - start;
+
+		start = BenchNow();
+		DisconnectAll(reconnect);
+		ConnectAll(reconnect);
+		double reconnectTime = BenchNow() - start;
+
+		if (reconnect->Failed)
+			BenchPrintf("not every client got through in %.0f seconds\n", ReconnectTimeout);
+		else
+			BenchPrintf("%d clients over %d hosts: everyone was in after %.0fms, and everyone left and was back in after %.0fms\n",
+				ReconnectClients, ReconnectHosts, connectTime * 1000.0, reconnectTime * 1000.0);
+	}
+	else
+	{
+		BenchPrintf("could not make the hosts on loopback, skipping the reconnect part\n");
+	}
+
+	for (int h = 0; h < ReconnectHosts; h++)
+	{
+		if (reconnect->Hosts[h] != NULL)
+			enet_host_destroy(reconnect->Hosts[h]);
+	}
+	if (reconnect->Server != NULL)
+		enet_host_destroy(reconnect->Server);
+	free(reconnect);
+}
@@ -0,0 +1,204 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// server address resolution benchmark
+// the client used to look up the server's name with enet_address_set_host on the render thread, so a slow DNS server froze the game until it answered
+// this compares that with the resolver, which looks names up on a worker thread and caches what it finds
+// a stub resolver that takes a set time stands in for slow DNS, and "localhost" (from /etc/hosts) is used for the real thing
+
+#include "net_common.h"
+#include "net_resolve.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+// how long the stub resolver takes to answer, like a DNS server that is having a bad day
+#define ResolveStubDelay 0.25
+
+// how long a frame is, at 60 frames a second
+#define ResolveFrameTime (1.0 / 60.0)
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+// a resolver that waits before answering with loopback, it runs on the worker thread so waiting here doesn't stop anything else
+static int SlowStubResolve(ENetAddress* address, const char* name)
+{
+	(void)name;
+	double start = BenchNow();
+	while (BenchNow() - start < ResolveStubDelay)
+		;
+
+	return enet_address_set_host_ip_new(address, "127.0.0.1");
+}
+
+// how a lookup went from the point of view of a game loop that is drawing frames while it waits
+typedef struct
+{
+	// the longest any one call made the loop wait
+	double LongestStall;
+
+	// how long until we had the address, and how many frames that took
+	double Total;
+	int Frames;
+
+	bool Succeeded;
+}ResolveRun;
+
+// look a name up the old way, in the middle of a frame
+static ResolveRun ResolveBlocking(ResolveHostFunction resolve, const char* name)
+{
+	ResolveRun run = { 0 };
+	ENetAddress address = { 0 };
+
+	double start = BenchNow();
+	run.Succeeded = resolve(&address, name) == 0;
+	run.Total = run.LongestStall = BenchNow() - start;
+	run.Frames = 1;
+
+	return run;
+}
+
+// look a name up with the resolver, checking once a frame until it is done
+static ResolveRun ResolveInFrames(AddressResolver* resolver, const char* name)
+{
+	ResolveRun run = { 0 };
+	ENetAddress address = { 0 };
+
+	double start = BenchNow();
+	ResolveStatus status = StartResolve(resolver, name, &address);
+	run.LongestStall = BenchNow() - start;
+	run.Frames = 1;
+
+	while (status == ResolvePending)
+	{
+		// the rest of the frame goes by
+		double frameEnd = start + run.Frames * ResolveFrameTime;
+		while (BenchNow() < frameEnd)
+			;
+
+		double pollStart = BenchNow();
+		status = PollResolve(resolver, &address);
+		double stall = BenchNow() - pollStart;
+		if (stall > run.LongestStall)
+			run.LongestStall = stall;
+		run.Frames++;
+	}
+
+	run.Total = BenchNow() - start;
+	run.Succeeded = status == ResolveDone;
+	Sink += address.host.s6_addr[15];
+
+	return run;
+}
+
+static void PrintRun(const char* name, ResolveRun run)
+{
+	BenchPrintf("  %-28s longest stall %9.3fms, address after %8.3fms, %2d frame%s%s\n", name, run.LongestStall * 1000.0, run.Total * 1000.0,
+		run.Frames, run.Frames == 1 ? "" : "s", run.Succeeded ? "" : " (failed)");
+}
+
+static void BlockingLocalhost(void* context, int count)
+{
+	(void)context;
+	for (int c = 0; c < count; c++)
+	{
+		ENetAddress address = { 0 };
+		enet_address_set_host(&address, "localhost");
+		Sink += address.host.s6_addr[15];
+	}
+}
+
+// a lookup that is not in the cache, including starting the thread, waiting as little as possible for it
+static void ColdLocalhost(void* context, int count)
+{
+	AddressResolver* resolver = (AddressResolver*)context;
+	for (int c = 0; c < count; c++)
+	{
+		ENetAddress address = { 0 };
+		ForgetResolvedAddress(resolver, "localhost");
+		ResolveStatus status = StartResolve(resolver, "localhost", &address);
+		while (status == ResolvePending)
+		{
+			BenchYield();
+			status = PollResolve(resolver, &address);
+		}
+		Sink += address.host.s6_addr[15];
+	}
+}
+
+// a reconnect, the name is already in the cache
+static void CachedLocalhost(void* context, int count)
+{
+	AddressResolver* resolver = (AddressResolver*)context;
+	for (int c = 0; c < count; c++)
+	{
+		ENetAddress address = { 0 };
+		StartResolve(resolver, "localhost", &address);
+		Sink += address.host.s6_addr[15];
+	}
+}
+
+static void NumericLoopback(void* context, int count)
+{
+	AddressResolver* resolver = (AddressResolver*)context;
+	for (int c = 0; c < count; c++)
+	{
+		ENetAddress address = { 0 };
+		StartResolve(resolver, "127.0.0.1", &address);
+		Sink += address.host.s6_addr[15];
+	}
+}
+
+void BenchResolve()
+{
+	AddressResolver resolver;
+	InitAddressResolver(&resolver, 60.0);
+	resolver.Resolve = SlowStubResolve;
+
+	BenchPrintf("looking up a server name with a resolver that takes %.0fms, checking once a frame at 60 frames a second\n", ResolveStubDelay * 1000.0);
+	PrintRun("blocking", ResolveBlocking(SlowStubResolve, "slow.example"));
+	PrintRun("worker thread", ResolveInFrames(&resolver, "slow.example"));
+	PrintRun("reconnect, from the cache", ResolveInFrames(&resolver, "slow.example"));
+
+	// a lookup that is abandoned part way has to clean up after itself, without making us wait for it
+	ForgetResolvedAddress(&resolver, "slow.example");
+	double start = BenchNow();
+	ENetAddress address = { 0 };
+	StartResolve(&resolver, "slow.example", &address);
+	CancelResolve(&resolver);
+	BenchPrintf("  %-28s %9.3fms\n", "start and cancel", (BenchNow() - start) * 1000.0);
+
+	// the real resolver, localhost comes from /etc/hosts so this never leaves the machine
+	InitAddressResolver(&resolver, 60.0);
+	BenchMeasure("resolve", "localhost, blocking", BlockingLocalhost, NULL);
+	BenchMeasure("resolve", "localhost, worker thread", ColdLocalhost, &resolver);
+	BenchMeasure("resolve", "localhost, from the cache", CachedLocalhost, &resolver);
+	BenchMeasure("resolve", "127.0.0.1, numeric", NumericLoopback, &resolver);
+	CancelResolve(&resolver);
+}
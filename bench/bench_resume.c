@@ -0,0 +1,381 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// session resumption benchmark
+// a player whose connection drops connects again, and has to be back in the game before they can play
+// without a session they are a new player, and get the whole world again in a join snapshot
+// with one, they keep the world they had, tell the server how many messages they got and who they still have, and only get what they missed
+// this runs both over loopback, from making the client host to having the world, for worlds of 1000 and 5000 entities
+
+#include "net_common.h"
+#include "net_batch.h"
+#include "server_session.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the server sends this many join snapshot packets a tick, like the real one
+#define ResumeBenchChunksPerTick 4
+#define ResumeBenchTickRate 60
+
+// how much of the world happened while the player was away
+// some entities moved, a few left, and the last few messages sent before the drop never made it
+#define ResumeChangedPercent 5
+#define ResumeLeftPercent 1
+#define ResumeLostPercent 2
+
+// the world on the server, what it had sent the player before they dropped, and what the client has read
+typedef struct
+{
+	ENetHost* Server;
+	ENetAddress Address;
+	int Entities;
+
+	uint8_t* Present;
+	uint32_t* Versions;
+	uint32_t* SentMessages;
+	uint32_t* DroppedVersions;
+	uint32_t* SentVersions;
+	uint8_t* Remove;
+
+	// what the client has, one bit for each entity, and how many messages it got before the drop
+	uint8_t* KnownMask;
+	size_t KnownMaskSize;
+	uint32_t MessagesReceived;
+
+	int Received;
+	int Resent;
+	bool Complete;
+}ResumeContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile uint32_t Sink = 0;
+
+// service both hosts until the client is connected and the server has seen it, returning the server's peer
+static ENetPeer* ConnectClient(ResumeContext* resume, ENetHost* client, uint32_t token)
+{
+	ENetPeer* clientPeer = enet_host_connect(client, &resume->Address, 1, token);
+	if (clientPeer == NULL)
+		return NULL;
+
+	ENetPeer* serverPeer = NULL;
+	double start = BenchNow();
+	while ((serverPeer == NULL || clientPeer->state != ENET_PEER_STATE_CONNECTED) && BenchNow() - start < LoopbackTimeout)
+	{
+		ENetEvent event = { 0 };
+		while (enet_host_service(resume->Server, &event, 0) > 0)
+		{
+			if (event.type == ENET_EVENT_TYPE_CONNECT)
+				serverPeer = event.peer;
+			else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+				enet_packet_destroy(event.packet);
+		}
+		enet_host_service(client, &event, 0);
+	}
+
+	return clientPeer->state == ENET_PEER_STATE_CONNECTED ? serverPeer : NULL;
+}
+
+// send a list of entities as join snapshots, as full as a packet can be, the last one says the client is caught up
+static void SendSnapshots(ResumeContext* resume, ENetPeer* peer, bool onlyStale)
+{
+	int entity = 0;
+	do
+	{
+		uint8_t buffer[MessageBatchCapacity];
+		size_t length = JoinSnapshotHeaderSize;
+		uint16_t entries = 0;
+		for (; entity < resume->Entities && length + JoinSnapshotEntrySize <= sizeof(buffer); entity++)
+		{
+			if (!resume->Present[entity] || (onlyStale && resume->SentVersions[entity] == resume->Versions[entity]))
+				continue;
+
+			*(uint16_t*)(buffer + length) = (uint16_t)entity;
+			*(int16_t*)(buffer + length + 2) = (int16_t)(entity % 1000);
+			*(int16_t*)(buffer + length + 4) = (int16_t)(entity / 1000);
+			*(int16_t*)(buffer + length + 6) = 1;
+			*(int16_t*)(buffer + length + 8) = -1;
+			length += JoinSnapshotEntrySize;
+			entries++;
+		}
+
+		buffer[0] = (uint8_t)JoinSnapshot;
+		buffer[1] = entity < resume->Entities ? 0 : JoinSnapshotLast;
+		*(uint16_t*)(buffer + 2) = entries;
+		enet_peer_send(peer, 0, enet_packet_create(buffer, length, ENET_PACKET_FLAG_RELIABLE));
+	} while (entity < resume->Entities);
+
+	enet_host_flush(resume->Server);
+}
+
+// the server's side of a player coming back with their session, read what they have and send what they missed
+static void ServeResume(ResumeContext* resume, ENetPeer* peer, ENetPacket* packet)
+{
+	size_t offset = 1;
+	uint32_t received = (uint32_t)ReadInt(packet, &offset);
+	if (packet->dataLength < offset + resume->KnownMaskSize)
+		return;
+
+	memcpy(resume->SentVersions, resume->DroppedVersions, resume->Entities * sizeof(uint32_t));
+	resume->Resent = GetResumeDelta(resume->Entities, resume->Present, resume->Versions, resume->SentVersions, resume->SentMessages, received, packet->data + offset, resume->Remove);
+
+	MessageBatch batch = { 0 };
+	for (int i = 0; i < resume->Entities; i++)
+	{
+		if (!resume->Remove[i])
+			continue;
+
+		uint8_t message[3] = { (uint8_t)RemovePlayer, (uint8_t)i, (uint8_t)(i >> 8) };
+		BatchMessage(&batch, peer, message, sizeof(message));
+	}
+	FlushMessageBatch(&batch, peer);
+
+	SendSnapshots(resume, peer, true);
+}
+
+// read what has arrived at the client, until the last join snapshot
+static void ReceiveWorld(ResumeContext* resume, ENetHost* client)
+{
+	ENetEvent event = { 0 };
+	while (enet_host_service(client, &event, 0) > 0)
+	{
+		if (event.type != ENET_EVENT_TYPE_RECEIVE)
+			continue;
+
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event.packet);
+
+		size_t offset = 0;
+		while (ReadNextMessage(&reader, &offset) > 0)
+		{
+			uint8_t command = ReadByte(event.packet, &offset);
+			if (command == JoinSnapshot)
+			{
+				uint8_t flags = ReadByte(event.packet, &offset);
+				uint16_t count = (uint16_t)ReadShort(event.packet, &offset);
+				for (uint16_t i = 0; i < count; i++)
+				{
+					uint32_t sum = (uint16_t)ReadShort(event.packet, &offset);
+					for (int s = 0; s < 4; s++)
+						sum += (uint16_t)ReadShort(event.packet, &offset);
+					Sink += sum;
+					resume->Received++;
+				}
+				resume->Complete = (flags & JoinSnapshotLast) != 0;
+			}
+		}
+
+		enet_packet_destroy(event.packet);
+	}
+}
+
+// make a client host, connect, and get back into the game, either as a new player or by resuming the session
+static void Reconnect(ResumeContext* resume, bool resumeSession)
+{
+	resume->Received = 0;
+	resume->Complete = false;
+
+	ENetHost* client = enet_host_create(NULL, 1, 1, 0, 0);
+	if (client == NULL)
+		return;
+
+	ENetPeer* serverPeer = ConnectClient(resume, client, resumeSession ? 1 : 0);
+	if (serverPeer != NULL)
+	{
+		uint8_t accept[AcceptPlayerSize] = { (uint8_t)AcceptPlayer, 0, resumeSession ? AcceptResumed : 0 };
+		enet_peer_send(serverPeer, 0, enet_packet_create(accept, sizeof(accept), ENET_PACKET_FLAG_RELIABLE));
+
+		if (resumeSession)
+		{
+			// the client's first message, how many messages it got and who it still has
+			size_t size = ResumeSessionHeaderSize + resume->KnownMaskSize;
+			ENetPacket* packet = enet_packet_create(NULL, size, ENET_PACKET_FLAG_RELIABLE);
+			packet->data[0] = (uint8_t)ResumeSession;
+			memcpy(packet->data + 1, &resume->MessagesReceived, sizeof(uint32_t));
+			memcpy(packet->data + ResumeSessionHeaderSize, resume->KnownMask, resume->KnownMaskSize);
+			enet_peer_send(client->peers, 0, packet);
+			enet_host_flush(client);
+		}
+		else
+		{
+			SendSnapshots(resume, serverPeer, false);
+		}
+
+		double start = BenchNow();
+		while (!resume->Complete && BenchNow() - start < LoopbackTimeout)
+		{
+			ENetEvent event = { 0 };
+			while (enet_host_service(resume->Server, &event, 0) > 0)
+			{
+				if (event.type != ENET_EVENT_TYPE_RECEIVE)
+					continue;
+
+				if (event.packet->dataLength > 0 && event.packet->data[0] == ResumeSession)
+					ServeResume(resume, serverPeer, event.packet);
+				enet_packet_destroy(event.packet);
+			}
+			ReceiveWorld(resume, client);
+		}
+	}
+
+	enet_peer_disconnect_now(client->peers, 0);
+	enet_host_destroy(client);
+	if (serverPeer != NULL)
+		enet_peer_reset(serverPeer);
+}
+
+static void Rejoin(void* context, int count)
+{
+	for (int c = 0; c < count; c++)
+		Reconnect((ResumeContext*)context, false);
+}
+
+static void Resume(void* context, int count)
+{
+	for (int c = 0; c < count; c++)
+		Reconnect((ResumeContext*)context, true);
+}
+
+// set up the world as it was when the player dropped, and what happened while they were away
+static bool MakeWorld(ResumeContext* resume, int entities)
+{
+	resume->Entities = entities;
+	resume->Present = (uint8_t*)calloc(entities, 1);
+	resume->Remove = (uint8_t*)calloc(entities, 1);
+	resume->Versions = (uint32_t*)calloc(entities, sizeof(uint32_t));
+	resume->SentMessages = (uint32_t*)calloc(entities, sizeof(uint32_t));
+	resume->DroppedVersions = (uint32_t*)calloc(entities, sizeof(uint32_t));
+	resume->SentVersions = (uint32_t*)calloc(entities, sizeof(uint32_t));
+	resume->KnownMaskSize = (entities + 7) / 8;
+	resume->KnownMask = (uint8_t*)calloc(resume->KnownMaskSize, 1);
+	if (resume->Present == NULL || resume->Remove == NULL || resume->Versions == NULL || resume->SentMessages == NULL ||
+		resume->DroppedVersions == NULL || resume->SentVersions == NULL || resume->KnownMask == NULL)
+		return false;
+
+	// before the drop the player had everyone, the updates went out about a hundred to a message
+	uint32_t messages = 0;
+	for (int i = 0; i < entities; i++)
+	{
+		resume->Present[i] = 1;
+		resume->Versions[i] = 1 + (uint32_t)(i % 7);
+		resume->DroppedVersions[i] = resume->Versions[i];
+		resume->SentMessages[i] = messages = 1 + (uint32_t)i / 100;
+		resume->KnownMask[i / 8] |= (uint8_t)(1 << (i % 8));
+	}
+
+	// the last few messages never got there
+	resume->MessagesReceived = messages - messages * ResumeLostPercent / 100;
+
+	// and while they were away, some entities moved and a few left, spread over the world
+	srand(42);
+	for (int i = 0; i < entities; i++)
+	{
+		int roll = rand() % 100;
+		if (roll < ResumeLeftPercent)
+			resume->Present[i] = 0;
+		else if (roll < ResumeLeftPercent + ResumeChangedPercent)
+			resume->Versions[i]++;
+	}
+
+	return true;
+}
+
+static void FreeWorld(ResumeContext* resume)
+{
+	free(resume->Present);
+	free(resume->Remove);
+	free(resume->Versions);
+	free(resume->SentMessages);
+	free(resume->DroppedVersions);
+	free(resume->SentVersions);
+	free(resume->KnownMask);
+}
+
+// get back in once, and say what it took, and how long the server's pacing would make it take
+static void PrintReconnectCost(const char* name, BenchOperation operation, ResumeContext* resume)
+{
+	uint64_t packets = resume->Server->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count;
+	uint64_t wireBytes = resume->Server->totalSentData;
+
+	operation(resume, 1);
+
+	int entriesPerChunk = (MessageBatchCapacity - JoinSnapshotHeaderSize) / JoinSnapshotEntrySize;
+	int chunks = (resume->Received + entriesPerChunk - 1) / entriesPerChunk;
+	int ticks = chunks == 0 ? 1 : (chunks + ResumeBenchChunksPerTick - 1) / ResumeBenchChunksPerTick;
+
+	BenchPrintf("  %-8s %5d entities sent, %4llu packets, %7llu wire bytes, caught up after %d tick%s (%.1fms at %d ticks a second)%s\n", name,
+		resume->Received, (unsigned long long)(resume->Server->traffic.ProtocolSent[ENET_PROTOCOL_COMMAND_SEND_RELIABLE].Count - packets),
+		(unsigned long long)(resume->Server->totalSentData - wireBytes), ticks, ticks == 1 ? "" : "s", ticks * 1000.0 / ResumeBenchTickRate, ResumeBenchTickRate,
+		resume->Complete ? "" : " (did not finish)");
+}
+
+void BenchResume()
+{
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+
+	// the real server asks for connect cookies, so both ways pay for that round trip
+	ENetHost* server = enet_host_create(&address, 4, 1, 0, 0);
+	if (server == NULL)
+	{
+		BenchPrintf("could not make a server on loopback, skipping the resume benchmarks\n");
+		return;
+	}
+	enet_host_connect_cookies(server, 1, NULL);
+	enet_socket_get_address(server->socket, &address);
+	address.host = server->address.host;
+
+	static const int entities[] = { 1000, 5000 };
+	for (size_t i = 0; i < sizeof(entities) / sizeof(entities[0]); i++)
+	{
+		ResumeContext resume = { 0 };
+		resume.Server = server;
+		resume.Address = address;
+
+		if (MakeWorld(&resume, entities[i]))
+		{
+			char name[64];
+			BenchPrintf("getting back into a world of %d entities, %d%% moved and %d%% left while away, the last %d%% of messages lost\n",
+				entities[i], ResumeChangedPercent, ResumeLeftPercent, ResumeLostPercent);
+			PrintReconnectCost("rejoin", Rejoin, &resume);
+			PrintReconnectCost("resume", Resume, &resume);
+
+			snprintf(name, sizeof(name), "%d entities, rejoin", entities[i]);
+			BenchMeasure("resume", name, Rejoin, &resume);
+
+			snprintf(name, sizeof(name), "%d entities, resume", entities[i]);
+			BenchMeasure("resume", name, Resume, &resume);
+		}
+
+		FreeWorld(&resume);
+	}
+
+	enet_host_destroy(server);
+}
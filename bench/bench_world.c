@@ -0,0 +1,219 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// world state query benchmark
+// the renderer used to ask the client for each player's position by id, one call at a time, out of an array of player structs
+// this compares that with copying every visible entity out of the packed entity view in one call, for a world of 10000 entities
+// it also times keeping the view up to date, which the client does in its extrapolation step once an update
+
+#include "net_world.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WorldBenchEntities 10000
+
+// how many of the entities are active, the rest are empty slots the per id loop still has to ask about
+#define WorldBenchActivePercent 90
+
+// the same layout as the client's RemotePlayer
+typedef struct
+{
+	bool Active;
+	Vector2 Position;
+	Vector2 Direction;
+	double UpdateTime;
+	double UpdateInterval;
+	Vector2 Correction;
+	Vector2 ExtrapolatedPosition;
+}WorldBenchPlayer;
+
+typedef struct
+{
+	WorldBenchPlayer* Players;
+	int LocalPlayerId;
+
+	EntityView View;
+	uint32_t Palette[8];
+
+	// what the renderer fills in
+	int* Ids;
+	Vector2* Positions;
+	uint32_t* Colors;
+}WorldBenchContext;
+
+// keeps results alive so the compiler can't throw the work away
+static volatile float Sink = 0;
+
+// the per id query, the same checks as ClientGetPlayerPos
+static bool GetPlayerPosById(WorldBenchContext* world, int id, Vector2* pos)
+{
+	if (id < 0 || id >= WorldBenchEntities || !world->Players[id].Active)
+		return false;
+
+	if (id == world->LocalPlayerId)
+		*pos = world->Players[id].Position;
+	else
+		*pos = world->Players[id].ExtrapolatedPosition;
+	return true;
+}
+
+// called through a pointer, since in the client it is in another file and can't be inlined into the draw loop
+static bool (*volatile GetPlayerPosCall)(WorldBenchContext* world, int id, Vector2* pos) = GetPlayerPosById;
+
+// the old way, asking about every id, filling the same arrays the bulk query does so both end up with the same thing
+static void QueryEachId(void* context, int count)
+{
+	WorldBenchContext* world = (WorldBenchContext*)context;
+	bool (*getPos)(WorldBenchContext*, int, Vector2*) = GetPlayerPosCall;
+
+	for (int c = 0; c < count; c++)
+	{
+		int visible = 0;
+		for (int i = 0; i < WorldBenchEntities; i++)
+		{
+			if (getPos(world, i, &world->Positions[visible]))
+			{
+				world->Ids[visible] = i;
+				world->Colors[visible] = world->Palette[i % 8];
+				visible++;
+			}
+		}
+		Sink += world->Positions[visible / 2].x;
+	}
+}
+
+// one call for everything
+static void QueryBulk(void* context, int count)
+{
+	WorldBenchContext* world = (WorldBenchContext*)context;
+	for (int c = 0; c < count; c++)
+	{
+		int visible = CopyEntityView(&world->View, world->Ids, world->Positions, world->Colors, world->Palette, 8, WorldBenchEntities);
+		Sink += world->Positions[visible / 2].x;
+	}
+}
+
+// the client's extrapolation step, which runs over every player once an update
+// it used to write the extrapolated position into the player table, now it goes into the view, and inactive players are taken out
+static void Extrapolate(WorldBenchContext* world, bool updateView)
+{
+	for (int i = 0; i < WorldBenchEntities; i++)
+	{
+		WorldBenchPlayer* player = &world->Players[i];
+		if (!player->Active)
+		{
+			if (updateView)
+				RemoveEntity(&world->View, i);
+			continue;
+		}
+
+		if (i == world->LocalPlayerId)
+		{
+			if (updateView)
+				SetEntityPosition(&world->View, i, player->Position);
+			continue;
+		}
+
+		double delta = 0.01 - player->UpdateTime;
+		double maxDelta = player->UpdateInterval * 2.0;
+		if (delta > maxDelta)
+			delta = maxDelta;
+
+		float correction = player->UpdateInterval > 0 ? (float)(1.0 - delta / player->UpdateInterval) : 0.0f;
+		if (correction < 0)
+			correction = 0;
+
+		Vector2 extrapolated = Vector2Add(player->Position, Vector2Scale(player->Direction, (float)delta));
+		extrapolated = Vector2Add(extrapolated, Vector2Scale(player->Correction, correction));
+		if (updateView)
+			SetEntityPosition(&world->View, i, extrapolated);
+		else
+			player->ExtrapolatedPosition = extrapolated;
+	}
+}
+
+static void ExtrapolateOnly(void* context, int count)
+{
+	for (int c = 0; c < count; c++)
+		Extrapolate((WorldBenchContext*)context, false);
+}
+
+static void ExtrapolateAndUpdateView(void* context, int count)
+{
+	for (int c = 0; c < count; c++)
+		Extrapolate((WorldBenchContext*)context, true);
+}
+
+void BenchWorldState()
+{
+	WorldBenchContext world = { 0 };
+	world.Players = (WorldBenchPlayer*)calloc(WorldBenchEntities, sizeof(WorldBenchPlayer));
+	world.Ids = (int*)malloc(WorldBenchEntities * sizeof(int));
+	world.Positions = (Vector2*)malloc(WorldBenchEntities * sizeof(Vector2));
+	world.Colors = (uint32_t*)malloc(WorldBenchEntities * sizeof(uint32_t));
+	if (world.Players == NULL || world.Ids == NULL || world.Positions == NULL || world.Colors == NULL || !InitEntityView(&world.View, WorldBenchEntities))
+	{
+		BenchPrintf("out of memory, skipping the world state benchmarks\n");
+		free(world.Players);
+		free(world.Ids);
+		free(world.Positions);
+		free(world.Colors);
+		return;
+	}
+
+	// players come and go, so the active ones are spread all over the table
+	srand(42);
+	world.LocalPlayerId = 0;
+	for (int i = 0; i < WorldBenchEntities; i++)
+	{
+		WorldBenchPlayer* player = &world.Players[i];
+		player->Active = i == 0 || rand() % 100 < WorldBenchActivePercent;
+		player->Position = (Vector2){ (float)(rand() % 1280), (float)(rand() % 800) };
+		player->Direction = (Vector2){ (float)(rand() % 3 - 1), (float)(rand() % 3 - 1) };
+		player->UpdateInterval = 1.0 / 30.0;
+	}
+	for (int i = 0; i < 8; i++)
+		world.Palette[i] = 0xFF0000FFu >> i;
+
+	ExtrapolateOnly(&world, 1);
+	ExtrapolateAndUpdateView(&world, 1);
+	BenchPrintf("a world of %d entities, %d visible\n", WorldBenchEntities, world.View.Count);
+
+	BenchMeasure("world", "10000 entities, query each id", QueryEachId, &world);
+	BenchMeasure("world", "10000 entities, bulk query", QueryBulk, &world);
+	BenchMeasure("world", "10000 entities, extrapolate into the table", ExtrapolateOnly, &world);
+	BenchMeasure("world", "10000 entities, extrapolate into the view", ExtrapolateAndUpdateView, &world);
+
+	FreeEntityView(&world.View);
+	free(world.Players);
+	free(world.Ids);
+	free(world.Positions);
+	free(world.Colors);
+}
@@ -0,0 +1,64 @@
+-- Copyright (c) 2020-2024 Jeffery Myers
+--
+--This software is provided "as-is", without any express or implied warranty. In no event 
+--will the authors be held liable for any damages arising from the use of this software.
+
+--Permission is granted to anyone to use this software for any purpose, including commercial 
+--applications, and to alter it and redistribute it freely, subject to the following restrictions:
+
+--  1. The origin of this software must not be misrepresented; you must not claim that you 
+--  wrote the original software. If you use this software in a product, an acknowledgment 
+--  in the product documentation would be appreciated but is not required.
+--
+--  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+--  as being the original software.
+--
+--  3. This notice may not be removed or altered from any source distribution.
+
+baseName = path.getbasename(os.getcwd());
+
+project (baseName)
+    kind "ConsoleApp"
+    location "../build"
+    targetdir "../bin/%{cfg.buildcfg}"
+
+    filter "action:vs*"
+        defines{"_WINSOCK_DEPRECATED_NO_WARNINGS", "_CRT_SECURE_NO_WARNINGS"}
+        characterset ("MBCS")
+        debugdir "$(SolutionDir)"
+
+    filter "system:windows"
+        defines{"_WIN32"}
+        links {"winmm", "kernel32", "ws2_32"}
+        libdirs {"../_bin/%{cfg.buildcfg}"}
+
+    filter "system:linux"
+        links {"pthread", "m", "dl", "rt"}
+
+    filter "system:macosx"
+        links {"CoreFoundation.framework"}
+
+    filter{}
+
+    vpaths 
+    {
+        ["Header Files/*"] = { "include/**.h",  "include/**.hpp", "src/**.h", "src/**.hpp", "**.h", "**.hpp"},
+        ["Source Files/*"] = {"src/**.c", "src/**.cpp","**.c", "**.cpp"},
+    }
+    files {"**.c", "**.cpp", "**.h", "**.hpp"}
+
+    -- the server and client systems that are benchmarked
+    files {"../server/server_movement.c", "../server/server_priority.c", "../server/server_lod.c", "../server/server_session.c", "../server/server_backpressure.c"}
+    includedirs { "../server" }
+
+    -- the headless client, built with the bench's copy of enet and without linking raylib
+    files {"../client/net_client.c", "../client/net_world.c"}
+    includedirs { "../client" }
+    defines {"NET_CLIENT_EXTERNAL_ENET", "RAYMATH_STATIC_INLINE"}
+  
+    includedirs { "./" }
+    includedirs { "src" }
+    includedirs { "include" }
+    
+    link_to("networking")
+    include_raylib()
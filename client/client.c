@@ -40,6 +40,9 @@
 // a list of predefined colors based on the player lost
 static Color PlayerColors[MAX_PLAYERS] = { 0 };
 
+// the same colors packed into integers, the way the network code hands them back with the world state
+static uint32_t PlayerColorValues[MAX_PLAYERS] = { 0 };
+
 void SetColors()
 {
 	PlayerColors[0] = WHITE;
@@ -50,6 +53,9 @@ void SetColors()
 	PlayerColors[5] = GRAY;
 	PlayerColors[6] = YELLOW;
 	PlayerColors[7] = ORANGE;
+
+	for (int i = 0; i < MAX_PLAYERS; i++)
+		PlayerColorValues[i] = (uint32_t)ColorToInt(PlayerColors[i]);
 }
 
 typedef enum GameState
@@ -64,6 +70,9 @@ static GameState State = Disconnected;
 
 static bool RunGame = true;
 
+// true when the network stats are shown next to the FPS, F3 turns them on and off
+static bool ShowNetStats = false;
+
 static void Quit()
 {
 	RunGame = false;
@@ -79,6 +88,9 @@ void UpdateGame()
 	// this will process any inbound events and update the local simulation
 	Update(GetTime(), GetFrameTime());
 
+	if (IsKeyPressed(KEY_F3))
+		ShowNetStats = !ShowNetStats;
+
 	switch (State)
 	{
 	case Disconnected:
@@ -158,18 +170,46 @@ void DrawGame()
 		DrawText(TextFormat("Player %d", GetLocalPlayerId()), 0, 20, 20, PlayerColors[GetLocalPlayerId()]);
 
 		// draw all active players, this includes our local player since the game system is maintaining the local simulation
-		for (int i = 0; i < MAX_PLAYERS; i++)
+		// we get everyone in one call, already packed together, instead of asking about each player
+		Vector2 positions[MAX_PLAYERS];
+		uint32_t colors[MAX_PLAYERS];
+		int count = GetWorldState(NULL, positions, colors, PlayerColorValues, MAX_PLAYERS, MAX_PLAYERS);
+		for (int i = 0; i < count; i++)
 		{
-			Vector2 pos = { 0 };
-			if (GetPlayerPos(i, &pos))
-			{
-				DrawRectangle((int)pos.x, (int)pos.y, PlayerSize, PlayerSize, PlayerColors[i]);
-			}
+			DrawRectangle((int)positions[i].x, (int)positions[i].y, PlayerSize, PlayerSize, GetColor(colors[i]));
 		}
 		break;
 	}
 }
 
+// show how the connection is doing next to the FPS
+void DrawNetStats()
+{
+	if (!ShowNetStats)
+		return;
+
+	NetStats stats = { 0 };
+	if (!GetNetStats(&stats))
+	{
+		DrawText("not connected", 100, 0, 10, LIME);
+		return;
+	}
+
+	DrawText(TextFormat("rtt %ums (+/- %u, p99 %u)  jitter %.1fms (p99 %u)  loss %.1f%%", stats.RoundTripTime, stats.RoundTripVariance, stats.RoundTripP99,
+		stats.JitterMean, stats.JitterP99, stats.PacketLoss), 100, 0, 10, LIME);
+	DrawText(TextFormat("in %.1f KB/s  out %.1f KB/s  pending %u bytes  backlog %u", stats.BytesInPerSecond / 1024.0f, stats.BytesOutPerSecond / 1024.0f,
+		stats.PendingReliableBytes, stats.EventBacklog), 100, 10, 10, LIME);
+	DrawText(TextFormat("extrapolation error %.1fpx (max %.1f)", stats.ExtrapolationErrorMean, stats.ExtrapolationErrorMax), 100, 20, 10, LIME);
+
+	// how long other players' moves take to get to our screen, and where that time goes
+	InputLatency latency = { 0 };
+	if (GetInputLatency(&latency, false))
+	{
+		DrawText(TextFormat("input latency %.1fms (p99 %.1f): client %.1f  up %.1f  server %.1f  down %.1f  frame %.1f", latency.Total.Mean, latency.Total.P99,
+			latency.ClientHold.Mean, latency.Uplink.Mean, latency.ServerHold.Mean, latency.Downlink.Mean, latency.ClientFrame.Mean), 100, 30, 10, LIME);
+	}
+}
+
 // main game client
 int main()
 {
@@ -194,8 +234,28 @@ int main()
 		DrawGame();
 
 		DrawFPS(0, 0);
+		DrawNetStats();
 		EndDrawing();
 	}
+
+	// if allocation tracking was on, report how much the network code allocated
+	AllocTickTracker allocations = { 0 };
+	if (GetAllocStats(&allocations) && allocations.Ticks > 0)
+	{
+		TraceLog(LOG_INFO, "NET: %.2f allocations per update, max %llu in one update, %llu of %llu updates allocation free",
+			(double)allocations.Allocations / allocations.Ticks, (unsigned long long)allocations.PeakAllocations,
+			(unsigned long long)allocations.QuietTicks, (unsigned long long)allocations.Ticks);
+	}
+
+	// and how long other players' moves took to show up, by stage
+	InputLatency latency = { 0 };
+	if (GetInputLatency(&latency, false))
+	{
+		TraceLog(LOG_INFO, "NET: input latency %.1fms p99 %.1fms over %u samples, mean (p99) client %.1f (%.1f), up %.1f (%.1f), server %.1f (%.1f), down %.1f (%.1f), frame %.1f (%.1f)",
+			latency.Total.Mean, latency.Total.P99, latency.Samples, latency.ClientHold.Mean, latency.ClientHold.P99, latency.Uplink.Mean, latency.Uplink.P99,
+			latency.ServerHold.Mean, latency.ServerHold.P99, latency.Downlink.Mean, latency.Downlink.P99, latency.ClientFrame.Mean, latency.ClientFrame.P99);
+	}
+
 	CloseWindow();
 
 	return 0;
@@ -31,32 +31,20 @@
 
 #include "net_client.h"
 
+// the bench builds this file in next to its own copy of the enet implementation
+#ifndef NET_CLIENT_EXTERNAL_ENET
 #define ENET_IMPLEMENTATION
+#endif
 #include "net_common.h"
+#include "net_rate.h"
+#include "net_alloc.h"
+#include "net_batch.h"
+#include "net_resolve.h"
+#include "net_world.h"
 
-// the player id of this client
-int LocalPlayerId = -1;
-
-// the enet address we are connected to
-ENetAddress address = { 0 };
-
-// the server object we are connecting to
-ENetPeer* server = { 0 };
-
-// the client peer we are using
-ENetHost* client = { 0 };
-
-// time data for the network tick so that we don't spam the server with one update every drawing frame
-
-// how long in seconds since the last time we sent an update
-double LastInputSend = -100;
-
-// how long to wait between updates (20 update ticks a second)
-double InputUpdateInterval = 1.0f / 20.0f;
-
-double LastNow = 0;
-
-bool WantDisconnect = false;
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Data about players
 typedef struct
@@ -73,34 +61,309 @@ typedef struct
 	// the time we got the last update
 	double UpdateTime;
 
-	//where we think this item is right now based on the movement vector
-	Vector2 ExtrapolatedPosition;
+	// about how long it is between updates for this player, the server sends players far away from us less often
+	double UpdateInterval;
+
+	// how far off our guess was when the last update came in, this is faded out over the next interval so the player doesn't jump
+	Vector2 Correction;
 }RemotePlayer;
 
-// The list of all possible players
-// this is the local simulation that represents the current game state
-// it includes the current local player and the last known data from all remote players
-// the client checks this every frame to see where everyone is on the field
-RemotePlayer Players[MAX_PLAYERS] = { 0 };
+// another player's input that is being timed, from the time the server told us about it until we show it
+typedef struct
+{
+	bool Active;
 
-// Connect to a server
-void Connect(const char* serverAddress)
+	// when the update with the input in it came off the socket
+	double ReceiveTime;
+
+	// how long the input took to get this far at each stage, in input trace units
+	uint16_t ClientHold;
+	uint16_t Uplink;
+	uint16_t ServerHold;
+	uint16_t Downlink;
+}PendingInputTrace;
+
+// the stages of another player's input getting on to our screen, see InputLatency
+typedef enum
 {
-	if (WantDisconnect)
-		return;
+	LatencyClientHold = 0,
+	LatencyUplink,
+	LatencyServerHold,
+	LatencyDownlink,
+	LatencyClientFrame,
+	LatencyTotal,
+	LatencyStageCount
+}InputLatencyStage;
+
+// how often in seconds we tag one of our inputs to time how long it takes to show up for everyone else
+#define InputTracePeriod 0.25
+
+// the update interval we assume for a player until we have seen a few updates, about what the server sends close players at
+#define DefaultUpdateInterval (1.0 / 30.0)
+
+// gaps between updates longer than this are the player standing still (the server only sends news), not the server sending less often
+#define MaxUpdateInterval 1.0
+
+// we never fade a correction out over longer than this, so a very late update still settles quickly
+#define MaxCorrectionTime 0.25
+
+// we stop extrapolating after this many update intervals, if an update is that late guessing further only makes it worse
+#define MaxExtrapolationIntervals 2.0
+
+// how often in seconds the network stats that are measured over time (bandwidth, percentiles, extrapolation error) are worked out
+#define NetStatsPeriod 1.0
+
+// how long we remember the address a server name resolved to, so reconnecting after a drop doesn't have to look it up again
+#define AddressCacheTime 60.0
+
+// Everything one connection to the server needs
+// nothing in here is shared, so a program can have as many of these as it wants
+struct NetClient
+{
+	// the player id of this client
+	int LocalPlayerId;
+
+	// the enet address we are connected to
+	ENetAddress Address;
+
+	// the server object we are connecting to
+	ENetPeer* Server;
+
+	// the client peer we are using
+	ENetHost* Host;
+
+	// when true the host and its socket stay open between connections, and only the peer is reset
+	// this saves making a new host and socket every time we connect again after a drop
+	bool KeepHost;
+
+	// the name we were asked to connect to, and the lookup that turns it into an address
+	// while Resolving is true we have a host but no server peer yet
+	char ServerName[ResolveNameLength];
+	AddressResolver Resolver;
+	bool Resolving;
+
+	// time data for the network tick so that we don't spam the server with one update every drawing frame
+
+	// how often we send input to the server, this starts at 30 updates a second and backs off when the connection is struggling
+	RateControl InputRate;
+
+	// the limits for how fast we send input (5 to 30 update ticks a second)
+	RateControlConfig InputRateConfig;
+
+	double LastNow;
+
+	bool WantDisconnect;
+
+	// messages waiting to be sent to the server, sent as one packet each update
+	MessageBatch Outgoing;
+
+	// how much each update allocates, when allocation tracking is on
+	AllocTickTracker Allocations;
+
+	// the time of our first update after connecting, and how long it took from then until we had the whole world
+	// the join time is negative until the last part of the join snapshot comes in
+	double ConnectTime;
+	double JoinTime;
+
+	// the token the server gave us to get our slot back if our connection drops, 0 if we don't have one
+	uint32_t SessionToken;
+
+	// how many messages we have got from the server on this connection, and how many we got on the one before
+	// when we come back after a drop, the server uses this to work out what we missed
+	uint32_t MessagesReceived;
+	uint32_t LastMessagesReceived;
 
-	// startup the network library
-	enet_initialize();
+	// the network stats from the last full period, and what we need to work out the next one
+	// StatsStart is negative until the first update after we connect
+	NetStats Stats;
+	double StatsStart;
+	uint32_t StatsSentBytes;
+	uint32_t StatsReceivedBytes;
+
+	// how far off our guesses at where remote players were, when their updates came in this period
+	double ErrorSum;
+	float ErrorMax;
+	uint32_t ErrorCount;
+
+	// the input we are timing, if there is one, it goes out with the next input we send and is 0 once it has
+	// TraceStart is when the input was given to us, and LastTraceTime is when we last tagged one, in update time
+	uint16_t NextTraceId;
+	uint16_t PendingTraceId;
+	double TraceStart;
+	double LastTraceTime;
+
+	// the last time enet read from the socket, everything it has waiting for us came in then
+	double SocketReadTime;
+
+	// other players' timed inputs we have been told about, waiting for someone to read where that player is
+	PendingInputTrace Traces[MAX_PLAYERS];
+	int TracesPending;
+
+	// how long other players' input took to show up here at each stage, in input trace units
+	NetHistogram Latency[LatencyStageCount];
+
+	// The list of all possible players
+	// this is the local simulation that represents the current game state
+	// it includes the current local player and the last known data from all remote players
+	RemotePlayer Players[MAX_PLAYERS];
+
+	// where everyone we can see is drawn, packed together so the renderer can get them all in one call
+	// remote players are extrapolated straight into this at the end of every update
+	EntityView View;
+};
+
+// the client used by the simple functions that don't take a client, created the first time it is needed
+static NetClient* DefaultClient = NULL;
+
+static NetClient* GetDefaultClient()
+{
+	if (DefaultClient == NULL)
+		DefaultClient = CreateNetClient();
+
+	return DefaultClient;
+}
+
+// make a new client that is not connected to anything
+NetClient* CreateNetClient()
+{
+	NetClient* client = (NetClient*)calloc(1, sizeof(NetClient));
+	if (client == NULL)
+		return NULL;
+
+	if (!InitEntityView(&client->View, MAX_PLAYERS))
+	{
+		free(client);
+		return NULL;
+	}
+
+	client->LocalPlayerId = -1;
+	client->KeepHost = true;
+	InitAddressResolver(&client->Resolver, AddressCacheTime);
+	return client;
+}
+
+// make the host we connect with, unless we kept the one from our last connection
+static bool OpenHost(NetClient* client)
+{
+	if (client->Host != NULL)
+		return true;
+
+	// startup the network library, counting every allocation if NET_CLIENT_TRACK_ALLOCS is set
+	InitializeNetwork(getenv("NET_CLIENT_TRACK_ALLOCS") != NULL);
 
 	// create a client that we will use to connect to the server
-	client = enet_host_create(NULL, 1, 1, 0, 0);
+	client->Host = enet_host_create(NULL, 1, 1, 0, 0);
+	if (client->Host != NULL)
+		return true;
+
+	enet_deinitialize();
+	return false;
+}
+
+// shut down the host and enet
+static void CloseHost(NetClient* client)
+{
+	if (client->Host == NULL)
+		return;
+
+	enet_host_destroy(client->Host);
+	client->Host = NULL;
+	enet_deinitialize();
+}
+
+// we are done with a connection, the host only goes away if we are not keeping it for the next one
+static void ReleaseHost(NetClient* client)
+{
+	if (!client->KeepHost)
+		CloseHost(client);
+}
+
+// close the connection right away if there is one and free the client
+void DestroyNetClient(NetClient* client)
+{
+	if (client == NULL)
+		return;
 
-	// set the address and port we will connect to
-	enet_address_set_host(&address, serverAddress);
-	address.port = 4545;
+	// a lookup that is still running cleans up after itself
+	CancelResolve(&client->Resolver);
 
-	// start the connection process. Will be finished as part of our update
-	server = enet_host_connect(client, &address, 1, 0);
+	if (client->Server != NULL)
+		enet_peer_disconnect_now(client->Server, 0);
+
+	CloseHost(client);
+	FreeEntityView(&client->View);
+
+	if (client == DefaultClient)
+		DefaultClient = NULL;
+
+	free(client);
+}
+
+// start the connection process once we know the address. Will be finished as part of our update
+static void StartServerConnection(NetClient* client)
+{
+	client->Address.port = 4545;
+	client->Server = enet_host_connect(client->Host, &client->Address, 1, client->SessionToken);
+}
+
+// give up on a connection we could not start because the address did not resolve, and close the host we made for it
+// we stay not connected, the same as if the server had never answered
+static void StopConnecting(NetClient* client)
+{
+	ReleaseHost(client);
+}
+
+// Connect to a server
+void ClientConnect(NetClient* client, const char* serverAddress)
+{
+	if (client->WantDisconnect || client->Resolving)
+		return;
+
+	if (!OpenHost(client))
+		return;
+
+	// we only send one thing, so the detail settings don't matter to us
+	client->InputRateConfig = DefaultRateControlConfig();
+	client->InputRateConfig.MinInterval = 1.0 / 30.0;
+	client->InputRateConfig.MaxInterval = 1.0 / 5.0;
+	InitRateControl(&client->InputRate, &client->InputRateConfig);
+
+	// if we were playing before our connection dropped, the session token goes in the connect data, so the server can give us our slot back
+	// we keep our copy of the world until the server tells us if it did
+	client->LastMessagesReceived = client->MessagesReceived;
+	client->MessagesReceived = 0;
+
+	ResetMessageBatch(&client->Outgoing);
+
+	// we don't know what time it is until the next update
+	client->ConnectTime = -1;
+	client->JoinTime = -1;
+
+	// the stats start over for every connection
+	memset(&client->Stats, 0, sizeof(NetStats));
+	client->StatsStart = -1;
+	client->ErrorSum = 0;
+	client->ErrorMax = 0;
+	client->ErrorCount = 0;
+
+	client->PendingTraceId = 0;
+	client->LastTraceTime = -InputTracePeriod;
+	memset(client->Traces, 0, sizeof(client->Traces));
+	client->TracesPending = 0;
+	memset(client->Latency, 0, sizeof(client->Latency));
+
+	// look up the address we will connect to, numbers and names we have seen recently are ready right away
+	// anything else is looked up on another thread so a slow DNS server doesn't freeze the game, and we finish connecting in a later update
+	memset(&client->Address, 0, sizeof(ENetAddress));
+	snprintf(client->ServerName, sizeof(client->ServerName), "%s", serverAddress);
+
+	ResolveStatus status = StartResolve(&client->Resolver, serverAddress, &client->Address);
+	if (status == ResolveDone)
+		StartServerConnection(client);
+	else if (status == ResolvePending)
+		client->Resolving = true;
+	else
+		StopConnecting(client);
 }
 
 // Utility functions to read data out of a packet
@@ -125,93 +388,360 @@ Vector2 ReadPosition(ENetPacket* packet, size_t* offset)
 // functions to handle the commands that the server will send to the client
 // these take the data from enet and read out various bits of data from it to do actions based on the command that was sent
 
+// put a remote player into our local simulation, reading their position and direction from the packet
+void AddRemotePlayer(NetClient* client, int remotePlayer, ENetPacket* packet, size_t* offset)
+{
+	// set them as active and update the location
+	client->Players[remotePlayer].Active = true;
+	client->Players[remotePlayer].Position = ReadPosition(packet, offset);
+	client->Players[remotePlayer].Direction = ReadPosition(packet, offset);
+	client->Players[remotePlayer].UpdateTime = client->LastNow;
+	client->Players[remotePlayer].UpdateInterval = DefaultUpdateInterval;
+	client->Players[remotePlayer].Correction = (Vector2){ 0, 0 };
+	SetEntityPosition(&client->View, remotePlayer, client->Players[remotePlayer].Position);
+
+	// In a more robust game, this message would have more info about the new player, such as what sprite or model to use, player name, or other data a client would need
+	// this is where static data about the player would be sent, and any initial state needed to setup the local simulation
+}
+
 // A new remote player was added to our local simulation
-void HandleAddPlayer(ENetPacket* packet, size_t* offset)
+void HandleAddPlayer(NetClient* client, ENetPacket* packet, size_t* offset)
 {
 	// find out who the server is talking about
 	int remotePlayer = ReadByte(packet, offset);
-	if (remotePlayer >= MAX_PLAYERS || remotePlayer == LocalPlayerId)
+	if (remotePlayer >= MAX_PLAYERS || remotePlayer == client->LocalPlayerId)
 		return;
 
-	// set them as active and update the location
-	Players[remotePlayer].Active = true;
-	Players[remotePlayer].Position = ReadPosition(packet, offset);
-	Players[remotePlayer].Direction = ReadPosition(packet, offset);
-	Players[remotePlayer].UpdateTime = LastNow;
+	AddRemotePlayer(client, remotePlayer, packet, offset);
+}
 
-	// In a more robust game, this message would have more info about the new player, such as what sprite or model to use, player name, or other data a client would need
-	// this is where static data about the player would be sent, and any initial state needed to setup the local simulation
+// Part of the list of everyone who was already in the game when we joined, length is the size of the whole message
+void HandleJoinSnapshot(NetClient* client, ENetPacket* packet, size_t* offset, size_t length)
+{
+	uint8_t flags = ReadByte(packet, offset);
+	uint16_t count = (uint16_t)ReadShort(packet, offset);
+
+	// don't trust the count, it has to fit in the message, not just the packet, or we would read the messages batched after it as players
+	if ((size_t)count * JoinSnapshotEntrySize > length - JoinSnapshotHeaderSize)
+		return;
+
+	for (uint16_t entry = 0; entry < count; entry++)
+	{
+		// ids are two bytes here so bigger worlds fit in the same message
+		uint16_t remotePlayer = (uint16_t)ReadShort(packet, offset);
+		if (remotePlayer >= MAX_PLAYERS || remotePlayer == client->LocalPlayerId)
+		{
+			*offset += JoinSnapshotEntrySize - 2;
+			continue;
+		}
+
+		AddRemotePlayer(client, remotePlayer, packet, offset);
+	}
+
+	// that was the last part, we have the whole world now
+	if ((flags & JoinSnapshotLast) != 0 && client->JoinTime < 0)
+		client->JoinTime = client->LastNow - client->ConnectTime;
 }
 
 // A remote player has left the game and needs to be removed from the local simulation
-void HandleRemovePlayer(ENetPacket* packet, size_t* offset)
+void HandleRemovePlayer(NetClient* client, ENetPacket* packet, size_t* offset)
 {
 	// find out who the server is talking about
 	int remotePlayer = ReadByte(packet, offset);
-	if (remotePlayer >= MAX_PLAYERS || remotePlayer == LocalPlayerId)
+	if (remotePlayer >= MAX_PLAYERS || remotePlayer == client->LocalPlayerId)
 		return;
 
 	// remove the player from the simulation. No other data is needed except the player id
-	Players[remotePlayer].Active = false;
+	client->Players[remotePlayer].Active = false;
+
+	// if we were timing one of their inputs, they left before we could show it
+	if (client->Traces[remotePlayer].Active)
+	{
+		client->Traces[remotePlayer].Active = false;
+		client->TracesPending--;
+	}
 }
 
 // The server has a new position for a player in our local simulation
-void HandleUpdatePlayer(ENetPacket* packet, size_t* offset)
+void HandleUpdatePlayer(NetClient* client, ENetPacket* packet, size_t* offset)
 {
 	// find out who the server is talking about
 	int remotePlayer = ReadByte(packet, offset);
-	if (remotePlayer >= MAX_PLAYERS || remotePlayer == LocalPlayerId || !Players[remotePlayer].Active)
+	if (remotePlayer >= MAX_PLAYERS || remotePlayer == client->LocalPlayerId || !client->Players[remotePlayer].Active)
 		return;
 
+	RemotePlayer* player = &client->Players[remotePlayer];
+
+	// updates come at different rates depending on how far away the player is, so keep a running average of the gap
+	double interval = client->LastNow - player->UpdateTime;
+	if (interval > 0 && interval < MaxUpdateInterval)
+		player->UpdateInterval += (interval - player->UpdateInterval) * 0.25;
+
 	// update the last known position and movement
-	Players[remotePlayer].Position = ReadPosition(packet, offset);
-	Players[remotePlayer].Direction = ReadPosition(packet, offset);
-	Players[remotePlayer].UpdateTime = LastNow;
+	player->Position = ReadPosition(packet, offset);
+	player->Direction = ReadPosition(packet, offset);
+	player->UpdateTime = client->LastNow;
+
+	// where we were showing them is probably a little off from where the server says they are
+	// instead of snapping, keep the difference and fade it out, so they slide over to the right place
+	Vector2 shown = player->Position;
+	GetEntityPosition(&client->View, remotePlayer, &shown);
+	player->Correction = Vector2Subtract(shown, player->Position);
+
+	// that is how good our extrapolation is, keep track of it for the stats
+	float error = Vector2Length(player->Correction);
+	client->ErrorSum += error;
+	client->ErrorCount++;
+	if (error > client->ErrorMax)
+		client->ErrorMax = error;
 
 	// in a more robust game this message would have a tick ID for what time this information was valid, and extra info about
 	// what the input state was so the local simulation could do prediction and smooth out the motion
 }
 
+// The server says how long another player's timed input took to get to it and through it, it is in the update we just handled
+// we add how long it took to get down to us, and finish timing it when that player is next read for drawing, counting from when the packet came off the socket
+void HandleInputTrace(NetClient* client, ENetPacket* packet, size_t* offset)
+{
+	int remotePlayer = ReadByte(packet, offset);
+	if (remotePlayer >= MAX_PLAYERS || remotePlayer == client->LocalPlayerId || !client->Players[remotePlayer].Active)
+		return;
+
+	// the trace id is only for the server, so it doesn't tell us the same one twice
+	ReadShort(packet, offset);
+
+	PendingInputTrace* trace = &client->Traces[remotePlayer];
+	if (!trace->Active)
+		client->TracesPending++;
+
+	trace->Active = true;
+	trace->ReceiveTime = client->SocketReadTime;
+	trace->ClientHold = (uint16_t)ReadShort(packet, offset);
+	trace->Uplink = (uint16_t)ReadShort(packet, offset);
+	trace->ServerHold = (uint16_t)ReadShort(packet, offset);
+	trace->Downlink = PackTraceTime(client->Server->roundTripTime / 2000.0);
+}
+
+// the player with a timed input has been read for drawing, so we can see it now, count how long each stage took
+static void FinishInputTrace(NetClient* client, int id, double now)
+{
+	PendingInputTrace* trace = &client->Traces[id];
+	trace->Active = false;
+	client->TracesPending--;
+
+	uint32_t stages[LatencyStageCount] = { 0 };
+	stages[LatencyClientHold] = trace->ClientHold;
+	stages[LatencyUplink] = trace->Uplink;
+	stages[LatencyServerHold] = trace->ServerHold;
+	stages[LatencyDownlink] = trace->Downlink;
+	stages[LatencyClientFrame] = PackTraceTime(now - trace->ReceiveTime);
+
+	for (int i = 0; i < LatencyTotal; i++)
+	{
+		stages[LatencyTotal] += stages[i];
+		RecordHistogram(&client->Latency[i], stages[i]);
+	}
+	RecordHistogram(&client->Latency[LatencyTotal], stages[LatencyTotal]);
+}
+
+// handle one message from the server, offset is where the message starts in the packet and length is how big it is
+// a message that is too short for its command is ignored, so we never read past it into the next one or off the end of the packet
+void HandleServerMessage(NetClient* client, ENetPacket* packet, size_t offset, size_t length)
+{
+	// read off the command that the server wants us to do
+	NetworkCommands command = (NetworkCommands)ReadByte(packet, &offset);
+
+	// if the server has not accepted us yet, we are limited in what packets we can receive
+	if (client->LocalPlayerId == -1)
+	{
+		if (command == AcceptPlayer && length >= AcceptPlayerSize)    // this is the only thing we can do in this state, so ignore anything else
+		{
+			// See who the server says we are
+			client->LocalPlayerId = ReadByte(packet, &offset);
+
+			// Make sure that it makes sense
+			if (client->LocalPlayerId < 0 || client->LocalPlayerId >= MAX_PLAYERS)
+			{
+				client->LocalPlayerId = -1;
+				return;
+			}
+
+			// if we got our old slot back we keep the world we have, and the server sends us what we missed
+			uint8_t flags = ReadByte(packet, &offset);
+			client->SessionToken = (uint32_t)ReadInt(packet, &offset);
+
+			// Force the next frame to do an update by pretending it's been a very long time since our last update
+			client->InputRate.LastSend = -100;
+
+			// a fresh start, anyone we had from before is stale, the join snapshot will tell us who is here now
+			if ((flags & AcceptResumed) == 0)
+			{
+				for (int i = 0; i < MAX_PLAYERS; i++)
+					client->Players[i].Active = false;
+			}
+
+			// We are active
+			client->Players[client->LocalPlayerId].Active = true;
+
+			// when we got our slot back we are still where we were
+			if ((flags & AcceptResumed) != 0)
+				return;
+
+			// Set our player at some location on the field.
+			// optimally we would do a much more robust connection negotiation where we tell the server what our name is, what we look like
+			// and then the server tells us where we are
+			// But for this simple test, everyone starts at the same place on the field
+			client->Players[client->LocalPlayerId].Position = (Vector2){ 100, 100 };
+		}
+	}
+	else // we have been accepted, so process play messages from the server
+	{
+		// see what the server wants us to do
+		switch (command)
+		{
+			case AddPlayer:
+				if (length >= PlayerUpdateSize)
+					HandleAddPlayer(client, packet, &offset);
+				break;
+
+			case JoinSnapshot:
+				if (length >= JoinSnapshotHeaderSize)
+					HandleJoinSnapshot(client, packet, &offset, length);
+				break;
+
+			case RemovePlayer:
+				if (length >= RemovePlayerSize)
+					HandleRemovePlayer(client, packet, &offset);
+				break;
+
+			case UpdatePlayer:
+				if (length >= PlayerUpdateSize)
+					HandleUpdatePlayer(client, packet, &offset);
+				break;
+
+			case InputTrace:
+				if (length >= InputTraceSize)
+					HandleInputTrace(client, packet, &offset);
+				break;
+		}
+	}
+}
+
+// once a period, work out the stats that are measured over time, and start measuring again
+static void UpdateNetStats(NetClient* client, double now)
+{
+	if (client->StatsStart < 0 || client->Host == NULL)
+	{
+		client->StatsStart = now;
+		client->StatsSentBytes = client->Host != NULL ? client->Host->totalSentData : 0;
+		client->StatsReceivedBytes = client->Host != NULL ? client->Host->totalReceivedData : 0;
+		return;
+	}
+
+	double elapsed = now - client->StatsStart;
+	if (elapsed < NetStatsPeriod)
+		return;
+
+	NetStats* stats = &client->Stats;
+
+	// enet's totals are 32 bits and wrap, unsigned subtraction still gets the right difference
+	uint32_t sent = client->Host->totalSentData - client->StatsSentBytes;
+	uint32_t received = client->Host->totalReceivedData - client->StatsReceivedBytes;
+	stats->BytesOutPerSecond = (float)(sent / elapsed);
+	stats->BytesInPerSecond = (float)(received / elapsed);
+
+	// the histograms start over every period, so the percentiles are about now, not the whole connection
+	PeerStats peerStats = { 0 };
+	if (client->Server != NULL)
+		SnapshotPeerStats(client->Server, &peerStats, true);
+	stats->RoundTripP99 = GetHistogramPercentile(&peerStats.RoundTrip, 99);
+	stats->JitterMean = (float)GetHistogramMean(&peerStats.Jitter);
+	stats->JitterP99 = GetHistogramPercentile(&peerStats.Jitter, 99);
+
+	stats->ExtrapolationErrorMean = client->ErrorCount > 0 ? (float)(client->ErrorSum / client->ErrorCount) : 0;
+	stats->ExtrapolationErrorMax = client->ErrorMax;
+	client->ErrorSum = 0;
+	client->ErrorMax = 0;
+	client->ErrorCount = 0;
+
+	client->StatsStart = now;
+	client->StatsSentBytes = client->Host->totalSentData;
+	client->StatsReceivedBytes = client->Host->totalReceivedData;
+}
+
 // process one frame of updates
-void Update(double now, float deltaT)
+void ClientUpdate(NetClient* client, double now, float deltaT)
 {
-	LastNow = now;
+	client->LastNow = now;
+
+	// see if the server address has come back yet, this never waits for it
+	if (client->Resolving)
+	{
+		ResolveStatus status = PollResolve(&client->Resolver, &client->Address);
+		if (status != ResolvePending)
+		{
+			client->Resolving = false;
+			if (status == ResolveDone)
+				StartServerConnection(client);
+			else
+				StopConnecting(client);
+		}
+	}
+
 	// if we are not connected to anything yet, we can't do anything, so bail out early
-	if (server == NULL)
+	if (client->Server == NULL)
 		return;
 
+	if (client->ConnectTime < 0)
+		client->ConnectTime = now;
+
+	BeginAllocTick(&client->Allocations);
+
 	// Check if we have been accepted, and if so, check the clock to see if it is time for us to send the updated position for the local player
 	// we do this so that we don't spam the server with updates 60 times a second and waste bandwidth
 	// in a real game we'd send our normalized movement vector or input keys along with what the current tick index was
 	// this way the server can know how long it's been since the last update and can do interpolation to know were we are between updates.
-	if (!WantDisconnect && LocalPlayerId >= 0 && now - LastInputSend > InputUpdateInterval)
+	// the rate we send at is adjusted based on how well our connection to the server is doing
+	UpdateRateControl(&client->InputRate, &client->InputRateConfig, now, client->Server);
+
+	if (!client->WantDisconnect && client->LocalPlayerId >= 0 && RateControlShouldSend(&client->InputRate, now))
 	{
 		// Pack up a buffer with the data we want to send
-		uint8_t buffer[9] = { 0 }; // 9 bytes for a 1 byte command number and two bytes for each X and Y value
+		uint8_t buffer[UpdateInputTracedSize] = { 0 }; // 9 bytes for a 1 byte command number and two bytes for each X and Y value, and 4 more when the input is being timed
+		size_t length = UpdateInputSize;
 		buffer[0] = (uint8_t)UpdateInput;   // this tells the server what kind of data to expect in this packet
-		*(int16_t*)(buffer + 1) = (int16_t)Players[LocalPlayerId].Position.x;
-		*(int16_t*)(buffer + 3) = (int16_t)Players[LocalPlayerId].Position.y;
-		*(int16_t*)(buffer + 5) = (int16_t)Players[LocalPlayerId].Direction.x;
-		*(int16_t*)(buffer + 7) = (int16_t)Players[LocalPlayerId].Direction.y;
-
-		// copy this data into a packet provided by enet (TODO : add pack functions that write directly to the packet to avoid the copy)
-		ENetPacket* packet = enet_packet_create(buffer, 9, ENET_PACKET_FLAG_RELIABLE);
+		*(int16_t*)(buffer + 1) = (int16_t)client->Players[client->LocalPlayerId].Position.x;
+		*(int16_t*)(buffer + 3) = (int16_t)client->Players[client->LocalPlayerId].Position.y;
+		*(int16_t*)(buffer + 5) = (int16_t)client->Players[client->LocalPlayerId].Direction.x;
+		*(int16_t*)(buffer + 7) = (int16_t)client->Players[client->LocalPlayerId].Direction.y;
 
-		// send the packet to the server
-		enet_peer_send(server, 0, packet);
-
-		// NOTE enet_host_service will handle releasing send packets when the network system has finally sent them,
-		// you don't have to destroy them
+		// if we are timing an input, tag it with the trace id and how long we held on to it
+		if (client->PendingTraceId != 0)
+		{
+			*(uint16_t*)(buffer + 9) = client->PendingTraceId;
+			*(uint16_t*)(buffer + 11) = PackTraceTime(GetPreciseTime() - client->TraceStart);
+			length = UpdateInputTracedSize;
+			client->PendingTraceId = 0;
+		}
 
-		// mark that now was the last time we sent an update
-		LastInputSend = now;
+		// add it to the batch for the server
+		CountMessageSent(client->Server, buffer, length);
+		BatchMessage(&client->Outgoing, client->Server, buffer, length);
 	}
 
+	// everything we have to say this update goes to enet as one packet
+	FlushMessageBatch(&client->Outgoing, client->Server);
+
 	// read one event from enet and process it
 	ENetEvent Event = { 0 };
 
+	// enet only reads the socket when it has nothing left waiting for us, so when that is the case, anything we get from it came in now
+	// otherwise it came in at the last read, and has been waiting for us to get to it
+	if (enet_list_empty(&client->Host->dispatchQueue))
+		client->SocketReadTime = GetPreciseTime();
+
 	// Check to see if we even have any events to do. Since this is a a client, we don't set a timeout so that the client can keep going if there are no events
-	if (enet_host_service(client, &Event, 0) > 0)
+	if (enet_host_service(client->Host, &Event, 0) > 0)
 	{
 		// see what kind of event it is
 		switch (Event.type)
@@ -220,161 +750,368 @@ void Update(double now, float deltaT)
 			case ENET_EVENT_TYPE_RECEIVE:
 			{
 				// we know that all valid packets have a size >= 1, so if we get this, something is bad and we ignore it.
-				if (Event.packet->dataLength < 1 || WantDisconnect)
+				if (Event.packet->dataLength < 1 || client->WantDisconnect)
 				{
 					enet_packet_destroy(Event.packet);
 					break;
 				}
 
-				// keep an offset of what data we have read so far
-				size_t offset = 0;
-
-				// read off the command that the server wants us to do
-				NetworkCommands command = (NetworkCommands)ReadByte(Event.packet, &offset);
+				// a packet can have several messages in it, handle them all in order
+				MessageReader reader = { 0 };
+				BeginReadMessages(&reader, Event.packet);
 
-				// if the server has not accepted us yet, we are limited in what packets we can receive
-				if (LocalPlayerId == -1)
-				{
-					if (command == AcceptPlayer)    // this is the only thing we can do in this state, so ignore anything else
-					{
-						// See who the server says we are
-						LocalPlayerId = ReadByte(Event.packet, &offset);
-
-						// Make sure that it makes sense
-						if (LocalPlayerId < 0 || LocalPlayerId > MAX_PLAYERS)
-						{
-							LocalPlayerId = -1;
-							break;
-						}
-
-						// Force the next frame to do an update by pretending it's been a very long time since our last update
-						LastInputSend = -InputUpdateInterval;
-
-						// We are active
-						Players[LocalPlayerId].Active = true;
-
-						// Set our player at some location on the field.
-						// optimally we would do a much more robust connection negotiation where we tell the server what our name is, what we look like
-						// and then the server tells us where we are
-						// But for this simple test, everyone starts at the same place on the field
-						Players[LocalPlayerId].Position = (Vector2){ 100, 100 };
-					}
-				}
-				else // we have been accepted, so process play messages from the server
+				size_t offset = 0;
+				size_t length = 0;
+				while ((length = ReadNextMessage(&reader, &offset)) > 0)
 				{
-					// see what the server wants us to do
-					switch (command)
-					{
-						case AddPlayer:
-							HandleAddPlayer(Event.packet, &offset);
-							break;
-
-						case RemovePlayer:
-							HandleRemovePlayer(Event.packet, &offset);
-							break;
-
-						case UpdatePlayer:
-							HandleUpdatePlayer(Event.packet, &offset);
-							break;
-					}
+					CountMessageReceived(Event.peer, Event.packet->data + offset, length);
+					client->MessagesReceived++;
+					HandleServerMessage(client, Event.packet, offset, length);
 				}
+
 				// tell enet that it can recycle the packet data
 				enet_packet_destroy(Event.packet);
 				break;
 			}
 
-			// we were disconnected, we have a sad
-			case ENET_EVENT_TYPE_DISCONNECT:
+			// we are connected, if we are coming back after a drop tell the server what we still have, so it only sends what we missed
+			// this is the first thing we send, so it gets there before the server sends us anything about the world
+			case ENET_EVENT_TYPE_CONNECT:
 			{
-				// close our client
-				if (client != NULL)
-					enet_host_destroy(client);
-
-				client = NULL;
-				server = NULL;
+				if (client->SessionToken == 0)
+					break;
 
-				// clean up enet
-				enet_deinitialize();
+				uint8_t buffer[ResumeSessionHeaderSize + ResumeKnownMaskSize] = { 0 };
+				buffer[0] = (uint8_t)ResumeSession;
+				*(uint32_t*)(buffer + 1) = client->LastMessagesReceived;
+				for (int i = 0; i < MAX_PLAYERS; i++)
+				{
+					if (client->Players[i].Active)
+						buffer[ResumeSessionHeaderSize + i / 8] |= (uint8_t)(1 << (i % 8));
+				}
 
-				server = NULL;
-				LocalPlayerId = -1;
+				CountMessageSent(client->Server, buffer, sizeof(buffer));
+				BatchMessage(&client->Outgoing, client->Server, buffer, sizeof(buffer));
+				FlushMessageBatch(&client->Outgoing, client->Server);
+			}
+			break;
 
-				WantDisconnect = false;
+			// we were disconnected, we have a sad
+			// if the connection dropped, the server holds our slot for a while, so we keep our session token to get it back when we connect again
+			case ENET_EVENT_TYPE_DISCONNECT:
+			case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+			{
+				// if the server never let us in, the address we have for it may be out of date, so look it up again next time
+				if (client->LocalPlayerId < 0)
+					ForgetResolvedAddress(&client->Resolver, client->ServerName);
+
+				// enet has already reset the peer, close our client unless we are keeping it for next time
+				// if we left on purpose we are not coming back, so it always goes
+				client->Server = NULL;
+				if (client->WantDisconnect)
+					CloseHost(client);
+				else
+					ReleaseHost(client);
+
+				// we are not in the game until we are accepted again, but everyone else stays in our copy of the world in case we get our slot back
+				if (client->LocalPlayerId >= 0)
+					client->Players[client->LocalPlayerId].Active = false;
+				client->LocalPlayerId = -1;
+
+				client->WantDisconnect = false;
 			}
 			break;
 		}
 	}
 
 	// update all the remote players with an interpolated position based on the last known good pos and how long it has been since an update
+	// and put everyone where they will be drawn
 	for (int i = 0; i < MAX_PLAYERS; i++)
 	{
-		if (i == LocalPlayerId || !Players[i].Active)
+		RemotePlayer* player = &client->Players[i];
+		if (!player->Active)
+		{
+			RemoveEntity(&client->View, i);
+			continue;
+		}
+
+		if (i == client->LocalPlayerId)
+		{
+			SetEntityPosition(&client->View, i, player->Position);
 			continue;
-		double delta = LastNow - Players[i].UpdateTime;
-		Players[i].ExtrapolatedPosition = Vector2Add(Players[i].Position, Vector2Scale(Players[i].Direction, (float)delta));
+		}
+
+		// don't run off forever when an update is late
+		double delta = client->LastNow - player->UpdateTime;
+		double maxDelta = player->UpdateInterval * MaxExtrapolationIntervals;
+		if (delta > maxDelta)
+			delta = maxDelta;
+
+		// fade the correction out over about one update interval
+		double correctionTime = player->UpdateInterval < MaxCorrectionTime ? player->UpdateInterval : MaxCorrectionTime;
+		float correction = correctionTime > 0 ? (float)(1.0 - delta / correctionTime) : 0.0f;
+		if (correction < 0)
+			correction = 0;
+
+		Vector2 extrapolated = Vector2Add(player->Position, Vector2Scale(player->Direction, (float)delta));
+		extrapolated = Vector2Add(extrapolated, Vector2Scale(player->Correction, correction));
+		SetEntityPosition(&client->View, i, extrapolated);
 	}
+
+	UpdateNetStats(client, now);
+
+	EndAllocTick(&client->Allocations);
 }
 
 // force a disconnect by shutting down enet
-void Disconnect()
+void ClientDisconnect(NetClient* client)
 {
 	// start to close our connection to the server
-	if (server != NULL)
+	// we are leaving on purpose, so the server won't hold our slot, and the token is no good any more
+	// if we were still looking up the address there is nothing to say goodbye to, so just stop
+	if (client->Resolving)
 	{
-		WantDisconnect = true;
-		enet_peer_disconnect(server, 0);
+		CancelResolve(&client->Resolver);
+		client->Resolving = false;
+		client->SessionToken = 0;
+		ReleaseHost(client);
+	}
+	else if (client->Server != NULL)
+	{
+		client->WantDisconnect = true;
+		client->SessionToken = 0;
+		enet_peer_disconnect(client->Server, 0);
 	}
 }
 
 // true if we are connected and have been accepted
-bool Connected()
+bool ClientConnected(NetClient* client)
 {
-	return server != NULL;
+	return client->Server != NULL;
 }
 
-int GetLocalPlayerId()
+int ClientGetLocalPlayerId(NetClient* client)
 {
-	return LocalPlayerId;
+	return client->LocalPlayerId;
 }
 
 // add the input to our local position and make sure we are still inside the field
-void UpdateLocalPlayer(Vector2* movementDelta, float deltaT)
+void ClientUpdateLocalPlayer(NetClient* client, Vector2* movementDelta, float deltaT)
 {
 	// if we are not accepted, we can't update
-	if (LocalPlayerId < 0)
+	if (client->LocalPlayerId < 0)
 		return;
 
 	// add the movement to our location
-	Players[LocalPlayerId].Position = Vector2Add(Players[LocalPlayerId].Position, Vector2Scale(*movementDelta, deltaT));
+	client->Players[client->LocalPlayerId].Position = Vector2Add(client->Players[client->LocalPlayerId].Position, Vector2Scale(*movementDelta, deltaT));
 
 	// make sure we are in bounds.
 	// In a real game both the client and the server would do this to help prevent cheaters
-	if (Players[LocalPlayerId].Position.x < 0)
-		Players[LocalPlayerId].Position.x = 0;
+	if (client->Players[client->LocalPlayerId].Position.x < 0)
+		client->Players[client->LocalPlayerId].Position.x = 0;
+
+	if (client->Players[client->LocalPlayerId].Position.y < 0)
+		client->Players[client->LocalPlayerId].Position.y = 0;
 
-	if (Players[LocalPlayerId].Position.y < 0)
-		Players[LocalPlayerId].Position.y = 0;
+	if (client->Players[client->LocalPlayerId].Position.x > FieldSizeWidth - PlayerSize)
+		client->Players[client->LocalPlayerId].Position.x = FieldSizeWidth - PlayerSize;
 
-	if (Players[LocalPlayerId].Position.x > FieldSizeWidth - PlayerSize)
-		Players[LocalPlayerId].Position.x = FieldSizeWidth - PlayerSize;
+	if (client->Players[client->LocalPlayerId].Position.y > FieldSizeHeight - PlayerSize)
+		client->Players[client->LocalPlayerId].Position.y = FieldSizeHeight - PlayerSize;
 
-	if (Players[LocalPlayerId].Position.y > FieldSizeHeight - PlayerSize)
-		Players[LocalPlayerId].Position.y = FieldSizeHeight - PlayerSize;
+	client->Players[client->LocalPlayerId].Direction = *movementDelta;
+	SetEntityPosition(&client->View, client->LocalPlayerId, client->Players[client->LocalPlayerId].Position);
+
+	// every so often, time how long it takes for a move to show up for everyone else, starting now
+	if (client->PendingTraceId == 0 && (movementDelta->x != 0 || movementDelta->y != 0) && client->LastNow - client->LastTraceTime >= InputTracePeriod)
+	{
+		// 0 means not timed, so skip it when the ids wrap
+		if (++client->NextTraceId == 0)
+			client->NextTraceId = 1;
 
-	Players[LocalPlayerId].Direction = *movementDelta;
+		client->PendingTraceId = client->NextTraceId;
+		client->TraceStart = GetPreciseTime();
+		client->LastTraceTime = client->LastNow;
+	}
 }
 
 // get the info for a particular player
-bool GetPlayerPos(int id, Vector2* pos)
+bool ClientGetPlayerPos(NetClient* client, int id, Vector2* pos)
 {
 	// make sure the player is valid and active
-	if (id < 0 || id >= MAX_PLAYERS || !Players[id].Active)
+	if (id < 0 || id >= MAX_PLAYERS || !client->Players[id].Active)
 		return false;
 
 	// copy the location (real or extrapolated)
-	if (id == LocalPlayerId)
-		*pos = Players[id].Position;
-	else
-		*pos = Players[id].ExtrapolatedPosition;
+	if (id == client->LocalPlayerId)
+	{
+		*pos = client->Players[id].Position;
+		return true;
+	}
+
+	if (client->Traces[id].Active)
+		FinishInputTrace(client, id, GetPreciseTime());
+
+	return GetEntityPosition(&client->View, id, pos);
+}
+
+// copy everyone we can see into the caller's arrays
+int ClientGetWorldState(NetClient* client, int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity)
+{
+	// everyone with a timed input is in the view, so they are all being read now
+	if (client->TracesPending > 0)
+	{
+		double now = GetPreciseTime();
+		for (int i = 0; i < MAX_PLAYERS; i++)
+		{
+			if (client->Traces[i].Active)
+				FinishInputTrace(client, i, now);
+		}
+	}
+
+	return CopyEntityView(&client->View, ids, positions, colors, palette, paletteSize, capacity);
+}
+
+// copy out the network stats, the ones enet keeps up to date itself are read fresh
+bool ClientGetNetStats(NetClient* client, NetStats* stats)
+{
+	if (client->Server == NULL)
+		return false;
+
+	*stats = client->Stats;
+
+	ENetPeer* peer = client->Server;
+	stats->RoundTripTime = peer->roundTripTime;
+	stats->RoundTripVariance = peer->roundTripTimeVariance;
+	stats->PacketLoss = peer->packetLoss * 100.0f / ENET_PEER_PACKET_LOSS_SCALE;
+	stats->PendingReliableBytes = (uint32_t)GetPeerOutgoingBacklog(peer);
+
+	// we only handle one event an update, so anything enet has ready for us past that is waiting on our frame rate
+	stats->EventBacklog = (uint32_t)enet_list_size(&peer->dispatchedCommands);
+	return true;
+}
+
+// turn one stage's histogram into milliseconds
+static void GetLatencyStage(const NetHistogram* histogram, LatencyStage* stage)
+{
+	double unitsPerMs = InputTraceUnitsPerSecond / 1000.0;
+	stage->Mean = (float)(GetHistogramMean(histogram) / unitsPerMs);
+	stage->P99 = (float)(GetHistogramPercentile(histogram, 99) / unitsPerMs);
+	stage->Max = (float)(histogram->Max / unitsPerMs);
+}
+
+// copy out how long other players' input has taken to show up, by stage
+bool ClientGetInputLatency(NetClient* client, InputLatency* latency, bool reset)
+{
+	if (client->Latency[LatencyTotal].Count == 0)
+		return false;
+
+	latency->Samples = client->Latency[LatencyTotal].Count;
+	GetLatencyStage(&client->Latency[LatencyClientHold], &latency->ClientHold);
+	GetLatencyStage(&client->Latency[LatencyUplink], &latency->Uplink);
+	GetLatencyStage(&client->Latency[LatencyServerHold], &latency->ServerHold);
+	GetLatencyStage(&client->Latency[LatencyDownlink], &latency->Downlink);
+	GetLatencyStage(&client->Latency[LatencyClientFrame], &latency->ClientFrame);
+	GetLatencyStage(&client->Latency[LatencyTotal], &latency->Total);
+
+	if (reset)
+		memset(client->Latency, 0, sizeof(client->Latency));
+	return true;
+}
+
+// copy out how much a client has allocated in its updates
+bool ClientGetAllocStats(NetClient* client, AllocTickTracker* stats)
+{
+	if (!TrackingAllocations())
+		return false;
+
+	*stats = client->Allocations;
+	return true;
+}
+
+// copy out how long it took from connecting until we had everyone who was already in the game
+bool ClientGetJoinTime(NetClient* client, double* seconds)
+{
+	if (client->JoinTime < 0)
+		return false;
+
+	*seconds = client->JoinTime;
 	return true;
 }
+
+// pick if the host stays open between connections
+void ClientSetKeepHost(NetClient* client, bool keep)
+{
+	client->KeepHost = keep;
+
+	// if we are not connected, there is nothing to keep it for
+	if (!keep && client->Server == NULL && !client->Resolving)
+		CloseHost(client);
+}
+
+// The simple interface, these all work on one default client
+
+void Connect(const char* serverAddress)
+{
+	ClientConnect(GetDefaultClient(), serverAddress);
+}
+
+void Update(double now, float deltaT)
+{
+	ClientUpdate(GetDefaultClient(), now, deltaT);
+}
+
+void Disconnect()
+{
+	ClientDisconnect(GetDefaultClient());
+}
+
+bool Connected()
+{
+	return ClientConnected(GetDefaultClient());
+}
+
+void UpdateLocalPlayer(Vector2* movementDelta, float deltaT)
+{
+	ClientUpdateLocalPlayer(GetDefaultClient(), movementDelta, deltaT);
+}
+
+int GetLocalPlayerId()
+{
+	return ClientGetLocalPlayerId(GetDefaultClient());
+}
+
+bool GetPlayerPos(int id, Vector2* pos)
+{
+	return ClientGetPlayerPos(GetDefaultClient(), id, pos);
+}
+
+int GetWorldState(int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity)
+{
+	return ClientGetWorldState(GetDefaultClient(), ids, positions, colors, palette, paletteSize, capacity);
+}
+
+bool GetNetStats(NetStats* stats)
+{
+	return ClientGetNetStats(GetDefaultClient(), stats);
+}
+
+bool GetInputLatency(InputLatency* latency, bool reset)
+{
+	return ClientGetInputLatency(GetDefaultClient(), latency, reset);
+}
+
+bool GetAllocStats(AllocTickTracker* stats)
+{
+	return ClientGetAllocStats(GetDefaultClient(), stats);
+}
+
+bool GetJoinTime(double* seconds)
+{
+	return ClientGetJoinTime(GetDefaultClient(), seconds);
+}
+
+void SetKeepHost(bool keep)
+{
+	ClientSetKeepHost(GetDefaultClient(), keep);
+}
@@ -35,9 +35,80 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// allocation tracking doesn't need enet, so it is safe to include here
+#include "net_alloc.h"
+
 // It is ok to include raymath, since raymath doesn't have any conflict with windows.h
 #include "raymath.h"
 
+// How the connection to the server is doing, for showing to players and testers
+// the round trip time, loss, pending data and backlog are read fresh every time, the rest are measured over the last second
+typedef struct
+{
+	// round trip time in milliseconds, enet's smoothed value and how much it varies, and the 99th percentile of the samples in the last second
+	uint32_t RoundTripTime;
+	uint32_t RoundTripVariance;
+	uint32_t RoundTripP99;
+
+	// how much the time between packets arriving changed from what the server sent, in milliseconds
+	float JitterMean;
+	uint32_t JitterP99;
+
+	// the percent of reliable packets lost, enet's smoothed value
+	float PacketLoss;
+
+	// bytes a second coming in and going out, including enet's own headers and acknowledgements
+	float BytesInPerSecond;
+	float BytesOutPerSecond;
+
+	// bytes we have sent that are not acknowledged yet, or that enet has not sent yet
+	uint32_t PendingReliableBytes;
+
+	// how far off, in pixels, our guess at where remote players were was when their updates came in, on average and at worst
+	float ExtrapolationErrorMean;
+	float ExtrapolationErrorMax;
+
+	// packets enet has ready for us that we have not handled yet, we handle one each update
+	uint32_t EventBacklog;
+}NetStats;
+
+// how long one stage of getting another player's input on to our screen takes, in milliseconds
+typedef struct
+{
+	float Mean;
+	float P99;
+	float Max;
+}LatencyStage;
+
+// how long it takes from another player moving until we can see it, split up by where the time goes
+// every so often a client tags one of its inputs, and the time it spends at each stage is added up on the way to us
+// the clocks on different machines don't agree, so each stage is timed on the machine it happens on, and the trips over the network are half the round trip time
+// enet only hears back from a peer when that peer services its host, so the trips also count time packets sit in the socket between frames
+typedef struct
+{
+	// how many tagged inputs the stages are worked out from
+	uint32_t Samples;
+
+	// on their client, from the input going in to UpdateLocalPlayer until it was sent, mostly waiting for their send rate
+	LatencyStage ClientHold;
+
+	// the trip up to the server
+	LatencyStage Uplink;
+
+	// on the server, from getting the input until the update was sent to us, mostly the tick interval, plus any wait for our rate limit, level of detail or byte budget
+	LatencyStage ServerHold;
+
+	// the trip down to us
+	LatencyStage Downlink;
+
+	// on our client, from the update coming off the socket until the player was read with GetPlayerPos or GetWorldState, this is our frame loop
+	// it includes updates waiting in enet for us to get to them, we handle one each update (see NetStats.EventBacklog)
+	LatencyStage ClientFrame;
+
+	// all of them added up
+	LatencyStage Total;
+}InputLatency;
+
 // Connect to the server (localhost by default)
 void Connect(const char* serverAddress);
 
@@ -59,3 +130,81 @@ int GetLocalPlayerId();
 // get the position info for a player from the local simulation that has the latest network data in it
 // returns false if the player id is not valid
 bool GetPlayerPos(int id, Vector2* pos);
+
+// get everyone that can be seen in one call, filling arrays the caller owns, instead of asking for each id with GetPlayerPos
+// ids, positions and colors can each be NULL if they aren't wanted, each entity's color is palette[id % paletteSize] (as 0xRRGGBBAA, see raylib's ColorToInt)
+// returns how many entities were filled in, never more than capacity
+int GetWorldState(int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity);
+
+// get how the connection to the server is doing, returns false if we are not connected
+bool GetNetStats(NetStats* stats);
+
+// get how long other players' input takes to show up for us, by stage, since we connected or the last reset
+// returns false if no tagged input has made it to us yet
+bool GetInputLatency(InputLatency* latency, bool reset);
+
+// get how much the network code allocated during updates, returns false if allocation tracking is off
+// set NET_CLIENT_TRACK_ALLOCS in the environment before connecting to turn it on
+bool GetAllocStats(AllocTickTracker* stats);
+
+// get how long it took from connecting until we had everyone who was already in the game, in seconds
+// when we got our slot back after a drop, this is how long until we had caught up on what we missed
+// returns false until the whole join snapshot has come in
+bool GetJoinTime(double* seconds);
+
+// keep the network host and its socket open between connections, so connecting again after a drop only has to reset the connection (on by default)
+void SetKeepHost(bool keep);
+
+// The functions above all work on one default connection.
+// Programs that need more than one connection, such as bots or load tests, can make their own clients and use these functions instead.
+// Each client has its own connection and its own copy of the game state, and they do not share anything.
+
+// A connection to a server and the local simulation that goes with it, the contents are private to the network code
+typedef struct NetClient NetClient;
+
+// Make a new client that is not connected to anything, returns NULL if we are out of memory
+NetClient* CreateNetClient();
+
+// Drop the connection right away if there is one, and free the client
+void DestroyNetClient(NetClient* client);
+
+// Connect a client to the server (localhost by default)
+void ClientConnect(NetClient* client, const char* serverAddress);
+
+// Process one frame of updates for a client
+void ClientUpdate(NetClient* client, double now, float deltaT);
+
+// Disconnect a client from the server
+void ClientDisconnect(NetClient* client);
+
+// True if the client is connected to the server and has a valid player id.
+bool ClientConnected(NetClient* client);
+
+// Tell a client how far we wanted to move this frame
+void ClientUpdateLocalPlayer(NetClient* client, Vector2* movementDelta, float deltaT);
+
+// get the id that the server assigned to a client
+int ClientGetLocalPlayerId(NetClient* client);
+
+// get the position info for a player from the client's local simulation
+// returns false if the player id is not valid
+bool ClientGetPlayerPos(NetClient* client, int id, Vector2* pos);
+
+// get everyone a client can see in one call, filling arrays the caller owns
+int ClientGetWorldState(NetClient* client, int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity);
+
+// get how a client's connection is doing, returns false if it is not connected
+bool ClientGetNetStats(NetClient* client, NetStats* stats);
+
+// get how long other players' input takes to show up for a client, by stage, and start counting again if reset is true
+// returns false if no tagged input has made it to the client yet
+bool ClientGetInputLatency(NetClient* client, InputLatency* latency, bool reset);
+
+// get how much the network code allocated during a client's updates, returns false if allocation tracking is off
+bool ClientGetAllocStats(NetClient* client, AllocTickTracker* stats);
+
+// get how long it took a client from connecting until it had the whole world, returns false until it does
+bool ClientGetJoinTime(NetClient* client, double* seconds);
+
+// keep a client's network host and socket open between connections (on by default), turning it off closes them whenever the client is not connected
+void ClientSetKeepHost(NetClient* client, bool keep);
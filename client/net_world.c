@@ -0,0 +1,134 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "net_world.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool InitEntityView(EntityView* view, int capacity)
+{
+	memset(view, 0, sizeof(EntityView));
+	view->Ids = (int*)malloc(capacity * sizeof(int));
+	view->Positions = (Vector2*)malloc(capacity * sizeof(Vector2));
+	view->Slots = (int*)malloc(capacity * sizeof(int));
+	if (view->Ids == NULL || view->Positions == NULL || view->Slots == NULL)
+	{
+		FreeEntityView(view);
+		return false;
+	}
+
+	view->Capacity = capacity;
+	for (int i = 0; i < capacity; i++)
+		view->Slots[i] = -1;
+
+	return true;
+}
+
+void FreeEntityView(EntityView* view)
+{
+	free(view->Ids);
+	free(view->Positions);
+	free(view->Slots);
+	memset(view, 0, sizeof(EntityView));
+}
+
+void SetEntityPosition(EntityView* view, int id, Vector2 position)
+{
+	if (id < 0 || id >= view->Capacity)
+		return;
+
+	int slot = view->Slots[id];
+	if (slot < 0)
+	{
+		slot = view->Count++;
+		view->Slots[id] = slot;
+		view->Ids[slot] = id;
+	}
+
+	view->Positions[slot] = position;
+}
+
+bool GetEntityPosition(const EntityView* view, int id, Vector2* position)
+{
+	if (id < 0 || id >= view->Capacity || view->Slots[id] < 0)
+		return false;
+
+	*position = view->Positions[view->Slots[id]];
+	return true;
+}
+
+void RemoveEntity(EntityView* view, int id)
+{
+	if (id < 0 || id >= view->Capacity || view->Slots[id] < 0)
+		return;
+
+	// move the last one into the hole
+	int slot = view->Slots[id];
+	int last = --view->Count;
+	if (slot != last)
+	{
+		view->Ids[slot] = view->Ids[last];
+		view->Positions[slot] = view->Positions[last];
+		view->Slots[view->Ids[slot]] = slot;
+	}
+
+	view->Slots[id] = -1;
+}
+
+int CopyEntityView(const EntityView* view, int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity)
+{
+	int count = view->Count < capacity ? view->Count : capacity;
+	if (count <= 0)
+		return 0;
+
+	// the arrays are already packed, so the ids and positions are straight copies
+	if (ids != NULL)
+		memcpy(ids, view->Ids, count * sizeof(int));
+
+	if (positions != NULL)
+		memcpy(positions, view->Positions, count * sizeof(Vector2));
+
+	// a divide for every entity adds up, so palettes that are a power of two in size use a mask instead
+	if (colors != NULL && palette != NULL && paletteSize > 0)
+	{
+		if ((paletteSize & (paletteSize - 1)) == 0)
+		{
+			int mask = paletteSize - 1;
+			for (int i = 0; i < count; i++)
+				colors[i] = palette[view->Ids[i] & mask];
+		}
+		else
+		{
+			for (int i = 0; i < count; i++)
+				colors[i] = palette[view->Ids[i] % paletteSize];
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,106 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// the client's view of the world, laid out for drawing
+// every entity that can be seen is kept packed at the front of plain arrays, so the whole world can be copied out in one pass
+// this header does not include enet, so it is safe to use next to raylib
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "raymath.h"
+
+// The entities that can be seen, as parallel arrays
+// the first Count entries of Ids and Positions are the visible entities, in no particular order
+typedef struct
+{
+	// how many entities there is room for, ids go from 0 to Capacity - 1
+	int Capacity;
+
+	// how many entities are visible now
+	int Count;
+
+	// the id and position of each visible entity
+	int* Ids;
+	Vector2* Positions;
+
+	// where each id is in the packed arrays, -1 if it isn't visible
+	int* Slots;
+}EntityView;
+
+/// <summary>
+/// Set up an empty view with room for a number of entities
+/// </summary>
+/// <param name="view">The view to set up</param>
+/// <param name="capacity">How many entities it can hold, ids go from 0 to capacity - 1</param>
+/// <returns>False if we are out of memory</returns>
+bool InitEntityView(EntityView* view, int capacity);
+
+/// <summary>
+/// Free the arrays in a view
+/// </summary>
+/// <param name="view">The view to free</param>
+void FreeEntityView(EntityView* view);
+
+/// <summary>
+/// Set where an entity is, adding it to the view if it isn't there
+/// </summary>
+/// <param name="view">The view to change</param>
+/// <param name="id">The entity, ids outside the view's capacity are ignored</param>
+/// <param name="position">Where it is now</param>
+void SetEntityPosition(EntityView* view, int id, Vector2 position);
+
+/// <summary>
+/// Get where an entity is
+/// </summary>
+/// <param name="view">The view to look in</param>
+/// <param name="id">The entity</param>
+/// <param name="position">Where its position goes, this is not changed if the entity isn't in the view</param>
+/// <returns>False if the entity isn't in the view</returns>
+bool GetEntityPosition(const EntityView* view, int id, Vector2* position);
+
+/// <summary>
+/// Take an entity out of the view, the last visible entity is moved into its place so the arrays stay packed
+/// </summary>
+/// <param name="view">The view to change</param>
+/// <param name="id">The entity to take out, nothing happens if it isn't there</param>
+void RemoveEntity(EntityView* view, int id);
+
+/// <summary>
+/// Copy the visible entities into arrays owned by the caller, in one pass
+/// </summary>
+/// <param name="view">The view to copy from</param>
+/// <param name="ids">Where the ids go, can be NULL</param>
+/// <param name="positions">Where the positions go, can be NULL</param>
+/// <param name="colors">Where each entity's color goes, can be NULL</param>
+/// <param name="palette">The colors to pick from, entity id modulo the palette size, as 0xRRGGBBAA (raylib's ColorToInt and GetColor)</param>
+/// <param name="paletteSize">How many colors are in the palette, if 0 the colors are not filled in</param>
+/// <param name="capacity">How many entries the caller's arrays have room for</param>
+/// <returns>How many entities were copied, at most capacity</returns>
+int CopyEntityView(const EntityView* view, int* ids, Vector2* positions, uint32_t* colors, const uint32_t* palette, int paletteSize, int capacity);
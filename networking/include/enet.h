@@ -210,6 +210,66 @@
 #define ENET_MAX(x, y) ((x) > (y) ? (x) : (y))
 #define ENET_MIN(x, y) ((x) < (y) ? (x) : (y))
 
+/* Hooks around the phases of enet_host_service. Define these before including enet.h to trace where service time goes. */
+#ifndef ENET_TRACE_BEGIN
+#define ENET_TRACE_BEGIN(name)
+#endif
+
+#ifndef ENET_TRACE_END
+#define ENET_TRACE_END(name)
+#endif
+
+/* Hooks for collecting per peer statistics. ENET_PEER_STATS_FIELDS adds members to ENetPeer for the samples to be kept in. */
+#ifndef ENET_PEER_STATS_FIELDS
+#define ENET_PEER_STATS_FIELDS
+#endif
+
+#ifndef ENET_PEER_STATS_RESET
+#define ENET_PEER_STATS_RESET(peer)
+#endif
+
+/* ENET_HOST_STATS_FIELDS adds members to ENetHost for totals across all of its peers. */
+#ifndef ENET_HOST_STATS_FIELDS
+#define ENET_HOST_STATS_FIELDS
+#endif
+
+#ifndef ENET_HOST_STATS_RESET
+#define ENET_HOST_STATS_RESET(host)
+#endif
+
+/* Called for every protocol command sent to or received from a peer, with its size including any packet data it carries (before compression). */
+#ifndef ENET_PEER_COMMAND_SENT
+#define ENET_PEER_COMMAND_SENT(peer, command, bytes)
+#endif
+
+#ifndef ENET_PEER_COMMAND_RECEIVED
+#define ENET_PEER_COMMAND_RECEIVED(peer, command, bytes)
+#endif
+
+/* Called for the header of every datagram sent to or received from a peer. */
+#ifndef ENET_PEER_HEADER_SENT
+#define ENET_PEER_HEADER_SENT(peer, bytes)
+#endif
+
+#ifndef ENET_PEER_HEADER_RECEIVED
+#define ENET_PEER_HEADER_RECEIVED(peer, bytes)
+#endif
+
+/* Called with every round trip time measured from an acknowledgement. */
+#ifndef ENET_PEER_RTT_SAMPLE
+#define ENET_PEER_RTT_SAMPLE(peer, rtt)
+#endif
+
+/* Called for every datagram from a peer that carries its sent time (the low 16 bits of the sender's clock). */
+#ifndef ENET_PEER_ARRIVAL_SAMPLE
+#define ENET_PEER_ARRIVAL_SAMPLE(peer, sentTime, receivedTime)
+#endif
+
+/* Called when a sent reliable command is acknowledged, with the number of times it had to be resent. */
+#ifndef ENET_PEER_RETRANSMIT_SAMPLE
+#define ENET_PEER_RETRANSMIT_SAMPLE(peer, retransmits)
+#endif
+
 #define ENET_IPV6           1
 static const struct in6_addr enet_v4_anyaddr   = {{{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00 }}};
 static const struct in6_addr enet_v4_noaddr    = {{{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }}};
@@ -319,7 +379,8 @@ extern "C" {
         ENET_PROTOCOL_COMMAND_BANDWIDTH_LIMIT          = 10,
         ENET_PROTOCOL_COMMAND_THROTTLE_CONFIGURE       = 11,
         ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE_FRAGMENT = 12,
-        ENET_PROTOCOL_COMMAND_COUNT                    = 13,
+        ENET_PROTOCOL_COMMAND_CONNECT_COOKIE           = 13,
+        ENET_PROTOCOL_COMMAND_COUNT                    = 14,
 
         ENET_PROTOCOL_COMMAND_MASK                     = 0x0F
     } ENetProtocolCommand;
@@ -395,6 +456,15 @@ extern "C" {
         enet_uint32               connectID;
     } ENET_PACKED ENetProtocolVerifyConnect;
 
+    /** Sent by a host with connect cookies on, instead of allocating a peer, to a connect without a valid cookie.
+     *  The client connects again with the cookie as its connect ID.
+     */
+    typedef struct _ENetProtocolConnectCookie {
+        ENetProtocolCommandHeader header;
+        enet_uint32               connectID; /**< the connect ID the client sent, so it knows the cookie is for its connect */
+        enet_uint32               cookie;
+    } ENET_PACKED ENetProtocolConnectCookie;
+
     typedef struct _ENetProtocolBandwidthLimit {
         ENetProtocolCommandHeader header;
         enet_uint32               incomingBandwidth;
@@ -449,6 +519,7 @@ extern "C" {
         ENetProtocolAcknowledge       acknowledge;
         ENetProtocolConnect           connect;
         ENetProtocolVerifyConnect     verifyConnect;
+        ENetProtocolConnectCookie     connectCookie;
         ENetProtocolDisconnect        disconnect;
         ENetProtocolPing              ping;
         ENetProtocolSendReliable      sendReliable;
@@ -580,6 +651,9 @@ extern "C" {
         enet_uint16  sendAttempts;
         ENetProtocol command;
         ENetPacket * packet;
+        enet_uint32  supersedeKey; /**< set by enet_peer_send_latest, a newer packet with the same key makes this one pointless, 0 for everything else */
+        enet_uint8   superseded;   /**< a newer packet with the same key was sent after this one went out, so if it is lost it is resent with no data */
+        enet_uint32  queueTime;    /**< the host service time when the command was queued, it is kept through resends and latest only replacement */
     } ENetOutgoingCommand;
 
     typedef struct _ENetIncomingCommand {
@@ -613,6 +687,8 @@ extern "C" {
         ENET_HOST_DEFAULT_MTU                  = 1400,
         ENET_HOST_DEFAULT_MAXIMUM_PACKET_SIZE  = 32 * 1024 * 1024,
         ENET_HOST_DEFAULT_MAXIMUM_WAITING_DATA = 32 * 1024 * 1024,
+        ENET_HOST_CONNECT_COOKIE_PERIOD        = 10000,
+        ENET_HOST_CONNECT_COOKIE_KEY_SIZE      = 16,
 
         ENET_PEER_DEFAULT_ROUND_TRIP_TIME      = 500,
         ENET_PEER_DEFAULT_PACKET_THROTTLE      = 32,
@@ -717,6 +793,11 @@ extern "C" {
         enet_uint32       unsequencedWindow[ENET_PEER_UNSEQUENCED_WINDOW_SIZE / 32];
         enet_uint32       eventData;
         size_t            totalWaitingData;
+        struct _ENetPeer *nextAddressPeer; /**< next peer in the same bucket of the host's index by address and port */
+        struct _ENetPeer **addressLink;    /**< what points at this peer in that bucket, NULL if the peer isn't in the index */
+        struct _ENetPeer *nextHostPeer;    /**< next peer in the same bucket of the host's index by IP address only */
+        struct _ENetPeer **hostLink;
+        ENET_PEER_STATS_FIELDS
     } ENetPeer;
 
     /** An ENet packet compressor for compressing UDP packets before socket sends or receives. */
@@ -792,6 +873,16 @@ extern "C" {
         size_t                duplicatePeers;     /**< optional number of allowed peers from duplicate IPs, defaults to ENET_PROTOCOL_MAXIMUM_PEER_ID */
         size_t                maximumPacketSize;  /**< the maximum allowable packet size that may be sent or received on a peer */
         size_t                maximumWaitingData; /**< the maximum aggregate amount of buffer space a peer may use waiting for packets to be delivered */
+        int                   connectCookies;       /**< when set, a connect has to carry a cookie from this host before a peer is allocated for it */
+        enet_uint64           connectCookieKey[2];
+        enet_uint32           totalConnectCookiesSent; /**< total cookies sent to connects that didn't have one, user should reset to 0 as needed to prevent overflow */
+        ENetPeer **           freePeers;         /**< stack of the disconnected peers, the next connection takes the one on top */
+        size_t                freePeerCount;
+        ENetPeer **           addressPeers;      /**< peers in use, hashed by address and port */
+        ENetPeer **           hostPeers;         /**< the same peers, hashed by IP address only, for counting duplicate peers */
+        size_t                addressBucketMask;
+        enet_uint32           addressSeed;
+        ENET_HOST_STATS_FIELDS
     } ENetHost;
 
     /**
@@ -877,6 +968,9 @@ extern "C" {
     /** Returns the monotonic time in milliseconds. Its initial value is unspecified unless otherwise set. */
     ENET_API enet_uint32 enet_time_get(void);
 
+    /** Sets the current value of enet_time_get, which keeps counting up from there. Used to replay captured traffic on its original timeline. Not thread safe. */
+    ENET_API void enet_time_set(enet_uint32);
+
     /** ENet socket functions */
     ENET_API ENetSocket enet_socket_create(ENetSocketType);
     ENET_API int        enet_socket_bind(ENetSocket, const ENetAddress *);
@@ -987,6 +1081,8 @@ extern "C" {
     ENET_API int        enet_host_send_raw(ENetHost *, const ENetAddress *, enet_uint8 *, size_t);
     ENET_API int        enet_host_send_raw_ex(ENetHost *host, const ENetAddress* address, enet_uint8* data, size_t skipBytes, size_t bytesToSend);
     ENET_API void       enet_host_set_intercept(ENetHost *, const ENetInterceptCallback);
+    ENET_API void       enet_host_connect_cookies(ENetHost *, int, const enet_uint8 *);
+    ENET_API enet_uint64 enet_siphash(const enet_uint64 key[2], const enet_uint8 *, size_t);
     ENET_API void       enet_host_flush(ENetHost *);
     ENET_API void       enet_host_broadcast(ENetHost *, enet_uint8, ENetPacket *);    
     ENET_API void       enet_host_compress(ENetHost *, const ENetCompressor *);
@@ -996,6 +1092,7 @@ extern "C" {
     extern  enet_uint64 enet_host_random_seed(void);
 
     ENET_API int                 enet_peer_send(ENetPeer *, enet_uint8, ENetPacket *);
+    ENET_API int                 enet_peer_send_latest(ENetPeer *, enet_uint8, ENetPacket *, enet_uint32);
     ENET_API ENetPacket *        enet_peer_receive(ENetPeer *, enet_uint8 * channelID);
     ENET_API void                enet_peer_ping(ENetPeer *);
     ENET_API void                enet_peer_ping_interval(ENetPeer *, enet_uint32);
@@ -1500,6 +1597,81 @@ extern "C" {
 // !
 // =======================================================================//
 
+    /** The bucket an address goes in, in one of the host's address indexes. The hash is seeded per host so nobody outside can line up addresses in one bucket. */
+    static size_t enet_host_address_bucket(ENetHost *host, const ENetAddress *address, int withPort) {
+        enet_uint32 words[4], hash = host->addressSeed;
+        int i;
+
+        memcpy(words, &address->host, sizeof(words));
+        for (i = 0; i < 4; ++i) {
+            hash = (hash ^ words[i]) * 0x9E3779B1U;
+            hash ^= hash >> 15;
+        }
+
+        if (withPort) {
+            hash = (hash ^ address->port) * 0x9E3779B1U;
+            hash ^= hash >> 15;
+        }
+
+        return hash & host->addressBucketMask;
+    }
+
+    /** Puts a peer in both address indexes under its current address. */
+    static void enet_host_link_peer(ENetHost *host, ENetPeer *peer) {
+        ENetPeer **bucket = &host->addressPeers[enet_host_address_bucket(host, &peer->address, 1)];
+
+        peer->nextAddressPeer = *bucket;
+        if (*bucket != NULL) {
+            (*bucket)->addressLink = &peer->nextAddressPeer;
+        }
+        peer->addressLink = bucket;
+        *bucket = peer;
+
+        bucket = &host->hostPeers[enet_host_address_bucket(host, &peer->address, 0)];
+        peer->nextHostPeer = *bucket;
+        if (*bucket != NULL) {
+            (*bucket)->hostLink = &peer->nextHostPeer;
+        }
+        peer->hostLink = bucket;
+        *bucket = peer;
+    }
+
+    /** Takes a peer out of both address indexes, if it is in them. */
+    static void enet_host_unlink_peer(ENetPeer *peer) {
+        if (peer->addressLink == NULL) {
+            return;
+        }
+
+        *peer->addressLink = peer->nextAddressPeer;
+        if (peer->nextAddressPeer != NULL) {
+            peer->nextAddressPeer->addressLink = peer->addressLink;
+        }
+
+        *peer->hostLink = peer->nextHostPeer;
+        if (peer->nextHostPeer != NULL) {
+            peer->nextHostPeer->hostLink = peer->hostLink;
+        }
+
+        peer->addressLink = peer->hostLink = NULL;
+        peer->nextAddressPeer = peer->nextHostPeer = NULL;
+    }
+
+    /** Takes the peer on top of the free stack and puts it in the address indexes, the caller has already checked there is one. */
+    static ENetPeer * enet_host_take_free_peer(ENetHost *host, const ENetAddress *address) {
+        ENetPeer *peer = host->freePeers[--host->freePeerCount];
+
+        peer->address = *address;
+        enet_host_link_peer(host, peer);
+
+        return peer;
+    }
+
+    /** Takes a peer that is being reset out of the address indexes and puts it back on the free stack. */
+    static void enet_host_release_peer(ENetHost *host, ENetPeer *peer) {
+        enet_host_unlink_peer(peer);
+        host->freePeers[host->freePeerCount++] = peer;
+    }
+
     static size_t commandSizes[ENET_PROTOCOL_COMMAND_COUNT] = {
         0,
         sizeof(ENetProtocolAcknowledge),
@@ -1513,7 +1685,8 @@ extern "C" {
         sizeof(ENetProtocolSendUnsequenced),
         sizeof(ENetProtocolBandwidthLimit),
         sizeof(ENetProtocolThrottleConfigure),
-        sizeof(ENetProtocolSendFragment)
+        sizeof(ENetProtocolSendFragment),
+        sizeof(ENetProtocolConnectCookie)
     };
 
     size_t enet_protocol_command_size(enet_uint8 commandNumber) {
@@ -1730,6 +1903,10 @@ extern "C" {
         commandNumber = (ENetProtocolCommand) (outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK);
         enet_list_remove(&outgoingCommand->outgoingCommandList);
 
+        if (wasSent) {
+            ENET_PEER_RETRANSMIT_SAMPLE(peer, outgoingCommand->sendAttempts - 1);
+        }
+
         if (outgoingCommand->packet != NULL) {
             if (wasSent) {
                 peer->reliableDataInTransit -= outgoingCommand->fragmentLength;
@@ -1755,12 +1932,161 @@ extern "C" {
         return commandNumber;
     } /* enet_protocol_remove_sent_reliable_command */
 
+    #define ENET_SIPHASH_ROTATE(x, b) (enet_uint64) (((x) << (b)) | ((x) >> (64 - (b))))
+    #define ENET_SIPHASH_ROUND(v0, v1, v2, v3) do {                                              \
+        v0 += v1; v1 = ENET_SIPHASH_ROTATE(v1, 13); v1 ^= v0; v0 = ENET_SIPHASH_ROTATE(v0, 32); \
+        v2 += v3; v3 = ENET_SIPHASH_ROTATE(v3, 16); v3 ^= v2;                                   \
+        v0 += v3; v3 = ENET_SIPHASH_ROTATE(v3, 21); v3 ^= v0;                                   \
+        v2 += v1; v1 = ENET_SIPHASH_ROTATE(v1, 17); v1 ^= v2; v2 = ENET_SIPHASH_ROTATE(v2, 32); \
+    } while (0)
+
+    /** SipHash-2-4, a keyed hash made for short inputs, used to sign connect cookies.
+     *  It is a MAC, so without the key nothing about one output says anything about another.
+     */
+    enet_uint64 enet_siphash(const enet_uint64 key[2], const enet_uint8 *data, size_t dataLength) {
+        enet_uint64 v0 = key[0] ^ 0x736f6d6570736575ULL;
+        enet_uint64 v1 = key[1] ^ 0x646f72616e646f6dULL;
+        enet_uint64 v2 = key[0] ^ 0x6c7967656e657261ULL;
+        enet_uint64 v3 = key[1] ^ 0x7465646279746573ULL;
+        enet_uint64 last = (enet_uint64) dataLength << 56;
+        size_t i, blocks = dataLength & ~(size_t) 7;
+
+        for (i = 0; i < blocks; i += 8) {
+            enet_uint64 m = 0;
+            int b;
+            for (b = 7; b >= 0; --b) {
+                m = (m << 8) | data[i + b];
+            }
+
+            v3 ^= m;
+            ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+            ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+
+        for (; i < dataLength; ++i) {
+            last |= (enet_uint64) data[i] << (8 * (i - blocks));
+        }
+
+        v3 ^= last;
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+        v0 ^= last;
+
+        v2 ^= 0xFF;
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+        ENET_SIPHASH_ROUND(v0, v1, v2, v3);
+
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    /** The cookie for the address a datagram came from, in a cookie period. Cookies from this period and the last one are accepted. */
+    static enet_uint32 enet_protocol_connect_cookie(ENetHost *host, enet_uint32 period) {
+        enet_uint8 data[sizeof(struct in6_addr) + sizeof(enet_uint16) + sizeof(enet_uint32)];
+
+        memcpy(data, &host->receivedAddress.host, sizeof(struct in6_addr));
+        memcpy(data + sizeof(struct in6_addr), &host->receivedAddress.port, sizeof(enet_uint16));
+        memcpy(data + sizeof(struct in6_addr) + sizeof(enet_uint16), &period, sizeof(enet_uint32));
+
+        return (enet_uint32) enet_siphash(host->connectCookieKey, data, sizeof(data));
+    }
+
+    /** Checks the cookie in a connect, and if it doesn't have a valid one, sends one back without keeping anything about the connect.
+     *  The reply is smaller than the connect, so spoofed connects can't use the host to amplify traffic.
+     *  @returns 1 if the connect has a valid cookie, 0 if not
+     */
+    static int enet_protocol_check_connect_cookie(ENetHost *host, const ENetProtocol *command) {
+        enet_uint32 period = host->serviceTime / ENET_HOST_CONNECT_COOKIE_PERIOD;
+        enet_uint8 headerData[sizeof(ENetProtocolHeader) + sizeof(enet_uint32)];
+        ENetProtocolHeader *header = (ENetProtocolHeader *) headerData;
+        ENetProtocolConnectCookie reply;
+        ENetBuffer buffers[2];
+        int sentLength;
+
+        if (command->connect.connectID == enet_protocol_connect_cookie(host, period) ||
+            command->connect.connectID == enet_protocol_connect_cookie(host, period - 1)) {
+            return 1;
+        }
+
+        /* the client is still connecting, so it takes anything sent to its peer without checking the session */
+        header->peerID                = command->connect.outgoingPeerID;
+        buffers[0].data               = headerData;
+        buffers[0].dataLength         = (size_t) &((ENetProtocolHeader *) 0)->sentTime;
+
+        reply.header.command                = ENET_PROTOCOL_COMMAND_CONNECT_COOKIE;
+        reply.header.channelID              = 0xFF;
+        reply.header.reliableSequenceNumber = 0;
+        reply.connectID                     = command->connect.connectID;
+        reply.cookie                        = enet_protocol_connect_cookie(host, period);
+        buffers[1].data                     = &reply;
+        buffers[1].dataLength               = sizeof(reply);
+
+        if (host->checksum != NULL) {
+            enet_uint32 *checksum = (enet_uint32 *) &headerData[buffers[0].dataLength];
+            *checksum = command->connect.connectID;
+            buffers[0].dataLength += sizeof(enet_uint32);
+            *checksum = host->checksum(buffers, 2);
+        }
+
+        sentLength = enet_socket_send(host->socket, &host->receivedAddress, buffers, 2);
+        if (sentLength > 0) {
+            host->totalSentData += sentLength;
+            host->totalSentPackets++;
+            host->totalConnectCookiesSent++;
+        }
+
+        return 0;
+    }
+
+    /** A host with connect cookies on sent us a cookie, connect again with it as the connect ID. */
+    static int enet_protocol_handle_connect_cookie(ENetHost *host, ENetPeer *peer, const ENetProtocol *command) {
+        ENetListIterator currentCommand;
+        ENET_UNUSED(host)
+
+        if (peer->state != ENET_PEER_STATE_CONNECTING || command->connectCookie.connectID != peer->connectID) {
+            return 0;
+        }
+
+        peer->connectID = command->connectCookie.cookie;
+
+        /* the connect is usually waiting for an acknowledgement, send it again right away instead of waiting for it to time out */
+        for (currentCommand = enet_list_begin(&peer->sentReliableCommands);
+             currentCommand != enet_list_end(&peer->sentReliableCommands);
+             currentCommand = enet_list_next(currentCommand)
+        ) {
+            ENetOutgoingCommand *outgoingCommand = (ENetOutgoingCommand *) currentCommand;
+
+            if ((outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK) == ENET_PROTOCOL_COMMAND_CONNECT) {
+                outgoingCommand->command.connect.connectID = peer->connectID;
+                enet_list_insert(enet_list_begin(&peer->outgoingReliableCommands), enet_list_remove(&outgoingCommand->outgoingCommandList));
+                return 0;
+            }
+        }
+
+        for (currentCommand = enet_list_begin(&peer->outgoingReliableCommands);
+             currentCommand != enet_list_end(&peer->outgoingReliableCommands);
+             currentCommand = enet_list_next(currentCommand)
+        ) {
+            ENetOutgoingCommand *outgoingCommand = (ENetOutgoingCommand *) currentCommand;
+
+            if ((outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK) == ENET_PROTOCOL_COMMAND_CONNECT) {
+                outgoingCommand->command.connect.connectID = peer->connectID;
+                break;
+            }
+        }
+
+        return 0;
+    }
+
     static ENetPeer * enet_protocol_handle_connect(ENetHost *host, ENetProtocolHeader *header, ENetProtocol *command) {
         ENET_UNUSED(header)
 
         enet_uint8 incomingSessionID, outgoingSessionID;
         enet_uint32 mtu, windowSize;
         ENetChannel *channel;
+        ENetChannel *channels;
         size_t channelCount, duplicatePeers = 0;
         ENetPeer *currentPeer, *peer = NULL;
         ENetProtocol verifyCommand;
@@ -1771,35 +2097,47 @@ extern "C" {
             return NULL;
         }
 
-        for (currentPeer = host->peers; currentPeer < &host->peers[host->peerCount]; ++currentPeer) {
-            if (currentPeer->state == ENET_PEER_STATE_DISCONNECTED) {
-                if (peer == NULL) {
-                    peer = currentPeer;
-                }
-            } else if (currentPeer->state != ENET_PEER_STATE_CONNECTING && in6_equal(currentPeer->address.host, host->receivedAddress.host)) {
-                if (currentPeer->address.port == host->receivedAddress.port && currentPeer->connectID == command->connect.connectID) {
-                    return NULL;
-                }
+        if (host->connectCookies && !enet_protocol_check_connect_cookie(host, command)) {
+            return NULL;
+        }
+
+        if (host->freePeerCount == 0) {
+            return NULL;
+        }
 
-                ++duplicatePeers;
+        /* a resend of a connect we already have a peer for */
+        for (currentPeer = host->addressPeers[enet_host_address_bucket(host, &host->receivedAddress, 1)]; currentPeer != NULL; currentPeer = currentPeer->nextAddressPeer) {
+            if (currentPeer->state != ENET_PEER_STATE_CONNECTING &&
+                currentPeer->address.port == host->receivedAddress.port &&
+                currentPeer->connectID == command->connect.connectID &&
+                in6_equal(currentPeer->address.host, host->receivedAddress.host)
+            ) {
+                return NULL;
             }
         }
 
-        if (peer == NULL || duplicatePeers >= host->duplicatePeers) {
-            return NULL;
+        /* there can't be too many from one IP unless the limit is lower than the number of peers */
+        if (host->duplicatePeers < host->peerCount) {
+            for (currentPeer = host->hostPeers[enet_host_address_bucket(host, &host->receivedAddress, 0)]; currentPeer != NULL; currentPeer = currentPeer->nextHostPeer) {
+                if (currentPeer->state != ENET_PEER_STATE_CONNECTING && in6_equal(currentPeer->address.host, host->receivedAddress.host) &&
+                    ++duplicatePeers >= host->duplicatePeers) {
+                    return NULL;
+                }
+            }
         }
 
         if (channelCount > host->channelLimit) {
             channelCount = host->channelLimit;
         }
-        peer->channels = (ENetChannel *) enet_malloc(channelCount * sizeof(ENetChannel));
-        if (peer->channels == NULL) {
+        channels = (ENetChannel *) enet_malloc(channelCount * sizeof(ENetChannel));
+        if (channels == NULL) {
             return NULL;
         }
+        peer = enet_host_take_free_peer(host, &host->receivedAddress);
+        peer->channels                   = channels;
         peer->channelCount               = channelCount;
         peer->state                      = ENET_PEER_STATE_ACKNOWLEDGING_CONNECT;
         peer->connectID                  = command->connect.connectID;
-        peer->address                    = host->receivedAddress;
         peer->outgoingPeerID             = ENET_NET_TO_HOST_16(command->connect.outgoingPeerID);
         peer->incomingBandwidth          = ENET_NET_TO_HOST_32(command->connect.incomingBandwidth);
         peer->outgoingBandwidth          = ENET_NET_TO_HOST_32(command->connect.outgoingBandwidth);
@@ -2313,6 +2651,7 @@ extern "C" {
         peer->lastReceiveTime = host->serviceTime;
         peer->earliestTimeout = 0;
         roundTripTime = ENET_TIME_DIFFERENCE(host->serviceTime, receivedSentTime);
+        ENET_PEER_RTT_SAMPLE(peer, roundTripTime);
 
         enet_peer_throttle(peer, roundTripTime);
         peer->roundTripTimeVariance -= peer->roundTripTimeVariance / 4;
@@ -2492,12 +2831,14 @@ extern "C" {
                 return 0;
             }
 
+            ENET_TRACE_BEGIN("enet_decompress");
             originalSize = host->compressor.decompress(host->compressor.context,
                 host->receivedData + headerSize,
                 host->receivedDataLength - headerSize,
                 host->packetData[1] + headerSize,
                 sizeof(host->packetData[1]) - headerSize
             );
+            ENET_TRACE_END("enet_decompress");
 
             if (originalSize <= 0 || originalSize > sizeof(host->packetData[1]) - headerSize) {
                 return 0;
@@ -2528,6 +2869,12 @@ extern "C" {
             peer->address.port       = host->receivedAddress.port;
             peer->incomingDataTotal += host->receivedDataLength;
             peer->totalDataReceived += host->receivedDataLength;
+
+            ENET_PEER_HEADER_RECEIVED(peer, headerSize);
+
+            if (flags & ENET_PROTOCOL_HEADER_FLAG_SENT_TIME) {
+                ENET_PEER_ARRIVAL_SAMPLE(peer, ENET_NET_TO_HOST_16(header->sentTime), host->serviceTime);
+            }
         }
 
         currentData = host->receivedData + headerSize;
@@ -2637,10 +2984,20 @@ extern "C" {
                     }
                     break;
 
+                case ENET_PROTOCOL_COMMAND_CONNECT_COOKIE:
+                    if (enet_protocol_handle_connect_cookie(host, peer, command)) {
+                        goto commandError;
+                    }
+                    break;
+
                 default:
                     goto commandError;
             }
 
+            if (peer != NULL) {
+                ENET_PEER_COMMAND_RECEIVED(peer, commandNumber, currentData - (enet_uint8 *) command);
+            }
+
             if (peer != NULL && (command->header.command & ENET_PROTOCOL_COMMAND_FLAG_ACKNOWLEDGE) != 0) {
                 enet_uint16 sentTime;
 
@@ -2772,6 +3129,7 @@ extern "C" {
             command->header.reliableSequenceNumber = reliableSequenceNumber;
             command->acknowledge.receivedReliableSequenceNumber = reliableSequenceNumber;
             command->acknowledge.receivedSentTime = ENET_HOST_TO_NET_16(acknowledgement->sentTime);
+            ENET_PEER_COMMAND_SENT(peer, ENET_PROTOCOL_COMMAND_ACKNOWLEDGE, sizeof(ENetProtocolAcknowledge));
 
             if ((acknowledgement->command.header.command & ENET_PROTOCOL_COMMAND_MASK) == ENET_PROTOCOL_COMMAND_DISCONNECT) {
                 enet_protocol_dispatch_state(host, peer, ENET_PEER_STATE_ZOMBIE);
@@ -2851,6 +3209,8 @@ extern "C" {
             host->packetSize += buffer->dataLength;
             *command = outgoingCommand->command;
             enet_list_remove(&outgoingCommand->outgoingCommandList);
+            ENET_PEER_COMMAND_SENT(peer, outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK,
+                commandSize + (outgoingCommand->packet != NULL ? outgoingCommand->fragmentLength : 0));
 
             if (outgoingCommand->packet != NULL) {
                 ++buffer;
@@ -2881,10 +3241,29 @@ extern "C" {
         }
     } /* enet_protocol_send_unreliable_outgoing_commands */
 
+    /** Lets go of the data of a reliable command that a newer packet has made pointless, the command must not be counted as in transit.
+     *  The command keeps its reliable sequence number, the receiver is waiting for it, so it goes out with no data.
+     */
+    static void enet_peer_release_superseded_command(ENetOutgoingCommand *outgoingCommand) {
+        --outgoingCommand->packet->referenceCount;
+
+        if (outgoingCommand->packet->referenceCount == 0) {
+            callbacks.packet_destroy(outgoingCommand->packet);
+        }
+
+        outgoingCommand->packet         = NULL;
+        outgoingCommand->fragmentLength = 0;
+        outgoingCommand->supersedeKey   = 0;
+        outgoingCommand->superseded     = 0;
+        outgoingCommand->command.sendReliable.dataLength = 0;
+    }
+
     static int enet_protocol_check_timeouts(ENetHost *host, ENetPeer *peer, ENetEvent *event) {
         ENetOutgoingCommand *outgoingCommand;
         ENetListIterator currentCommand, insertPosition;
 
+        ENET_TRACE_BEGIN("enet_check_timeouts");
+
         currentCommand = enet_list_begin(&peer->sentReliableCommands);
         insertPosition = enet_list_begin(&peer->outgoingReliableCommands);
 
@@ -2907,11 +3286,17 @@ extern "C" {
                 ENET_TIME_DIFFERENCE(host->serviceTime, peer->earliestTimeout) >= peer->timeoutMinimum))
             ) {
                 enet_protocol_notify_disconnect_timeout(host, peer, event);
+                ENET_TRACE_END("enet_check_timeouts");
                 return 1;
             }
 
             if (outgoingCommand->packet != NULL) {
                 peer->reliableDataInTransit -= outgoingCommand->fragmentLength;
+
+                /* a newer packet with the same key has been sent since, so this one only has to hold its place in the sequence */
+                if (outgoingCommand->superseded) {
+                    enet_peer_release_superseded_command(outgoingCommand);
+                }
             }
 
             ++peer->packetsLost;
@@ -2930,6 +3315,7 @@ extern "C" {
             }
         }
 
+        ENET_TRACE_END("enet_check_timeouts");
         return 0;
     } /* enet_protocol_check_timeouts */
 
@@ -3025,6 +3411,8 @@ extern "C" {
             host->headerFlags |= ENET_PROTOCOL_HEADER_FLAG_SENT_TIME;
 
             *command = outgoingCommand->command;
+            ENET_PEER_COMMAND_SENT(peer, outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK,
+                commandSize + (outgoingCommand->packet != NULL ? outgoingCommand->fragmentLength : 0));
 
             if (outgoingCommand->packet != NULL) {
                 ++buffer;
@@ -3143,8 +3531,10 @@ extern "C" {
 
                 shouldCompress = 0;
                 if (host->compressor.context != NULL && host->compressor.compress != NULL) {
-                    size_t originalSize = host->packetSize - sizeof(ENetProtocolHeader),
-                      compressedSize    = host->compressor.compress(host->compressor.context, &host->buffers[1], host->bufferCount - 1, originalSize, host->packetData[1], originalSize);
+                    size_t originalSize = host->packetSize - sizeof(ENetProtocolHeader), compressedSize;
+                    ENET_TRACE_BEGIN("enet_compress");
+                    compressedSize = host->compressor.compress(host->compressor.context, &host->buffers[1], host->bufferCount - 1, originalSize, host->packetData[1], originalSize);
+                    ENET_TRACE_END("enet_compress");
                     if (compressedSize > 0 && compressedSize < originalSize) {
                         host->headerFlags |= ENET_PROTOCOL_HEADER_FLAG_COMPRESSED;
                         shouldCompress     = compressedSize;
@@ -3182,6 +3572,7 @@ extern "C" {
                 host->totalSentData += sentLength;
                 currentPeer->totalDataSent += sentLength;
                 host->totalSentPackets++;
+                ENET_PEER_HEADER_SENT(currentPeer, host->buffers->dataLength);
             }
 
         return 0;
@@ -3232,13 +3623,18 @@ extern "C" {
      */
     int enet_host_service(ENetHost *host, ENetEvent *event, enet_uint32 timeout) {
         enet_uint32 waitCondition;
+        int result;
 
         if (event != NULL) {
             event->type   = ENET_EVENT_TYPE_NONE;
             event->peer   = NULL;
             event->packet = NULL;
 
-            switch (enet_protocol_dispatch_incoming_commands(host, event)) {
+            ENET_TRACE_BEGIN("enet_dispatch");
+            result = enet_protocol_dispatch_incoming_commands(host, event);
+            ENET_TRACE_END("enet_dispatch");
+
+            switch (result) {
                 case 1:
                     return 1;
 
@@ -3259,10 +3655,16 @@ extern "C" {
 
         do {
             if (ENET_TIME_DIFFERENCE(host->serviceTime, host->bandwidthThrottleEpoch) >= ENET_HOST_BANDWIDTH_THROTTLE_INTERVAL) {
+                ENET_TRACE_BEGIN("enet_bandwidth_throttle");
                 enet_host_bandwidth_throttle(host);
+                ENET_TRACE_END("enet_bandwidth_throttle");
             }
 
-            switch (enet_protocol_send_outgoing_commands(host, event, 1)) {
+            ENET_TRACE_BEGIN("enet_send");
+            result = enet_protocol_send_outgoing_commands(host, event, 1);
+            ENET_TRACE_END("enet_send");
+
+            switch (result) {
                 case 1:
                     return 1;
 
@@ -3277,7 +3679,11 @@ extern "C" {
                     break;
             }
 
-            switch (enet_protocol_receive_incoming_commands(host, event)) {
+            ENET_TRACE_BEGIN("enet_receive");
+            result = enet_protocol_receive_incoming_commands(host, event);
+            ENET_TRACE_END("enet_receive");
+
+            switch (result) {
                 case 1:
                     return 1;
 
@@ -3292,7 +3698,11 @@ extern "C" {
                     break;
             }
 
-            switch (enet_protocol_send_outgoing_commands(host, event, 1)) {
+            ENET_TRACE_BEGIN("enet_send");
+            result = enet_protocol_send_outgoing_commands(host, event, 1);
+            ENET_TRACE_END("enet_send");
+
+            switch (result) {
                 case 1:
                     return 1;
 
@@ -3308,7 +3718,11 @@ extern "C" {
             }
 
             if (event != NULL) {
-                switch (enet_protocol_dispatch_incoming_commands(host, event)) {
+                ENET_TRACE_BEGIN("enet_dispatch");
+                result = enet_protocol_dispatch_incoming_commands(host, event);
+                ENET_TRACE_END("enet_dispatch");
+
+                switch (result) {
                     case 1:
                         return 1;
 
@@ -3336,7 +3750,11 @@ extern "C" {
                 }
 
                 waitCondition = ENET_SOCKET_WAIT_RECEIVE | ENET_SOCKET_WAIT_INTERRUPT;
-                if (enet_socket_wait(host->socket, &waitCondition, ENET_TIME_DIFFERENCE(timeout, host->serviceTime)) != 0) {
+                ENET_TRACE_BEGIN("enet_wait");
+                result = enet_socket_wait(host->socket, &waitCondition, ENET_TIME_DIFFERENCE(timeout, host->serviceTime));
+                ENET_TRACE_END("enet_wait");
+
+                if (result != 0) {
                     return -1;
                 }
             } while (waitCondition & ENET_SOCKET_WAIT_INTERRUPT);
@@ -3628,6 +4046,96 @@ extern "C" {
         return 0;
     } // enet_peer_send
 
+    /** Queues a reliable packet that is only worth delivering until a newer packet with the same key is sent, like the latest state of one object.
+     *  If an older packet with the key is still waiting to be sent, the new packet takes its place in the queue, and its place in the
+     *  order packets are delivered, instead of going in behind it. Older packets with the key that are sent but not acknowledged yet
+     *  are resent with no data if they are lost, and the receiver gets an empty packet.
+     *  Packets that are not reliable, or need more than one fragment, are sent as with enet_peer_send.
+     *  @param peer destination for the packet
+     *  @param channelID channel on which to send
+     *  @param packet packet to send
+     *  @param key what the packet is the latest of, 0 sends the packet as with enet_peer_send
+     *  @retval 1 if the packet replaced an older one that had not been sent yet
+     *  @retval 0 if the packet was queued
+     *  @retval < 0 on failure
+     */
+    int enet_peer_send_latest(ENetPeer *peer, enet_uint8 channelID, ENetPacket *packet, enet_uint32 key) {
+        ENetOutgoingCommand *outgoingCommand;
+        ENetListIterator currentCommand;
+        ENetProtocol command;
+        size_t fragmentLength;
+
+        if (peer->state != ENET_PEER_STATE_CONNECTED || channelID >= peer->channelCount || packet->dataLength > peer->host->maximumPacketSize) {
+            return -1;
+        }
+
+        fragmentLength = peer->mtu - sizeof(ENetProtocolHeader) - sizeof(ENetProtocolSendFragment);
+        if (peer->host->checksum != NULL) {
+            fragmentLength -= sizeof(enet_uint32);
+        }
+
+        if (key == 0 || !(packet->flags & ENET_PACKET_FLAG_RELIABLE) || packet->dataLength > fragmentLength) {
+            return enet_peer_send(peer, channelID, packet);
+        }
+
+        for (currentCommand = enet_list_begin(&peer->sentReliableCommands);
+            currentCommand != enet_list_end(&peer->sentReliableCommands);
+            currentCommand = enet_list_next(currentCommand)
+        ) {
+            outgoingCommand = (ENetOutgoingCommand *) currentCommand;
+
+            /* still counted as in transit until it is acknowledged or times out, so it lets go of its data then */
+            if (outgoingCommand->supersedeKey == key && outgoingCommand->command.header.channelID == channelID) {
+                outgoingCommand->supersedeKey = 0;
+                outgoingCommand->superseded   = 1;
+            }
+        }
+
+        for (currentCommand = enet_list_begin(&peer->outgoingReliableCommands);
+            currentCommand != enet_list_end(&peer->outgoingReliableCommands);
+            currentCommand = enet_list_next(currentCommand)
+        ) {
+            outgoingCommand = (ENetOutgoingCommand *) currentCommand;
+
+            if (outgoingCommand->supersedeKey != key || outgoingCommand->command.header.channelID != channelID) {
+                continue;
+            }
+
+            /* waiting to be resent after a timeout, which already took it out of the data in transit */
+            if (outgoingCommand->sendAttempts > 0) {
+                enet_peer_release_superseded_command(outgoingCommand);
+                continue;
+            }
+
+            /* never sent, so the new packet can go out under its sequence number instead */
+            --outgoingCommand->packet->referenceCount;
+
+            if (outgoingCommand->packet->referenceCount == 0) {
+                callbacks.packet_destroy(outgoingCommand->packet);
+            }
+
+            ++packet->referenceCount;
+
+            outgoingCommand->packet         = packet;
+            outgoingCommand->fragmentLength = (enet_uint16) packet->dataLength;
+            outgoingCommand->command.sendReliable.dataLength = ENET_HOST_TO_NET_16(packet->dataLength);
+
+            return 1;
+        }
+
+        command.header.command   = ENET_PROTOCOL_COMMAND_SEND_RELIABLE | ENET_PROTOCOL_COMMAND_FLAG_ACKNOWLEDGE;
+        command.header.channelID = channelID;
+        command.sendReliable.dataLength = ENET_HOST_TO_NET_16(packet->dataLength);
+
+        outgoingCommand = enet_peer_queue_outgoing_command(peer, &command, packet, 0, packet->dataLength);
+        if (outgoingCommand == NULL) {
+            return -1;
+        }
+
+        outgoingCommand->supersedeKey = key;
+        return 0;
+    } // enet_peer_send_latest
+
     /** Attempts to dequeue any incoming queued packet.
      *  @param peer peer to dequeue packets from
      *  @param channelID holds the channel ID of the channel the packet was received on success
@@ -3768,6 +4276,10 @@ extern "C" {
     void enet_peer_reset(ENetPeer *peer) {
         enet_peer_on_disconnect(peer);
 
+        if (peer->state != ENET_PEER_STATE_DISCONNECTED) {
+            enet_host_release_peer(peer->host, peer);
+        }
+
         // We don't want to reset connectID here, otherwise, we can't get it in the Disconnect event
         // peer->connectID                     = 0;
         peer->outgoingPeerID                = ENET_PROTOCOL_MAXIMUM_PEER_ID;
@@ -3818,6 +4330,7 @@ extern "C" {
         peer->totalWaitingData              = 0;
 
         memset(peer->unsequencedWindow, 0, sizeof(peer->unsequencedWindow));
+        ENET_PEER_STATS_RESET(peer);
         enet_peer_reset_queues(peer);
     }
 
@@ -4032,6 +4545,9 @@ extern "C" {
         outgoingCommand->sentTime              = 0;
         outgoingCommand->roundTripTimeout      = 0;
         outgoingCommand->roundTripTimeoutLimit = 0;
+        outgoingCommand->supersedeKey          = 0;
+        outgoingCommand->superseded            = 0;
+        outgoingCommand->queueTime             = peer->host->serviceTime;
         outgoingCommand->command.header.reliableSequenceNumber = ENET_HOST_TO_NET_16(outgoingCommand->reliableSequenceNumber);
 
         switch (outgoingCommand->command.header.command & ENET_PROTOCOL_COMMAND_MASK) {
@@ -4409,6 +4925,24 @@ extern "C" {
 
         memset(host->peers, 0, peerCount * sizeof(ENetPeer));
 
+        /* twice as many buckets as peers, so the chains stay short */
+        for (host->addressBucketMask = 1; host->addressBucketMask < peerCount * 2; host->addressBucketMask <<= 1);
+        host->freePeers    = (ENetPeer **) enet_malloc(ENET_MAX(peerCount, 1) * sizeof(ENetPeer *));
+        host->addressPeers = (ENetPeer **) enet_malloc(host->addressBucketMask * sizeof(ENetPeer *));
+        host->hostPeers    = (ENetPeer **) enet_malloc(host->addressBucketMask * sizeof(ENetPeer *));
+        if (host->freePeers == NULL || host->addressPeers == NULL || host->hostPeers == NULL) {
+            enet_free(host->freePeers);
+            enet_free(host->addressPeers);
+            enet_free(host->hostPeers);
+            enet_free(host->peers);
+            enet_free(host);
+            return NULL;
+        }
+
+        memset(host->addressPeers, 0, host->addressBucketMask * sizeof(ENetPeer *));
+        memset(host->hostPeers, 0, host->addressBucketMask * sizeof(ENetPeer *));
+        host->addressBucketMask -= 1;
+
         host->socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
         if (host->socket != ENET_SOCKET_NULL) {
             enet_socket_set_option (host->socket, ENET_SOCKOPT_IPV6_V6ONLY, 0);
@@ -4419,6 +4953,9 @@ extern "C" {
                 enet_socket_destroy(host->socket);
             }
 
+            enet_free(host->freePeers);
+            enet_free(host->addressPeers);
+            enet_free(host->hostPeers);
             enet_free(host->peers);
             enet_free(host);
 
@@ -4444,6 +4981,7 @@ extern "C" {
         host->randomSeed                    = (enet_uint32) (size_t) host;
         host->randomSeed                    += enet_host_random_seed();
         host->randomSeed                    = (host->randomSeed << 16) | (host->randomSeed >> 16);
+        host->addressSeed                   = host->randomSeed * 0x9E3779B1U;
         host->channelLimit                  = channelLimit;
         host->incomingBandwidth             = incomingBandwidth;
         host->outgoingBandwidth             = outgoingBandwidth;
@@ -4472,6 +5010,11 @@ extern "C" {
         host->compressor.decompress         = NULL;
         host->compressor.destroy            = NULL;
         host->intercept                     = NULL;
+        host->connectCookies                = 0;
+        host->connectCookieKey[0]           = 0;
+        host->connectCookieKey[1]           = 0;
+        host->totalConnectCookiesSent       = 0;
+        ENET_HOST_STATS_RESET(host);
 
         enet_list_clear(&host->dispatchQueue);
 
@@ -4491,6 +5034,12 @@ extern "C" {
             enet_peer_reset(currentPeer);
         }
 
+        /* the first peer ends up on top, so peers are used in order until some disconnect */
+        host->freePeerCount = 0;
+        for (currentPeer = &host->peers[host->peerCount]; currentPeer > host->peers; ) {
+            host->freePeers[host->freePeerCount++] = --currentPeer;
+        }
+
         return host;
     } /* enet_host_create */
 
@@ -4514,6 +5063,9 @@ extern "C" {
             (*host->compressor.destroy)(host->compressor.context);
         }
 
+        enet_free(host->freePeers);
+        enet_free(host->addressPeers);
+        enet_free(host->hostPeers);
         enet_free(host->peers);
         enet_free(host);
     }
@@ -4530,6 +5082,7 @@ extern "C" {
     ENetPeer * enet_host_connect(ENetHost *host, const ENetAddress *address, size_t channelCount, enet_uint32 data) {
         ENetPeer *currentPeer;
         ENetChannel *channel;
+        ENetChannel *channels;
         ENetProtocol command;
 
         if (channelCount < ENET_PROTOCOL_MINIMUM_CHANNEL_COUNT) {
@@ -4538,24 +5091,19 @@ extern "C" {
             channelCount = ENET_PROTOCOL_MAXIMUM_CHANNEL_COUNT;
         }
 
-        for (currentPeer = host->peers; currentPeer < &host->peers[host->peerCount]; ++currentPeer) {
-            if (currentPeer->state == ENET_PEER_STATE_DISCONNECTED) {
-                break;
-            }
-        }
-
-        if (currentPeer >= &host->peers[host->peerCount]) {
+        if (host->freePeerCount == 0) {
             return NULL;
         }
 
-        currentPeer->channels = (ENetChannel *) enet_malloc(channelCount * sizeof(ENetChannel));
-        if (currentPeer->channels == NULL) {
+        channels = (ENetChannel *) enet_malloc(channelCount * sizeof(ENetChannel));
+        if (channels == NULL) {
             return NULL;
         }
 
+        currentPeer = enet_host_take_free_peer(host, address);
+        currentPeer->channels     = channels;
         currentPeer->channelCount = channelCount;
         currentPeer->state        = ENET_PEER_STATE_CONNECTING;
-        currentPeer->address      = *address;
         currentPeer->connectID    = ++host->randomSeed;
 
         if (host->outgoingBandwidth == 0) {
@@ -4667,6 +5215,40 @@ extern "C" {
         host->intercept = callback;
     }
 
+    /** Turns connect cookies on or off for the host.
+     *  With cookies on, a connect from an address has to carry a cookie the host sent to that address before a peer is allocated for it.
+     *  Connects without one get a cookie back and nothing else, so a flood of connects from spoofed addresses can't fill up the peers.
+     *  Connecting takes one more round trip. Clients don't need anything turned on to connect to a host with cookies on.
+     *  @param host host to set cookies for
+     *  @param enable 1 to turn cookies on, 0 to turn them off
+     *  @param key ENET_HOST_CONNECT_COOKIE_KEY_SIZE bytes that cookies are signed with, this should come from a good random source.
+     *  If NULL, a key is made from the host's random seed, which is only as hard to guess as that is.
+     */
+    void enet_host_connect_cookies(ENetHost *host, int enable, const enet_uint8 *key) {
+        int i;
+
+        host->connectCookies = enable;
+        if (!enable) {
+            return;
+        }
+
+        host->connectCookieKey[0] = 0;
+        host->connectCookieKey[1] = 0;
+
+        if (key != NULL) {
+            for (i = 0; i < ENET_HOST_CONNECT_COOKIE_KEY_SIZE; ++i) {
+                host->connectCookieKey[i / 8] |= (enet_uint64) key[i] << (8 * (i % 8));
+            }
+        } else {
+            enet_uint64 seed[2];
+            seed[0] = host->randomSeed;
+            seed[1] = enet_host_random_seed() ^ (enet_uint64) (size_t) host;
+            host->connectCookieKey[0] = enet_siphash(seed, (const enet_uint8 *) &host->address, sizeof(host->address));
+            seed[0] ^= enet_time_get();
+            host->connectCookieKey[1] = enet_siphash(seed, (const enet_uint8 *) &host->address, sizeof(host->address));
+        }
+    }
+
     /** Sets the packet compressor the host should use to compress and decompress packets.
      *  @param host host to enable or disable compression for
      *  @param compressor callbacks for for the packet compressor; if NULL, then compression is disabled
@@ -4957,6 +5539,8 @@ extern "C" {
         }
     #endif
 
+    static enet_uint32 enet_time_offset = 0;
+
     enet_uint32 enet_time_get() {
         // TODO enet uses 32 bit timestamps. We should modify it to use
         // 64 bit timestamps, but this is not trivial since we'd end up
@@ -5003,7 +5587,11 @@ extern "C" {
         }
 
         uint64_t result_in_ns = current_time_ns - offset_ns;
-        return (enet_uint32)(result_in_ns / ns_in_ms);
+        return (enet_uint32)(result_in_ns / ns_in_ms) + enet_time_offset;
+    }
+
+    void enet_time_set(enet_uint32 newTimeBase) {
+        enet_time_offset += newTimeBase - enet_time_get();
     }
 
     void enet_inaddr_map4to6(struct in_addr in, struct in6_addr *out)
@@ -0,0 +1,129 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// allocation tracking
+// enet does all of its allocating through callbacks, so we can slip a counting allocator in under it and see every packet, command and peer buffer it makes
+// it counts allocations, frees and bytes by size class, keeps how much is live and the most that has ever been live,
+// and tick trackers work out how much each tick allocated, so we can check the hot paths settle down to nothing once the game is running
+// tracking is optional, without it enet uses plain malloc and free and none of this costs anything
+// this header must not include enet.h, so code that can't include enet (like the raylib client) can still read the numbers
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// allocations are counted by size, size class 0 is up to 16 bytes and each class after that doubles, the last class takes anything bigger
+#define AllocSizeClassCount 16
+
+// running totals of everything that has been allocated and freed
+typedef struct
+{
+	uint64_t Allocations;
+	uint64_t Frees;
+	uint64_t BytesAllocated;
+	uint64_t BytesFreed;
+
+	// how many allocations fell in each size class
+	uint64_t SizeClasses[AllocSizeClassCount];
+
+	// how much is allocated right now, and the most that has been at once
+	uint64_t LiveAllocations;
+	uint64_t LiveBytes;
+	uint64_t PeakLiveAllocations;
+	uint64_t PeakLiveBytes;
+}AllocCounters;
+
+// allocation rates for a repeating piece of work, like a server tick or a client update
+// each tracker is separate, so several clients in one program can each have their own
+typedef struct
+{
+	// the totals when the current tick started
+	uint64_t StartAllocations;
+	uint64_t StartBytes;
+
+	// how many ticks were tracked, and how many of them didn't allocate anything
+	uint64_t Ticks;
+	uint64_t QuietTicks;
+
+	// everything allocated during tracked ticks
+	uint64_t Allocations;
+	uint64_t Bytes;
+
+	// the last tick, and the most any one tick allocated
+	uint64_t LastAllocations;
+	uint64_t LastBytes;
+	uint64_t PeakAllocations;
+	uint64_t PeakBytes;
+}AllocTickTracker;
+
+/// <summary>
+/// Start up enet, optionally with the tracking allocator.
+/// Use this instead of enet_initialize. Every call in a program must make the same choice, memory from one allocator can't be freed by the other
+/// </summary>
+/// <param name="trackAllocations">True to count every allocation enet makes</param>
+/// <returns>0 on success, less than 0 on failure, the same as enet_initialize</returns>
+int InitializeNetwork(bool trackAllocations);
+
+/// <summary>
+/// Check if the tracking allocator is in use
+/// </summary>
+/// <returns>True if allocations are being counted</returns>
+bool TrackingAllocations();
+
+/// <summary>
+/// Get the running allocation totals
+/// </summary>
+/// <param name="counters">Where to copy the totals to</param>
+void GetAllocCounters(AllocCounters* counters);
+
+/// <summary>
+/// Get the largest allocation that is counted in a size class
+/// </summary>
+/// <param name="sizeClass">The size class</param>
+/// <returns>The largest size in bytes, or SIZE_MAX for the last class</returns>
+size_t GetAllocSizeClassLimit(int sizeClass);
+
+/// <summary>
+/// Mark the start of a tick
+/// </summary>
+/// <param name="tracker">The tracker for the work being timed</param>
+void BeginAllocTick(AllocTickTracker* tracker);
+
+/// <summary>
+/// Mark the end of a tick, and add what it allocated to the tracker
+/// </summary>
+/// <param name="tracker">The tracker that BeginAllocTick was called with</param>
+/// <returns>The number of allocations made during the tick</returns>
+uint64_t EndAllocTick(AllocTickTracker* tracker);
+
+/// <summary>
+/// Clear the rates and peaks of a tick tracker, so the next report only covers what happens after this
+/// </summary>
+/// <param name="tracker">The tracker to clear</param>
+void ResetAllocTickTracker(AllocTickTracker* tracker);
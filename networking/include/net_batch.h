@@ -0,0 +1,126 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// message batching
+// game messages are tiny (2 to 10 bytes), but every enet packet costs an allocation, an outgoing command and a 12 byte command header
+// so instead of sending each message as its own packet, messages for a peer are collected in a batch and sent together as one packet when the batch is flushed
+// a batch packet starts with the BatchedMessages command, then each message follows with a one byte length in front of it
+// the reader handles both batches and plain single message packets, so either side can send either
+#pragma once
+
+#include "net_common.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// the most bytes a batch packet holds, small enough that enet never has to split it across datagrams
+#define MessageBatchCapacity 1200
+
+// the biggest message that can go in a batch, the length has to fit in one byte
+#define MaxBatchedMessage 255
+
+// messages waiting to be sent to one peer
+typedef struct
+{
+	uint8_t Data[MessageBatchCapacity];
+
+	// how many bytes are used, including the batch command at the start, 0 if the batch is empty
+	size_t Length;
+
+	// how many messages are in the batch
+	int Count;
+}MessageBatch;
+
+// reads the messages out of a received packet, one at a time
+typedef struct
+{
+	ENetPacket* Packet;
+
+	// where the next message starts
+	size_t Next;
+
+	// false if the packet is one plain message, not a batch
+	bool Batched;
+}MessageReader;
+
+/// <summary>
+/// Empty a batch, without sending anything
+/// </summary>
+/// <param name="batch">The batch to empty</param>
+void ResetMessageBatch(MessageBatch* batch);
+
+/// <summary>
+/// Get how many bytes a message adds to a batch, counting its length prefix, and the batch command if the batch is empty
+/// </summary>
+/// <param name="batch">The batch</param>
+/// <param name="length">The size of the message</param>
+/// <returns>The bytes it would add</returns>
+size_t GetBatchedMessageCost(const MessageBatch* batch, size_t length);
+
+/// <summary>
+/// Add a message to a batch. If the batch is full it is sent to the peer first, and the message starts a new batch
+/// </summary>
+/// <param name="batch">The batch for the peer</param>
+/// <param name="peer">The peer the batch goes to</param>
+/// <param name="message">The message, starting with its command byte</param>
+/// <param name="length">The size of the message, at most MaxBatchedMessage</param>
+/// <returns>True if the batch had to be sent to make room</returns>
+bool BatchMessage(MessageBatch* batch, ENetPeer* peer, const void* message, size_t length);
+
+/// <summary>
+/// Send everything in a batch to its peer as one reliable packet, and empty it. Does nothing if the batch is empty
+/// </summary>
+/// <param name="batch">The batch to send</param>
+/// <param name="peer">The peer it goes to</param>
+/// <returns>The size of the packet that was sent, 0 if nothing was sent</returns>
+size_t FlushMessageBatch(MessageBatch* batch, ENetPeer* peer);
+
+/// <summary>
+/// Send everything in a batch to its peer as one reliable packet that only matters until the next one with the same key, and empty it.
+/// A packet with the key that is still waiting to go out is replaced, and older ones that are not acknowledged yet are not resent, see enet_peer_send_latest
+/// </summary>
+/// <param name="batch">The batch to send</param>
+/// <param name="peer">The peer it goes to</param>
+/// <param name="key">What the batch is the latest of, such as a player id plus one, never 0</param>
+/// <returns>1 if the batch replaced a packet that had not been sent yet, 0 if it was queued, -1 if nothing was sent</returns>
+int FlushMessageBatchLatest(MessageBatch* batch, ENetPeer* peer, uint32_t key);
+
+/// <summary>
+/// Start reading the messages in a received packet
+/// </summary>
+/// <param name="reader">The reader to set up</param>
+/// <param name="packet">The packet to read</param>
+void BeginReadMessages(MessageReader* reader, ENetPacket* packet);
+
+/// <summary>
+/// Find the next message in a packet. The message can be read with ReadByte and ReadShort from the offset
+/// </summary>
+/// <param name="reader">The reader</param>
+/// <param name="offset">Set to where the message starts, the first byte is its command</param>
+/// <returns>The size of the message, or 0 when there are no more messages (or the rest of the packet is damaged)</returns>
+size_t ReadNextMessage(MessageReader* reader, size_t* offset);
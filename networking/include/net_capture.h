@@ -0,0 +1,105 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// capture and replay of raw datagrams
+// a capture records every datagram a host receives, with when it arrived and who sent it, so a real session can be played back later
+// the replay tool feeds a capture in to a server host, either at the original timing or as fast as it can, which makes for repeatable load tests
+#pragma once
+
+#include "net_common.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// the biggest datagram that can be in a capture, enet never receives more than this
+#define CaptureMaxDatagram ENET_PROTOCOL_MAXIMUM_MTU
+
+// the most different senders a capture can tell apart, datagrams from anyone after this are not recorded
+#define CaptureMaxSources 4096
+
+// one datagram read back out of a capture
+typedef struct
+{
+	// seconds since the capture started
+	double Time;
+
+	// what enet_time_get said on the capturing host when the datagram arrived, replaying on this clock keeps enet's timestamps lined up
+	uint32_t ServiceTime;
+
+	// which sender this came from, numbered in the order they were first seen
+	uint16_t Source;
+
+	// the address of the sender
+	ENetAddress Address;
+
+	uint16_t Length;
+	uint8_t Data[CaptureMaxDatagram];
+}CapturedDatagram;
+
+typedef struct CaptureReader CaptureReader;
+
+/// <summary>
+/// Start recording every datagram a host receives to a file.
+/// This uses the host's intercept callback, so the host can't have another intercept set, and only one host can be captured at a time
+/// </summary>
+/// <param name="host">The host to capture</param>
+/// <param name="path">The file to write, any existing file is replaced</param>
+/// <returns>False if the file could not be opened or a capture is already running</returns>
+bool StartCapture(ENetHost* host, const char* path);
+
+/// <summary>
+/// Write out anything recorded since the last flush, if it has been long enough since then.
+/// Call this regularly, servers usually get killed instead of shut down, and anything still buffered would be lost
+/// </summary>
+void FlushCapture();
+
+/// <summary>
+/// Stop recording and close the capture file
+/// </summary>
+void StopCapture();
+
+/// <summary>
+/// Open a capture file to read back
+/// </summary>
+/// <param name="path">The file to read</param>
+/// <returns>The reader, or NULL if the file could not be opened or is not a capture</returns>
+CaptureReader* OpenCapture(const char* path);
+
+/// <summary>
+/// Read the next datagram from a capture
+/// </summary>
+/// <param name="reader">The capture to read from</param>
+/// <param name="datagram">Where to put the datagram</param>
+/// <returns>False at the end of the capture, or if the file is damaged</returns>
+bool ReadCapturedDatagram(CaptureReader* reader, CapturedDatagram* datagram);
+
+/// <summary>
+/// Close a capture that was opened for reading
+/// </summary>
+/// <param name="reader">The capture to close</param>
+void CloseCapture(CaptureReader* reader);
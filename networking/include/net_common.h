@@ -31,6 +31,10 @@
 
 #include "net_constants.h"
 
+// tracing and stats have to come before enet so they can hook in to it
+#include "net_trace.h"
+#include "net_stats.h"
+
 // ensure we are using winsock2 on windows.
 #if (_WIN32_WINNT < 0x0601)
 #undef _WIN32_WINNT
@@ -58,4 +62,33 @@ uint8_t ReadByte(ENetPacket* packet, size_t* offset);
 /// <param name="packet">The packet to read from<</param>
 /// <param name="offset">A pointer to an offset that is updated, this should be passed to other read functions so they read from the correct place</param>
 /// <returns>The signed short that is read</returns>
-int16_t ReadShort(ENetPacket* packet, size_t* offset);
\ No newline at end of file
+int16_t ReadShort(ENetPacket* packet, size_t* offset);
+
+/// <summary>
+/// Read a signed 32 bit int from the network packet, in the host's byte ordering like ReadShort
+/// </summary>
+/// <param name="packet">The packet to read from</param>
+/// <param name="offset">A pointer to an offset that is updated, this should be passed to other read functions so they read from the correct place</param>
+/// <returns>The int that is read, 0 if there isn't a whole int left in the packet</returns>
+int32_t ReadInt(ENetPacket* packet, size_t* offset);
+
+/// <summary>
+/// Get a readable name for a network command, for logs and stats
+/// </summary>
+/// <param name="command">The command byte from a packet</param>
+/// <returns>The name of the command, or "Unknown" if it is not one we know about</returns>
+const char* GetCommandName(uint8_t command);
+
+/// <summary>
+/// Get the time from a high resolution clock, for timing code.
+/// enet_time_get only counts in milliseconds, which is too coarse to time one server tick
+/// </summary>
+/// <returns>The current time in seconds, from an arbitrary starting point</returns>
+double GetPreciseTime();
+
+/// <summary>
+/// Turn a time in seconds into the two byte units input traces are sent in, see InputTraceUnitsPerSecond
+/// </summary>
+/// <param name="seconds">The time to pack, negative times are 0</param>
+/// <returns>The time in input trace units, capped at the largest two byte value</returns>
+uint16_t PackTraceTime(double seconds);
@@ -42,7 +42,7 @@
 // All the different commands that can be sent over the network
 typedef enum
 {
-	// Server -> Client, You have been accepted. Contains the id for the client player to use
+	// Server -> Client, You have been accepted. Contains the id for the client player to use, flags (AcceptResumed if they got their old slot back), and a four byte session token
 	AcceptPlayer = 1,
 
 	// Server -> Client, Add a new player to your simulation, contains the ID of the player and a position
@@ -56,4 +56,57 @@ typedef enum
 
 	// Client -> Server, Provide an updated location for the client's player, contains the postion to update
 	UpdateInput = 5,
+
+	// Both ways, several messages sent together in one packet, each one has a byte with its length in front of it
+	BatchedMessages = 6,
+
+	// Server -> Client, Everyone already in the game, sent to a new player instead of an AddPlayer for each one
+	// big worlds are split over several of these, each has a flags byte (JoinSnapshotLast on the final one), a two byte count, and then an entry for each player
+	JoinSnapshot = 7,
+
+	// Client -> Server, sent as soon as a client that had a session token is connected again
+	// contains a four byte count of the messages the client got on its last connection, and a bit for each player it still has
+	ResumeSession = 8,
+
+	// Server -> Client, how long a sampled input from another player took to get to the server and through it, sent right after the UpdatePlayer that carries it
+	// contains the id of the player, the trace id, and the time the input spent on their client, going up to the server, and on the server, see InputTraceSize
+	InputTrace = 9,
 }NetworkCommands;
+
+// the size of an add player or update player message, the command, the id, and the position and direction as four shorts
+#define PlayerUpdateSize 10
+
+// the size of a remove player message, the command and the id
+#define RemovePlayerSize 2
+
+// the layout of a join snapshot, the header is the command, the flags and the count
+// each entry is a two byte player id, then the position and velocity as four shorts, like an AddPlayer
+#define JoinSnapshotHeaderSize 4
+#define JoinSnapshotEntrySize 10
+
+// set in the flags of the last join snapshot, once it arrives the client has the whole world
+#define JoinSnapshotLast 1
+
+// the size of an accept player message, the command, the id, the flags and the session token
+#define AcceptPlayerSize 7
+
+// set in the flags of an accept player when the player got their old slot back, and only needs what they missed
+#define AcceptResumed 1
+
+// the layout of a resume session message, the command and the message count, then one bit for each player slot
+#define ResumeSessionHeaderSize 5
+#define ResumeKnownMaskSize ((MAX_PLAYERS + 7) / 8)
+
+// an update input is 9 bytes, the command and the position and direction as four shorts
+// every so often the client samples an input to time how long it takes to show up for everyone else, and adds a two byte trace id and how long it held the input before sending it
+#define UpdateInputSize 9
+#define UpdateInputTracedSize 13
+
+// the layout of an input trace, the command, the player id, the two byte trace id, then three two byte times, how long the input was held on the client that sent it, the trip up to the server, and how long the server held it
+#define InputTraceSize 10
+
+// the times in input traces are in tenths of a millisecond, so they fit in two bytes up to about 6.5 seconds
+#define InputTraceUnitsPerSecond 10000.0
+
+// the data the server sends with a disconnect when the client's connection couldn't keep up, the client keeps its session token and can come back
+#define DisconnectTooSlow 1
@@ -0,0 +1,241 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// adaptive send rate control, shared by the client and the server
+#pragma once
+
+#include "net_common.h"
+
+#include <stdbool.h>
+
+// The settings that bound what the rate controller is allowed to do
+typedef struct
+{
+	// the fastest and slowest we will ever send updates, in seconds between sends
+	double MinInterval;
+	double MaxInterval;
+
+	// how much extra round trip time (above the best we have seen) we accept before we call the link congested, in milliseconds
+	uint32_t MaxQueueDelay;
+
+	// how much packet loss we accept before backing off, as a ratio of ENET_PEER_PACKET_LOSS_SCALE
+	uint32_t MaxLoss;
+
+	// how many bytes can be waiting to go out to the peer before backing off
+	size_t MaxBacklog;
+
+	// the smallest and largest number of entity updates we will put into one snapshot
+	int MinDetail;
+	int MaxDetail;
+
+	// how often in seconds the controller is allowed to change its mind, so one bad sample doesn't make it jump around
+	double AdjustPeriod;
+}RateControlConfig;
+
+// The current state of the rate controller for one connection
+typedef struct
+{
+	// how long to wait between updates right now
+	double Interval;
+
+	// how many entity updates go into a snapshot right now
+	int Detail;
+
+	// the last time we sent an update, and the last time we changed the rate
+	double LastSend;
+	double LastAdjust;
+
+	// the lowest round trip time we have seen, this is our guess at the latency of an empty link
+	uint32_t BaseRTT;
+}RateControl;
+
+/// <summary>
+/// The default settings, 10 to 60 updates a second and up to MAX_PLAYERS entities per snapshot
+/// </summary>
+/// <returns>A config that can be used as is or modified</returns>
+RateControlConfig DefaultRateControlConfig();
+
+/// <summary>
+/// Start a rate controller at the fastest rate and the most detail the config allows
+/// </summary>
+/// <param name="rate">The controller to set up</param>
+/// <param name="config">The bounds the controller must stay in</param>
+void InitRateControl(RateControl* rate, const RateControlConfig* config);
+
+/// <summary>
+/// Feed one measurement of the link into the rate controller.
+/// When the link looks congested the interval is multiplied up and the detail is halved, when it looks healthy they slowly recover.
+/// </summary>
+/// <param name="rate">The controller to update</param>
+/// <param name="config">The bounds the controller must stay in</param>
+/// <param name="now">The current time in seconds</param>
+/// <param name="rtt">The smoothed round trip time in milliseconds</param>
+/// <param name="loss">The packet loss as a ratio of ENET_PEER_PACKET_LOSS_SCALE</param>
+/// <param name="backlog">The number of bytes queued to be sent but not acknowledged yet</param>
+void UpdateRateControlSample(RateControl* rate, const RateControlConfig* config, double now, uint32_t rtt, uint32_t loss, size_t backlog);
+
+/// <summary>
+/// Read the round trip time, packet loss and outgoing backlog from an enet peer and feed them into the rate controller
+/// </summary>
+/// <param name="rate">The controller to update</param>
+/// <param name="config">The bounds the controller must stay in</param>
+/// <param name="now">The current time in seconds</param>
+/// <param name="peer">The peer the updates are going to</param>
+void UpdateRateControl(RateControl* rate, const RateControlConfig* config, double now, ENetPeer* peer);
+
+/// <summary>
+/// Check if it is time to send the next update, and if so mark that we have sent it
+/// </summary>
+/// <param name="rate">The controller to check</param>
+/// <param name="now">The current time in seconds</param>
+/// <returns>True if an update should be sent now</returns>
+bool RateControlShouldSend(RateControl* rate, double now);
+
+/// <summary>
+/// Get how many bytes of data are waiting to go out to a peer, this includes data that has been sent but not acknowledged yet
+/// </summary>
+/// <param name="peer">The peer to check</param>
+/// <returns>The number of bytes queued</returns>
+size_t GetPeerOutgoingBacklog(ENetPeer* peer);
+
+// How backed up the data going to a peer is, see GetPeerBackpressure
+typedef struct
+{
+	// data enet has not sent yet, in bytes and in commands
+	size_t QueuedBytes;
+	uint32_t QueuedCommands;
+
+	// reliable data that is on the wire but not acknowledged yet, in bytes and in commands
+	size_t InTransitBytes;
+	uint32_t InTransitCommands;
+
+	// how long it will take to get everything that is queued and in transit through, in seconds
+	// enet can have one reliable window in flight per round trip, so this is the backlog in windows times the round trip time
+	double DrainTime;
+
+	// how long the oldest data that is queued or in transit has been waiting, in seconds
+	// the round trip time enet measures drops when a resend is acknowledged, so for a peer that has stopped reading the drain time can look fine while this keeps growing
+	double OldestWait;
+}PeerBackpressure;
+
+// How far the updates to a peer have been cut back because it can't keep up with them, from none to giving up on it
+typedef enum
+{
+	// it is keeping up, it gets everything
+	BackpressureNone = 0,
+
+	// a little is waiting, so updates should replace older ones about the same thing instead of queueing behind them
+	BackpressureLatestOnly,
+
+	// it would take too long to get through what is waiting, so it only gets updates every so often on top of that
+	BackpressureReduced,
+
+	// it has been too slow for too long, or too much is waiting for it, disconnect it
+	BackpressureDisconnect,
+}BackpressureLevel;
+
+// The limits that decide when updates to a peer are cut back, and when it is disconnected
+typedef struct
+{
+	// how many bytes can be waiting before updates are sent latest only
+	size_t LatestOnlyBacklog;
+
+	// how long it can take to drain what is waiting, or how long the oldest data can wait, before the peer only gets reduced updates, in seconds
+	// it goes back to latest only once both are under half of this
+	double ReducedDelay;
+
+	// the time between updates while reduced, in seconds
+	double ReducedInterval;
+
+	// how long a peer can stay reduced before it is disconnected, in seconds
+	double SlowTimeout;
+
+	// how many bytes can be waiting before the peer is disconnected straight away
+	size_t MaxBacklog;
+}BackpressureConfig;
+
+// The backpressure state of one peer
+typedef struct
+{
+	// what should be done with updates to the peer right now
+	BackpressureLevel Level;
+
+	// the last reading that was taken of the peer
+	PeerBackpressure Last;
+
+	// when the peer went reduced, and the last time it was sent a reduced update
+	double SlowSince;
+	double LastSend;
+}BackpressureControl;
+
+/// <summary>
+/// Read how much is waiting to go out to a peer, and how long it should take to get through
+/// </summary>
+/// <param name="peer">The peer to check</param>
+/// <param name="pressure">Filled out with what is waiting</param>
+void GetPeerBackpressure(ENetPeer* peer, PeerBackpressure* pressure);
+
+/// <summary>
+/// The default limits, latest only past 2KB, reduced to 4 updates a second past a second of delay, and disconnected after 10 seconds reduced or 256KB waiting
+/// </summary>
+/// <returns>A config that can be used as is or modified</returns>
+BackpressureConfig DefaultBackpressureConfig();
+
+/// <summary>
+/// Start the backpressure state of a new connection, with nothing cut back
+/// </summary>
+/// <param name="control">The state to set up</param>
+void InitBackpressure(BackpressureControl* control);
+
+/// <summary>
+/// Read the backpressure of a peer and work out how far its updates should be cut back
+/// </summary>
+/// <param name="control">The state of the peer</param>
+/// <param name="config">The limits to check against</param>
+/// <param name="now">The current time in seconds</param>
+/// <param name="peer">The peer the updates are going to</param>
+/// <returns>The new level, the same as control->Level</returns>
+BackpressureLevel UpdateBackpressure(BackpressureControl* control, const BackpressureConfig* config, double now, ENetPeer* peer);
+
+/// <summary>
+/// Check if a peer that is due an update can have it at its backpressure level, without marking anything.
+/// This always says yes until the peer is reduced. Check this before anything else that marks a send, and call BackpressureMarkSent once the update is going out
+/// </summary>
+/// <param name="control">The state of the peer</param>
+/// <param name="config">The limits the peer is under</param>
+/// <param name="now">The current time in seconds</param>
+/// <returns>True if the update can be sent now</returns>
+bool BackpressureShouldSend(const BackpressureControl* control, const BackpressureConfig* config, double now);
+
+/// <summary>
+/// Mark that a peer was sent an update, so a reduced peer waits for its next one
+/// </summary>
+/// <param name="control">The state of the peer</param>
+/// <param name="now">The current time in seconds</param>
+void BackpressureMarkSent(BackpressureControl* control, double now);
@@ -0,0 +1,120 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// looking up server addresses without stalling the caller
+// name lookups can take seconds when DNS is slow, so they run on a worker thread and the caller polls for the result each frame
+#pragma once
+
+#include "net_common.h"
+
+#include <stdbool.h>
+
+// how many resolved names we remember
+#define ResolveCacheSize 8
+
+// the longest host name we will look up, including the terminator
+#define ResolveNameLength 256
+
+// A function that turns a host name into an address, returning 0 on success, the same as enet_address_set_host
+// this is called on the worker thread, so it must not touch anything the caller is using
+typedef int (*ResolveHostFunction)(ENetAddress* address, const char* name);
+
+// The result of looking up an address
+typedef enum
+{
+	ResolveFailed = 0,
+	ResolvePending,
+	ResolveDone,
+}ResolveStatus;
+
+// a name we have looked up before, and when we have to look it up again
+typedef struct
+{
+	char Name[ResolveNameLength];
+	ENetAddress Address;
+	double Expires;
+}ResolvedAddress;
+
+// a lookup running on a worker thread, shared between the resolver and the thread
+typedef struct ResolveJob ResolveJob;
+
+// Everything needed to look up addresses for one client
+typedef struct
+{
+	// the function that does the lookup, enet_address_set_host (getaddrinfo, so /etc/hosts applies) unless it is replaced
+	ResolveHostFunction Resolve;
+
+	// how long in seconds a resolved address is kept before it is looked up again
+	double CacheTime;
+
+	// the names we have already looked up, an empty name is an unused entry
+	ResolvedAddress Cache[ResolveCacheSize];
+
+	// the lookup in progress, NULL if there isn't one
+	ResolveJob* Pending;
+}AddressResolver;
+
+/// <summary>
+/// Set up a resolver with an empty cache that uses enet_address_set_host for lookups
+/// </summary>
+/// <param name="resolver">The resolver to set up</param>
+/// <param name="cacheTime">How long in seconds to keep resolved addresses</param>
+void InitAddressResolver(AddressResolver* resolver, double cacheTime);
+
+/// <summary>
+/// Start looking up an address, any lookup that was already running is abandoned.
+/// Numeric addresses and names in the cache are done right away, anything else is handed to a worker thread
+/// </summary>
+/// <param name="resolver">The resolver to use</param>
+/// <param name="name">The host name or numeric address to look up</param>
+/// <param name="address">Where the address goes if it is done right away, the port is not changed</param>
+/// <returns>ResolveDone if the address is ready now, ResolvePending if it is being looked up, ResolveFailed if it could not be started</returns>
+ResolveStatus StartResolve(AddressResolver* resolver, const char* name, ENetAddress* address);
+
+/// <summary>
+/// Check if the lookup started by StartResolve has finished, this never waits.
+/// A successful lookup is added to the cache
+/// </summary>
+/// <param name="resolver">The resolver to check</param>
+/// <param name="address">Where the address goes when it is done, the port is not changed</param>
+/// <returns>ResolvePending while the lookup is running, then ResolveDone or ResolveFailed once</returns>
+ResolveStatus PollResolve(AddressResolver* resolver, ENetAddress* address);
+
+/// <summary>
+/// Abandon the lookup in progress if there is one, this does not wait for the worker thread, it cleans up after itself
+/// </summary>
+/// <param name="resolver">The resolver to cancel the lookup on</param>
+void CancelResolve(AddressResolver* resolver);
+
+/// <summary>
+/// Drop a name from the cache, so the next lookup goes to the resolver again.
+/// Used when the cached address did not answer, in case the server has moved
+/// </summary>
+/// <param name="resolver">The resolver with the cache</param>
+/// <param name="name">The name to forget</param>
+void ForgetResolvedAddress(AddressResolver* resolver, const char* name);
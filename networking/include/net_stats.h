@@ -0,0 +1,206 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// per peer network statistics
+// enet only keeps smoothed averages of round trip time and loss, which hide the occasional bad packet that players actually notice
+// so every peer also keeps histograms of each round trip time sample, the jitter between packets, and how many times reliable commands had to be resent
+// the histograms are log bucketed (like HdrHistogram) so they use a fixed amount of memory and stay within about 6% of the real value at any size
+// every peer, and the host as a whole, also counts the bytes it sends and receives by enet protocol command and by application message,
+// so we can see where the bandwidth goes, including enet's own overhead like headers, acknowledgements and pings
+// this header must not include enet.h, net_common.h includes it first so the enet stats hooks can be defined
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// values below this are counted exactly, above it each power of two is split in to this many buckets
+#define HistogramSubBuckets 16
+#define HistogramSubBucketBits 4
+
+// the largest value that gets its own bucket, anything bigger is counted in the last bucket (but still counts towards the max)
+#define HistogramMaxValue 65535
+#define HistogramBucketCount (HistogramSubBuckets + (16 - HistogramSubBucketBits) * HistogramSubBuckets)
+
+// a fixed size histogram of positive integer samples
+typedef struct
+{
+	uint32_t Count;
+	uint32_t Max;
+	uint64_t Sum;
+	uint32_t Buckets[HistogramBucketCount];
+}NetHistogram;
+
+// everything we track about one peer's connection
+typedef struct
+{
+	// round trip time in milliseconds, one sample for every acknowledgement received
+	NetHistogram RoundTrip;
+
+	// how much the time between the peer sending a packet and us getting it changed since the last packet, in milliseconds
+	NetHistogram Jitter;
+
+	// how many times each acknowledged reliable command was resent before it got through
+	NetHistogram Retransmits;
+
+	// the transit time of the last packet, in the peer's clock, used to work out jitter
+	uint16_t LastTransit;
+	bool HasTransit;
+}PeerStats;
+
+// one slot for each enet protocol command, and one for each possible application message command byte
+#define ProtocolCommandSlots 16
+#define MessageCommandSlots 256
+
+// how many of something went by, and how many bytes they took
+typedef struct
+{
+	uint64_t Count;
+	uint64_t Bytes;
+}TrafficCounter;
+
+// where the bytes sent to and received from a peer (or a whole host) went
+typedef struct
+{
+	// by enet protocol command (acknowledge, ping, send reliable and so on), including any message data the command carries
+	// these are counted before compression
+	TrafficCounter ProtocolSent[ProtocolCommandSlots];
+	TrafficCounter ProtocolReceived[ProtocolCommandSlots];
+
+	// the header at the start of every datagram
+	TrafficCounter HeadersSent;
+	TrafficCounter HeadersReceived;
+
+	// by application message, using the first byte of each message as the command
+	// these are only counted when the application calls CountMessageSent and CountMessageReceived
+	TrafficCounter MessagesSent[MessageCommandSlots];
+	TrafficCounter MessagesReceived[MessageCommandSlots];
+}PeerTraffic;
+
+typedef struct _ENetPeer ENetPeer;
+typedef struct _ENetHost ENetHost;
+typedef struct _ENetPacket ENetPacket;
+
+/// <summary>
+/// Add a sample to a histogram
+/// </summary>
+/// <param name="histogram">The histogram to add to</param>
+/// <param name="value">The value to count</param>
+void RecordHistogram(NetHistogram* histogram, uint32_t value);
+
+/// <summary>
+/// Get the value that the given percent of samples are at or below.
+/// The result is the top of the bucket the value lands in, so it errs on the high side
+/// </summary>
+/// <param name="histogram">The histogram to look in</param>
+/// <param name="percentile">The percentile to find, from 0 to 100</param>
+/// <returns>The value at that percentile, or 0 if there are no samples</returns>
+uint32_t GetHistogramPercentile(const NetHistogram* histogram, double percentile);
+
+/// <summary>
+/// Get the average of all the samples in a histogram
+/// </summary>
+/// <param name="histogram">The histogram to average</param>
+/// <returns>The mean value, or 0 if there are no samples</returns>
+double GetHistogramMean(const NetHistogram* histogram);
+
+/// <summary>
+/// Clear out all the samples in a set of peer stats
+/// </summary>
+/// <param name="stats">The stats to clear</param>
+void ResetPeerStats(PeerStats* stats);
+
+/// <summary>
+/// Record that a packet arrived from a peer, to work out jitter
+/// </summary>
+/// <param name="stats">The stats for the peer that sent the packet</param>
+/// <param name="sentTime">The time the peer sent the packet, in milliseconds on its own clock (enet only sends the low 16 bits)</param>
+/// <param name="receivedTime">The time we got the packet, in milliseconds</param>
+void RecordPeerArrival(PeerStats* stats, uint16_t sentTime, uint32_t receivedTime);
+
+/// <summary>
+/// Copy out the current stats for a peer, and optionally start collecting again from nothing
+/// </summary>
+/// <param name="peer">The peer to get the stats for</param>
+/// <param name="snapshot">Where to copy the stats</param>
+/// <param name="reset">True to clear the peer's stats after they are copied, so the next snapshot only has new samples</param>
+void SnapshotPeerStats(ENetPeer* peer, PeerStats* snapshot, bool reset);
+
+/// <summary>
+/// Count an enet protocol command going to or coming from a peer, in the peer's traffic and its host's.
+/// enet calls this itself
+/// </summary>
+/// <param name="peer">The peer the command was for or from</param>
+/// <param name="command">The enet protocol command number</param>
+/// <param name="bytes">The size of the command, including any data it carries</param>
+/// <param name="sent">True for a command we sent, false for one we received</param>
+void CountProtocolCommand(ENetPeer* peer, uint8_t command, size_t bytes, bool sent);
+
+/// <summary>
+/// Count a datagram header going to or coming from a peer. enet calls this itself
+/// </summary>
+/// <param name="peer">The peer the datagram was for or from</param>
+/// <param name="bytes">The size of the header</param>
+/// <param name="sent">True for a datagram we sent, false for one we received</param>
+void CountDatagramHeader(ENetPeer* peer, size_t bytes, bool sent);
+
+/// <summary>
+/// Count an application message being sent to a peer, by its command byte
+/// </summary>
+/// <param name="peer">The peer it is being sent to</param>
+/// <param name="message">The message, starting with its command byte</param>
+/// <param name="length">The size of the message</param>
+void CountMessageSent(ENetPeer* peer, const uint8_t* message, size_t length);
+
+/// <summary>
+/// Count an application message that was received from a peer, by its command byte
+/// </summary>
+/// <param name="peer">The peer it came from</param>
+/// <param name="message">The message, starting with its command byte</param>
+/// <param name="length">The size of the message</param>
+void CountMessageReceived(ENetPeer* peer, const uint8_t* message, size_t length);
+
+/// <summary>
+/// Get the name of an enet protocol command, for logs and metrics
+/// </summary>
+/// <param name="command">The enet protocol command number</param>
+/// <returns>The name of the command, or "unknown"</returns>
+const char* GetProtocolCommandName(uint8_t command);
+
+// collect the stats inside enet, every peer keeps its own PeerStats, and every peer and host keeps a PeerTraffic
+#define ENET_PEER_STATS_FIELDS PeerStats stats; PeerTraffic traffic;
+#define ENET_HOST_STATS_FIELDS PeerTraffic traffic;
+#define ENET_PEER_STATS_RESET(peer) do { ResetPeerStats(&(peer)->stats); memset(&(peer)->traffic, 0, sizeof(PeerTraffic)); } while (0)
+#define ENET_HOST_STATS_RESET(host) memset(&(host)->traffic, 0, sizeof(PeerTraffic))
+#define ENET_PEER_COMMAND_SENT(peer, command, bytes) CountProtocolCommand((peer), (command), (bytes), true)
+#define ENET_PEER_COMMAND_RECEIVED(peer, command, bytes) CountProtocolCommand((peer), (command), (bytes), false)
+#define ENET_PEER_HEADER_SENT(peer, bytes) CountDatagramHeader((peer), (bytes), true)
+#define ENET_PEER_HEADER_RECEIVED(peer, bytes) CountDatagramHeader((peer), (bytes), false)
+#define ENET_PEER_RTT_SAMPLE(peer, rtt) RecordHistogram(&(peer)->stats.RoundTrip, (rtt))
+#define ENET_PEER_ARRIVAL_SAMPLE(peer, sentTime, receivedTime) RecordPeerArrival(&(peer)->stats, (sentTime), (receivedTime))
+#define ENET_PEER_RETRANSMIT_SAMPLE(peer, retransmits) RecordHistogram(&(peer)->stats.Retransmits, (retransmits))
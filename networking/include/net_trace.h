@@ -0,0 +1,83 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// optional tracing of where time goes in the network code
+// build with NET_TRACE defined (premake --trace) to compile the trace points in, without it they are empty and cost nothing
+// even when compiled in, tracing starts off, and a disabled trace point is just a check of one bool
+// each thread writes to its own ring buffer, so tracing never locks, and the buffers can be written out in the Chrome trace format
+// (load the file in chrome://tracing or https://ui.perfetto.dev)
+// this header must not include enet.h, net_common.h includes it first so the enet trace hooks can be defined
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef NET_TRACE
+
+// true when trace points should record
+extern bool TraceEnabled;
+
+/// <summary>
+/// Record the start of a span on this thread, use TRACE_BEGIN instead of calling this directly
+/// </summary>
+/// <param name="name">The name of the span, this must be a string that lives forever, such as a literal</param>
+void TraceBegin(const char* name);
+
+/// <summary>
+/// Record the end of a span on this thread, use TRACE_END instead of calling this directly
+/// </summary>
+/// <param name="name">The name of the span, must match the name it was started with</param>
+void TraceEnd(const char* name);
+
+#define TRACE_BEGIN(name) do { if (TraceEnabled) TraceBegin(name); } while (0)
+#define TRACE_END(name) do { if (TraceEnabled) TraceEnd(name); } while (0)
+
+// trace the phases inside enet_host_service too
+#define ENET_TRACE_BEGIN(name) TRACE_BEGIN(name)
+#define ENET_TRACE_END(name) TRACE_END(name)
+
+#else
+
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+
+#endif
+
+/// <summary>
+/// Turn recording on or off. Does nothing if tracing is not compiled in
+/// </summary>
+/// <param name="enabled">True to start recording</param>
+void SetTraceEnabled(bool enabled);
+
+/// <summary>
+/// Write everything in the trace buffers to a Chrome trace JSON file.
+/// Only the most recent events in each thread's buffer are kept, older ones are overwritten
+/// </summary>
+/// <param name="path">The file to write</param>
+/// <returns>False if tracing is not compiled in or the file could not be written</returns>
+bool WriteChromeTrace(const char* path);
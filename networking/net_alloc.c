@@ -0,0 +1,164 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "net_common.h"
+#include "net_alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// every tracked block starts with a header that holds its size, so free knows how much is going away
+// the header is padded out to the strictest alignment, so the memory after it is aligned the same as plain malloc
+typedef union
+{
+	size_t Size;
+	max_align_t Align;
+}AllocHeader;
+
+static AllocCounters Counters = { 0 };
+static bool Tracking = false;
+
+static int GetAllocSizeClass(size_t size)
+{
+	int sizeClass = 0;
+	while (sizeClass < AllocSizeClassCount - 1 && size > GetAllocSizeClassLimit(sizeClass))
+		sizeClass++;
+
+	return sizeClass;
+}
+
+static void* ENET_CALLBACK TrackingMalloc(size_t size)
+{
+	AllocHeader* header = (AllocHeader*)malloc(sizeof(AllocHeader) + size);
+	if (header == NULL)
+		return NULL;
+
+	header->Size = size;
+
+	Counters.Allocations++;
+	Counters.BytesAllocated += size;
+	Counters.SizeClasses[GetAllocSizeClass(size)]++;
+
+	Counters.LiveAllocations++;
+	Counters.LiveBytes += size;
+	if (Counters.LiveAllocations > Counters.PeakLiveAllocations)
+		Counters.PeakLiveAllocations = Counters.LiveAllocations;
+	if (Counters.LiveBytes > Counters.PeakLiveBytes)
+		Counters.PeakLiveBytes = Counters.LiveBytes;
+
+	return header + 1;
+}
+
+static void ENET_CALLBACK TrackingFree(void* memory)
+{
+	if (memory == NULL)
+		return;
+
+	AllocHeader* header = (AllocHeader*)memory - 1;
+
+	Counters.Frees++;
+	Counters.BytesFreed += header->Size;
+	Counters.LiveAllocations--;
+	Counters.LiveBytes -= header->Size;
+
+	free(header);
+}
+
+int InitializeNetwork(bool trackAllocations)
+{
+	if (!trackAllocations)
+		return enet_initialize();
+
+	ENetCallbacks callbacks = { 0 };
+	callbacks.malloc = TrackingMalloc;
+	callbacks.free = TrackingFree;
+
+	int result = enet_initialize_with_callbacks(ENET_VERSION, &callbacks);
+	if (result == 0)
+		Tracking = true;
+
+	return result;
+}
+
+bool TrackingAllocations()
+{
+	return Tracking;
+}
+
+void GetAllocCounters(AllocCounters* counters)
+{
+	*counters = Counters;
+}
+
+size_t GetAllocSizeClassLimit(int sizeClass)
+{
+	if (sizeClass >= AllocSizeClassCount - 1)
+		return SIZE_MAX;
+
+	return (size_t)16 << sizeClass;
+}
+
+void BeginAllocTick(AllocTickTracker* tracker)
+{
+	tracker->StartAllocations = Counters.Allocations;
+	tracker->StartBytes = Counters.BytesAllocated;
+}
+
+uint64_t EndAllocTick(AllocTickTracker* tracker)
+{
+	uint64_t allocations = Counters.Allocations - tracker->StartAllocations;
+	uint64_t bytes = Counters.BytesAllocated - tracker->StartBytes;
+
+	tracker->Ticks++;
+	if (allocations == 0)
+		tracker->QuietTicks++;
+
+	tracker->Allocations += allocations;
+	tracker->Bytes += bytes;
+	tracker->LastAllocations = allocations;
+	tracker->LastBytes = bytes;
+
+	if (allocations > tracker->PeakAllocations)
+		tracker->PeakAllocations = allocations;
+	if (bytes > tracker->PeakBytes)
+		tracker->PeakBytes = bytes;
+
+	return allocations;
+}
+
+void ResetAllocTickTracker(AllocTickTracker* tracker)
+{
+	uint64_t startAllocations = tracker->StartAllocations;
+	uint64_t startBytes = tracker->StartBytes;
+
+	memset(tracker, 0, sizeof(AllocTickTracker));
+
+	// a tick might be in progress, so keep where it started
+	tracker->StartAllocations = startAllocations;
+	tracker->StartBytes = startBytes;
+}
@@ -0,0 +1,138 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "net_batch.h"
+
+#include <string.h>
+
+void ResetMessageBatch(MessageBatch* batch)
+{
+	batch->Length = 0;
+	batch->Count = 0;
+}
+
+size_t GetBatchedMessageCost(const MessageBatch* batch, size_t length)
+{
+	return length + 1 + (batch->Length == 0 ? 1 : 0);
+}
+
+bool BatchMessage(MessageBatch* batch, ENetPeer* peer, const void* message, size_t length)
+{
+	if (length < 1 || length > MaxBatchedMessage)
+		return false;
+
+	bool flushed = false;
+	if (batch->Length + GetBatchedMessageCost(batch, length) > MessageBatchCapacity)
+	{
+		FlushMessageBatch(batch, peer);
+		flushed = true;
+	}
+
+	if (batch->Length == 0)
+		batch->Data[batch->Length++] = (uint8_t)BatchedMessages;
+
+	batch->Data[batch->Length++] = (uint8_t)length;
+	memcpy(batch->Data + batch->Length, message, length);
+	batch->Length += length;
+	batch->Count++;
+
+	return flushed;
+}
+
+size_t FlushMessageBatch(MessageBatch* batch, ENetPeer* peer)
+{
+	if (batch->Length == 0)
+		return 0;
+
+	size_t length = batch->Length;
+	ENetPacket* packet = enet_packet_create(batch->Data, length, ENET_PACKET_FLAG_RELIABLE);
+	ResetMessageBatch(batch);
+
+	if (packet == NULL)
+		return 0;
+
+	// if the peer is gone enet doesn't take the packet, so we have to get rid of it
+	if (enet_peer_send(peer, 0, packet) != 0)
+	{
+		enet_packet_destroy(packet);
+		return 0;
+	}
+
+	return length;
+}
+
+int FlushMessageBatchLatest(MessageBatch* batch, ENetPeer* peer, uint32_t key)
+{
+	if (batch->Length == 0)
+		return -1;
+
+	ENetPacket* packet = enet_packet_create(batch->Data, batch->Length, ENET_PACKET_FLAG_RELIABLE);
+	ResetMessageBatch(batch);
+
+	if (packet == NULL)
+		return -1;
+
+	int result = enet_peer_send_latest(peer, 0, packet, key);
+	if (result < 0)
+		enet_packet_destroy(packet);
+
+	return result;
+}
+
+void BeginReadMessages(MessageReader* reader, ENetPacket* packet)
+{
+	reader->Packet = packet;
+	reader->Batched = packet->dataLength > 0 && packet->data[0] == BatchedMessages;
+	reader->Next = reader->Batched ? 1 : 0;
+}
+
+size_t ReadNextMessage(MessageReader* reader, size_t* offset)
+{
+	size_t dataLength = reader->Packet->dataLength;
+	if (reader->Next >= dataLength)
+		return 0;
+
+	// a plain packet is just the one message
+	if (!reader->Batched)
+	{
+		*offset = 0;
+		reader->Next = dataLength;
+		return dataLength;
+	}
+
+	size_t length = reader->Packet->data[reader->Next];
+	if (length == 0 || reader->Next + 1 + length > dataLength)
+	{
+		reader->Next = dataLength;
+		return 0;
+	}
+
+	*offset = reader->Next + 1;
+	reader->Next += 1 + length;
+	return length;
+}
@@ -0,0 +1,249 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "net_capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the file starts with a magic number and version, then has one record per datagram
+// each record is the time since the last datagram in microseconds (4 bytes), the host's enet clock (4 bytes), the sender number (2 bytes) and the length (2 bytes), then the data
+// the first time a sender is seen, its address (16 byte host and 2 byte port) comes between the record header and the data
+// everything is written in host byte order, like the rest of the sample
+#define CaptureMagic 0x50414352 // "RCAP"
+#define CaptureVersion 2
+
+// how often in seconds the capture file is flushed
+#define CaptureFlushInterval 1.0
+
+typedef struct
+{
+	uint32_t Delta;
+	uint32_t ServiceTime;
+	uint16_t Source;
+	uint16_t Length;
+}CaptureRecord;
+
+struct CaptureReader
+{
+	FILE* File;
+	double Time;
+	uint16_t SourceCount;
+	ENetAddress Sources[CaptureMaxSources];
+};
+
+// there is only one capture running at a time, the intercept callback has no way to pass in anything but the host
+static struct
+{
+	FILE* File;
+	ENetHost* Host;
+	double LastTime;
+	double LastFlush;
+	uint16_t SourceCount;
+	ENetAddress Sources[CaptureMaxSources];
+}Capture = { 0 };
+
+static bool WriteCaptureHeader(FILE* file)
+{
+	uint32_t header[2] = { CaptureMagic, CaptureVersion };
+	return fwrite(header, sizeof(header), 1, file) == 1;
+}
+
+// find the number for a sender, or give it the next one
+// the list is searched in order, captures are of game servers with a handful of players, so this is short
+static int GetCaptureSource(const ENetAddress* address, bool* isNew)
+{
+	*isNew = false;
+	for (int i = 0; i < Capture.SourceCount; i++)
+	{
+		if (Capture.Sources[i].port == address->port && memcmp(&Capture.Sources[i].host, &address->host, sizeof(address->host)) == 0)
+			return i;
+	}
+
+	if (Capture.SourceCount == CaptureMaxSources)
+		return -1;
+
+	*isNew = true;
+	Capture.Sources[Capture.SourceCount] = *address;
+	return Capture.SourceCount++;
+}
+
+// called by enet for every datagram the host receives, before enet looks at it
+static int ENET_CALLBACK CaptureIntercept(ENetHost* host, void* event)
+{
+	(void)event;
+
+	if (Capture.File == NULL || host != Capture.Host)
+		return 0;
+
+	bool isNew = false;
+	int source = GetCaptureSource(&host->receivedAddress, &isNew);
+	if (source < 0)
+		return 0;
+
+	double now = GetPreciseTime();
+	double delta = (now - Capture.LastTime) * 1000000.0;
+	Capture.LastTime = now;
+
+	CaptureRecord record = { 0 };
+	record.Delta = delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+	record.ServiceTime = host->serviceTime;
+	record.Source = (uint16_t)source;
+	record.Length = (uint16_t)host->receivedDataLength;
+
+	fwrite(&record, sizeof(record), 1, Capture.File);
+	if (isNew)
+	{
+		fwrite(&host->receivedAddress.host, sizeof(host->receivedAddress.host), 1, Capture.File);
+		fwrite(&host->receivedAddress.port, sizeof(host->receivedAddress.port), 1, Capture.File);
+	}
+	fwrite(host->receivedData, 1, host->receivedDataLength, Capture.File);
+
+	// let enet handle the datagram like normal
+	return 0;
+}
+
+bool StartCapture(ENetHost* host, const char* path)
+{
+	if (Capture.File != NULL)
+		return false;
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+
+	if (!WriteCaptureHeader(file))
+	{
+		fclose(file);
+		return false;
+	}
+
+	Capture.File = file;
+	Capture.Host = host;
+	Capture.LastTime = GetPreciseTime();
+	Capture.LastFlush = Capture.LastTime;
+	Capture.SourceCount = 0;
+
+	enet_host_set_intercept(host, CaptureIntercept);
+	return true;
+}
+
+void FlushCapture()
+{
+	if (Capture.File == NULL)
+		return;
+
+	double now = GetPreciseTime();
+	if (now - Capture.LastFlush < CaptureFlushInterval)
+		return;
+
+	fflush(Capture.File);
+	Capture.LastFlush = now;
+}
+
+void StopCapture()
+{
+	if (Capture.File == NULL)
+		return;
+
+	enet_host_set_intercept(Capture.Host, NULL);
+	fclose(Capture.File);
+	Capture.File = NULL;
+	Capture.Host = NULL;
+}
+
+CaptureReader* OpenCapture(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return NULL;
+
+	uint32_t header[2] = { 0 };
+	if (fread(header, sizeof(header), 1, file) != 1 || header[0] != CaptureMagic || header[1] != CaptureVersion)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	CaptureReader* reader = (CaptureReader*)calloc(1, sizeof(CaptureReader));
+	if (reader == NULL)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	reader->File = file;
+	return reader;
+}
+
+bool ReadCapturedDatagram(CaptureReader* reader, CapturedDatagram* datagram)
+{
+	CaptureRecord record = { 0 };
+	if (fread(&record, sizeof(record), 1, reader->File) != 1)
+		return false;
+
+	// senders are numbered in order, so a new one is always the next number
+	if (record.Source > reader->SourceCount || record.Length > CaptureMaxDatagram)
+		return false;
+
+	if (record.Source == reader->SourceCount)
+	{
+		if (reader->SourceCount == CaptureMaxSources)
+			return false;
+
+		ENetAddress* address = &reader->Sources[reader->SourceCount];
+		memset(address, 0, sizeof(ENetAddress));
+		if (fread(&address->host, sizeof(address->host), 1, reader->File) != 1 || fread(&address->port, sizeof(address->port), 1, reader->File) != 1)
+			return false;
+
+		reader->SourceCount++;
+	}
+
+	if (fread(datagram->Data, 1, record.Length, reader->File) != record.Length)
+		return false;
+
+	reader->Time += record.Delta / 1000000.0;
+
+	datagram->Time = reader->Time;
+	datagram->ServiceTime = record.ServiceTime;
+	datagram->Source = record.Source;
+	datagram->Address = reader->Sources[record.Source];
+	datagram->Length = record.Length;
+	return true;
+}
+
+void CloseCapture(CaptureReader* reader)
+{
+	if (reader == NULL)
+		return;
+
+	fclose(reader->File);
+	free(reader);
+}
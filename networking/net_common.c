@@ -28,6 +28,8 @@
 
 #include "net_common.h"
 
+#include <string.h>
+
 
 // Utility functions to read data out of a packet
 // Optimally this would go into a library that was shared by the client and the server
@@ -80,3 +82,93 @@ int16_t ReadShort(ENetPacket* packet, size_t* offset)
 	// cast the data pointer to a short and return a copy
 	return *(int16_t*)data;
 }
+
+/// <summary>
+/// Read a signed 32 bit int from the network packet, in the host's byte ordering like ReadShort
+/// </summary>
+/// <param name="packet">The packet to read from</param>
+/// <param name="offset">A pointer to an offset that is updated, this should be passed to other read functions so they read from the correct place</param>
+/// <returns>The int that is read, 0 if there isn't a whole int left in the packet</returns>
+int32_t ReadInt(ENetPacket* packet, size_t* offset)
+{
+	// make sure the whole int is in the data we were sent
+	if (*offset + sizeof(int32_t) > packet->dataLength)
+		return 0;
+
+	// copy it out, it may not be lined up on a 4 byte boundary
+	int32_t data = 0;
+	memcpy(&data, packet->data + *offset, sizeof(data));
+
+	// move the offset over 4 bytes for the next read
+	*offset = (*offset) + sizeof(data);
+
+	return data;
+}
+
+/// <summary>
+/// Get a readable name for a network command, for logs and stats
+/// </summary>
+/// <param name="command">The command byte from a packet</param>
+/// <returns>The name of the command, or "Unknown" if it is not one we know about</returns>
+const char* GetCommandName(uint8_t command)
+{
+	switch ((NetworkCommands)command)
+	{
+	case AcceptPlayer:
+		return "AcceptPlayer";
+	case AddPlayer:
+		return "AddPlayer";
+	case RemovePlayer:
+		return "RemovePlayer";
+	case UpdatePlayer:
+		return "UpdatePlayer";
+	case UpdateInput:
+		return "UpdateInput";
+	case BatchedMessages:
+		return "BatchedMessages";
+	case JoinSnapshot:
+		return "JoinSnapshot";
+	case ResumeSession:
+		return "ResumeSession";
+	case InputTrace:
+		return "InputTrace";
+	}
+
+	return "Unknown";
+}
+
+/// <summary>
+/// Get the time from a high resolution clock, for timing code.
+/// enet_time_get only counts in milliseconds, which is too coarse to time one server tick
+/// </summary>
+/// <returns>The current time in seconds, from an arbitrary starting point</returns>
+double GetPreciseTime()
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1000000000.0;
+#endif
+}
+
+/// <summary>
+/// Turn a time in seconds into the two byte units input traces are sent in, see InputTraceUnitsPerSecond
+/// </summary>
+/// <param name="seconds">The time to pack, negative times are 0</param>
+/// <returns>The time in input trace units, capped at the largest two byte value</returns>
+uint16_t PackTraceTime(double seconds)
+{
+	double units = seconds * InputTraceUnitsPerSecond + 0.5;
+	if (units <= 0)
+		return 0;
+
+	if (units >= UINT16_MAX)
+		return UINT16_MAX;
+
+	return (uint16_t)units;
+}
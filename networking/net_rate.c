@@ -0,0 +1,233 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "net_rate.h"
+
+#include <string.h>
+
+// how much we slow down when the link is congested, and how much we speed up per adjustment when it is healthy
+// backing off fast and recovering slowly keeps us from filling up the link again right after it drains
+#define RateBackoffScale 1.5
+#define RateRecoverStep 0.002
+
+RateControlConfig DefaultRateControlConfig()
+{
+	RateControlConfig config = { 0 };
+	config.MinInterval = 1.0 / 60.0;
+	config.MaxInterval = 1.0 / 10.0;
+	config.MaxQueueDelay = 100;
+	config.MaxLoss = ENET_PEER_PACKET_LOSS_SCALE / 20;	// 5%
+	config.MaxBacklog = 8 * 1024;
+	config.MinDetail = 1;
+	config.MaxDetail = MAX_PLAYERS;
+	config.AdjustPeriod = 0.25;
+
+	return config;
+}
+
+void InitRateControl(RateControl* rate, const RateControlConfig* config)
+{
+	rate->Interval = config->MinInterval;
+	rate->Detail = config->MaxDetail;
+	rate->LastSend = -100;
+	rate->LastAdjust = -100;
+	rate->BaseRTT = 0;
+}
+
+void UpdateRateControlSample(RateControl* rate, const RateControlConfig* config, double now, uint32_t rtt, uint32_t loss, size_t backlog)
+{
+	// remember the best round trip we have seen, anything above that is time spent sitting in a queue somewhere
+	if (rtt > 0 && (rate->BaseRTT == 0 || rtt < rate->BaseRTT))
+		rate->BaseRTT = rtt;
+
+	if (now - rate->LastAdjust < config->AdjustPeriod)
+		return;
+
+	rate->LastAdjust = now;
+
+	uint32_t queueDelay = rtt > rate->BaseRTT ? rtt - rate->BaseRTT : 0;
+
+	bool congested = queueDelay > config->MaxQueueDelay || loss > config->MaxLoss || backlog > config->MaxBacklog;
+
+	// only speed back up when we are well clear of all the limits
+	bool healthy = queueDelay < config->MaxQueueDelay / 2 && loss < config->MaxLoss / 2 && backlog < config->MaxBacklog / 4;
+
+	if (congested)
+	{
+		rate->Interval *= RateBackoffScale;
+		rate->Detail /= 2;
+	}
+	else if (healthy)
+	{
+		rate->Interval -= RateRecoverStep;
+		rate->Detail++;
+	}
+
+	// stay inside the bounds we were given
+	if (rate->Interval < config->MinInterval)
+		rate->Interval = config->MinInterval;
+
+	if (rate->Interval > config->MaxInterval)
+		rate->Interval = config->MaxInterval;
+
+	if (rate->Detail < config->MinDetail)
+		rate->Detail = config->MinDetail;
+
+	if (rate->Detail > config->MaxDetail)
+		rate->Detail = config->MaxDetail;
+}
+
+void UpdateRateControl(RateControl* rate, const RateControlConfig* config, double now, ENetPeer* peer)
+{
+	UpdateRateControlSample(rate, config, now, enet_peer_get_rtt(peer), peer->packetLoss, GetPeerOutgoingBacklog(peer));
+}
+
+bool RateControlShouldSend(RateControl* rate, double now)
+{
+	if (now - rate->LastSend < rate->Interval)
+		return false;
+
+	rate->LastSend = now;
+	return true;
+}
+
+size_t GetPeerOutgoingBacklog(ENetPeer* peer)
+{
+	// data that is on the wire but not acknowledged yet
+	size_t backlog = peer->reliableDataInTransit;
+
+	// and data that enet has not even tried to send yet
+	for (ENetListIterator node = enet_list_begin(&peer->outgoingReliableCommands); node != enet_list_end(&peer->outgoingReliableCommands); node = enet_list_next(node))
+		backlog += ((ENetOutgoingCommand*)node)->fragmentLength;
+
+	for (ENetListIterator node = enet_list_begin(&peer->outgoingUnreliableCommands); node != enet_list_end(&peer->outgoingUnreliableCommands); node = enet_list_next(node))
+		backlog += ((ENetOutgoingCommand*)node)->fragmentLength;
+
+	return backlog;
+}
+
+void GetPeerBackpressure(ENetPeer* peer, PeerBackpressure* pressure)
+{
+	memset(pressure, 0, sizeof(PeerBackpressure));
+
+	enet_uint32 now = enet_time_get();
+	enet_uint32 oldest = 0;
+
+	for (ENetListIterator node = enet_list_begin(&peer->outgoingReliableCommands); node != enet_list_end(&peer->outgoingReliableCommands); node = enet_list_next(node))
+	{
+		pressure->QueuedBytes += ((ENetOutgoingCommand*)node)->fragmentLength;
+		pressure->QueuedCommands++;
+		oldest = ENET_MAX(oldest, ENET_TIME_DIFFERENCE(now, ((ENetOutgoingCommand*)node)->queueTime));
+	}
+
+	for (ENetListIterator node = enet_list_begin(&peer->outgoingUnreliableCommands); node != enet_list_end(&peer->outgoingUnreliableCommands); node = enet_list_next(node))
+	{
+		pressure->QueuedBytes += ((ENetOutgoingCommand*)node)->fragmentLength;
+		pressure->QueuedCommands++;
+		oldest = ENET_MAX(oldest, ENET_TIME_DIFFERENCE(now, ((ENetOutgoingCommand*)node)->queueTime));
+	}
+
+	// sent commands are only let go once they are acknowledged, resends go back on the outgoing list and keep their queue time
+	for (ENetListIterator node = enet_list_begin(&peer->sentReliableCommands); node != enet_list_end(&peer->sentReliableCommands); node = enet_list_next(node))
+	{
+		pressure->InTransitCommands++;
+		oldest = ENET_MAX(oldest, ENET_TIME_DIFFERENCE(now, ((ENetOutgoingCommand*)node)->queueTime));
+	}
+
+	pressure->InTransitBytes = peer->reliableDataInTransit;
+	pressure->OldestWait = oldest / 1000.0;
+
+	// this is the same window enet checks before it sends anything reliable, it always lets at least one datagram through
+	size_t window = (size_t)peer->packetThrottle * peer->windowSize / ENET_PEER_PACKET_THROTTLE_SCALE;
+	if (window < peer->mtu)
+		window = peer->mtu;
+
+	uint32_t rtt = peer->roundTripTime > 0 ? peer->roundTripTime : 1;
+	pressure->DrainTime = (double)(pressure->QueuedBytes + pressure->InTransitBytes) / window * rtt / 1000.0;
+}
+
+BackpressureConfig DefaultBackpressureConfig()
+{
+	BackpressureConfig config = { 0 };
+
+	// a quarter of what the rate controller allows, about where it stops calling the connection healthy
+	config.LatestOnlyBacklog = 2048;
+
+	config.ReducedDelay = 1.0;
+	config.ReducedInterval = 0.25;
+	config.SlowTimeout = 10.0;
+	config.MaxBacklog = 256 * 1024;
+
+	return config;
+}
+
+void InitBackpressure(BackpressureControl* control)
+{
+	memset(control, 0, sizeof(BackpressureControl));
+	control->SlowSince = -1;
+	control->LastSend = -100;
+}
+
+BackpressureLevel UpdateBackpressure(BackpressureControl* control, const BackpressureConfig* config, double now, ENetPeer* peer)
+{
+	PeerBackpressure* pressure = &control->Last;
+	GetPeerBackpressure(peer, pressure);
+
+	size_t backlog = pressure->QueuedBytes + pressure->InTransitBytes;
+
+	// a peer that is slow to drain, or has stopped answering, goes reduced, and only comes back once it is well clear, so it doesn't flip every update
+	bool slow = pressure->DrainTime > config->ReducedDelay || pressure->OldestWait > config->ReducedDelay;
+	bool clear = pressure->DrainTime < config->ReducedDelay / 2 && pressure->OldestWait < config->ReducedDelay / 2;
+
+	if (slow && control->SlowSince < 0)
+		control->SlowSince = now;
+	else if (clear)
+		control->SlowSince = -1;
+
+	if (backlog > config->MaxBacklog || (control->SlowSince >= 0 && now - control->SlowSince >= config->SlowTimeout))
+		control->Level = BackpressureDisconnect;
+	else if (control->SlowSince >= 0)
+		control->Level = BackpressureReduced;
+	else if (backlog > config->LatestOnlyBacklog)
+		control->Level = BackpressureLatestOnly;
+	else
+		control->Level = BackpressureNone;
+
+	return control->Level;
+}
+
+bool BackpressureShouldSend(const BackpressureControl* control, const BackpressureConfig* config, double now)
+{
+	return control->Level < BackpressureReduced || now - control->LastSend >= config->ReducedInterval;
+}
+
+void BackpressureMarkSent(BackpressureControl* control, double now)
+{
+	control->LastSend = now;
+}
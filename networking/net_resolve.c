@@ -0,0 +1,291 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "net_resolve.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// a lookup that is shared between the resolver and the worker thread doing it
+// whichever of them lets go of it last frees it, so the resolver can walk away from a slow lookup without waiting
+struct ResolveJob
+{
+#ifdef _WIN32
+	CRITICAL_SECTION Lock;
+#else
+	pthread_mutex_t Lock;
+#endif
+
+	// how many of the resolver and the thread still have hold of this
+	int References;
+
+	bool Finished;
+	bool Succeeded;
+
+	ResolveHostFunction Resolve;
+	ENetAddress Address;
+	char Name[ResolveNameLength];
+};
+
+static void LockJob(ResolveJob* job)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&job->Lock);
+#else
+	pthread_mutex_lock(&job->Lock);
+#endif
+}
+
+static void UnlockJob(ResolveJob* job)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&job->Lock);
+#else
+	pthread_mutex_unlock(&job->Lock);
+#endif
+}
+
+// let go of a job, and free it if nobody else has it
+static void ReleaseJob(ResolveJob* job)
+{
+	LockJob(job);
+	bool last = --job->References == 0;
+	UnlockJob(job);
+
+	if (!last)
+		return;
+
+#ifdef _WIN32
+	DeleteCriticalSection(&job->Lock);
+#else
+	pthread_mutex_destroy(&job->Lock);
+#endif
+	free(job);
+}
+
+// do the lookup, the name and function are never changed after the thread starts so they don't need the lock
+static void RunJob(ResolveJob* job)
+{
+	ENetAddress address = { 0 };
+	bool succeeded = job->Resolve(&address, job->Name) == 0;
+
+	LockJob(job);
+	job->Address = address;
+	job->Succeeded = succeeded;
+	job->Finished = true;
+	UnlockJob(job);
+
+	ReleaseJob(job);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI ResolveThread(LPVOID context)
+{
+	RunJob((ResolveJob*)context);
+	return 0;
+}
+#else
+static void* ResolveThread(void* context)
+{
+	RunJob((ResolveJob*)context);
+	return NULL;
+}
+#endif
+
+// start a thread to run the job, it is detached since nobody ever waits on it
+static bool StartJobThread(ResolveJob* job)
+{
+#ifdef _WIN32
+	HANDLE thread = CreateThread(NULL, 0, ResolveThread, job, 0, NULL);
+	if (thread == NULL)
+		return false;
+
+	CloseHandle(thread);
+	return true;
+#else
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, ResolveThread, job) != 0)
+		return false;
+
+	pthread_detach(thread);
+	return true;
+#endif
+}
+
+static ResolvedAddress* FindCachedAddress(AddressResolver* resolver, const char* name, double now)
+{
+	for (int i = 0; i < ResolveCacheSize; i++)
+	{
+		ResolvedAddress* entry = &resolver->Cache[i];
+		if (entry->Name[0] != '\0' && entry->Expires > now && strcmp(entry->Name, name) == 0)
+			return entry;
+	}
+
+	return NULL;
+}
+
+// remember an address, reusing the entry for the same name, then an expired one, then the one closest to expiring
+static void CacheAddress(AddressResolver* resolver, const char* name, const ENetAddress* address, double now)
+{
+	ResolvedAddress* slot = NULL;
+	for (int i = 0; i < ResolveCacheSize; i++)
+	{
+		ResolvedAddress* entry = &resolver->Cache[i];
+		if (strcmp(entry->Name, name) == 0)
+		{
+			slot = entry;
+			break;
+		}
+
+		if (slot == NULL || (slot->Expires > now && entry->Expires < slot->Expires))
+			slot = entry;
+	}
+
+	strcpy(slot->Name, name);
+	slot->Address = *address;
+	slot->Expires = now + resolver->CacheTime;
+}
+
+void InitAddressResolver(AddressResolver* resolver, double cacheTime)
+{
+	memset(resolver, 0, sizeof(AddressResolver));
+	resolver->Resolve = enet_address_set_host;
+	resolver->CacheTime = cacheTime;
+}
+
+ResolveStatus StartResolve(AddressResolver* resolver, const char* name, ENetAddress* address)
+{
+	CancelResolve(resolver);
+
+	if (name == NULL || strlen(name) >= ResolveNameLength)
+		return ResolveFailed;
+
+	// numbers don't need a lookup, this never goes to DNS
+	ENetAddress numeric = { 0 };
+	if (enet_address_set_host_ip_new(&numeric, name) == 0)
+	{
+		address->host = numeric.host;
+		address->sin6_scope_id = numeric.sin6_scope_id;
+		return ResolveDone;
+	}
+
+	double now = GetPreciseTime();
+	ResolvedAddress* cached = FindCachedAddress(resolver, name, now);
+	if (cached != NULL)
+	{
+		address->host = cached->Address.host;
+		address->sin6_scope_id = cached->Address.sin6_scope_id;
+		return ResolveDone;
+	}
+
+	ResolveJob* job = (ResolveJob*)calloc(1, sizeof(ResolveJob));
+	if (job == NULL)
+		return ResolveFailed;
+
+#ifdef _WIN32
+	InitializeCriticalSection(&job->Lock);
+#else
+	pthread_mutex_init(&job->Lock, NULL);
+#endif
+	job->Resolve = resolver->Resolve;
+	strcpy(job->Name, name);
+
+	// one reference for us and one for the thread
+	job->References = 2;
+	if (!StartJobThread(job))
+	{
+		// no thread, so do it here, it is better to stall than to not connect at all
+		job->References = 1;
+		ReleaseJob(job);
+
+		ENetAddress resolved = { 0 };
+		if (resolver->Resolve(&resolved, name) != 0)
+			return ResolveFailed;
+
+		CacheAddress(resolver, name, &resolved, now);
+		address->host = resolved.host;
+		address->sin6_scope_id = resolved.sin6_scope_id;
+		return ResolveDone;
+	}
+
+	resolver->Pending = job;
+	return ResolvePending;
+}
+
+ResolveStatus PollResolve(AddressResolver* resolver, ENetAddress* address)
+{
+	ResolveJob* job = resolver->Pending;
+	if (job == NULL)
+		return ResolveFailed;
+
+	LockJob(job);
+	bool finished = job->Finished;
+	bool succeeded = job->Succeeded;
+	ENetAddress resolved = job->Address;
+	UnlockJob(job);
+
+	if (!finished)
+		return ResolvePending;
+
+	if (succeeded)
+	{
+		CacheAddress(resolver, job->Name, &resolved, GetPreciseTime());
+		address->host = resolved.host;
+		address->sin6_scope_id = resolved.sin6_scope_id;
+	}
+
+	resolver->Pending = NULL;
+	ReleaseJob(job);
+
+	return succeeded ? ResolveDone : ResolveFailed;
+}
+
+void CancelResolve(AddressResolver* resolver)
+{
+	if (resolver->Pending == NULL)
+		return;
+
+	ReleaseJob(resolver->Pending);
+	resolver->Pending = NULL;
+}
+
+void ForgetResolvedAddress(AddressResolver* resolver, const char* name)
+{
+	if (name == NULL)
+		return;
+
+	for (int i = 0; i < ResolveCacheSize; i++)
+	{
+		if (strcmp(resolver->Cache[i].Name, name) == 0)
+			resolver->Cache[i].Name[0] = '\0';
+	}
+}
@@ -0,0 +1,225 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "net_common.h"
+
+#include <string.h>
+
+// find the bucket a value is counted in
+// small values get a bucket each, bigger ones share a bucket with values that are within 1/16th of them
+static int GetHistogramBucket(uint32_t value)
+{
+	if (value > HistogramMaxValue)
+		value = HistogramMaxValue;
+
+	if (value < HistogramSubBuckets)
+		return (int)value;
+
+	// the highest set bit says which power of two the value is in, the next few bits say where in that power of two it is
+	int highBit = 31;
+	while (!(value & (1u << highBit)))
+		highBit--;
+
+	int shift = highBit - HistogramSubBucketBits;
+	return HistogramSubBuckets + shift * HistogramSubBuckets + (int)((value >> shift) & (HistogramSubBuckets - 1));
+}
+
+// the largest value that is counted in a bucket
+static uint32_t GetHistogramBucketTop(int bucket)
+{
+	if (bucket < HistogramSubBuckets)
+		return (uint32_t)bucket;
+
+	int shift = (bucket - HistogramSubBuckets) / HistogramSubBuckets;
+	uint32_t subBucket = (uint32_t)((bucket - HistogramSubBuckets) % HistogramSubBuckets);
+	uint32_t bottom = (HistogramSubBuckets + subBucket) << shift;
+	return bottom + (1u << shift) - 1;
+}
+
+void RecordHistogram(NetHistogram* histogram, uint32_t value)
+{
+	histogram->Buckets[GetHistogramBucket(value)]++;
+	histogram->Count++;
+	histogram->Sum += value;
+	if (value > histogram->Max)
+		histogram->Max = value;
+}
+
+uint32_t GetHistogramPercentile(const NetHistogram* histogram, double percentile)
+{
+	if (histogram->Count == 0)
+		return 0;
+
+	if (percentile < 0)
+		percentile = 0;
+	if (percentile > 100)
+		percentile = 100;
+
+	// the number of samples that have to be at or below the value, always at least one so p0 is the smallest sample
+	uint64_t wanted = (uint64_t)(histogram->Count * (percentile / 100.0) + 0.5);
+	if (wanted < 1)
+		wanted = 1;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < HistogramBucketCount; i++)
+	{
+		seen += histogram->Buckets[i];
+		if (seen >= wanted)
+		{
+			// the top of the bucket can be past anything we actually saw
+			uint32_t top = GetHistogramBucketTop(i);
+			return top < histogram->Max ? top : histogram->Max;
+		}
+	}
+
+	return histogram->Max;
+}
+
+double GetHistogramMean(const NetHistogram* histogram)
+{
+	if (histogram->Count == 0)
+		return 0;
+
+	return (double)histogram->Sum / histogram->Count;
+}
+
+void ResetPeerStats(PeerStats* stats)
+{
+	memset(stats, 0, sizeof(PeerStats));
+}
+
+void RecordPeerArrival(PeerStats* stats, uint16_t sentTime, uint32_t receivedTime)
+{
+	// the two clocks don't match, so the transit time is off by some fixed amount, but the change in it from one packet to the next is real (RFC 3550 style)
+	// enet only sends 16 bits of the sent time, so do all of this in 16 bits and let it wrap
+	uint16_t transit = (uint16_t)((uint16_t)receivedTime - sentTime);
+
+	if (stats->HasTransit)
+	{
+		int16_t change = (int16_t)(transit - stats->LastTransit);
+		RecordHistogram(&stats->Jitter, (uint32_t)(change < 0 ? -change : change));
+	}
+
+	stats->LastTransit = transit;
+	stats->HasTransit = true;
+}
+
+void SnapshotPeerStats(ENetPeer* peer, PeerStats* snapshot, bool reset)
+{
+	*snapshot = peer->stats;
+
+	if (reset)
+	{
+		// keep the last transit time so the first jitter sample after a reset still has something to compare to
+		uint16_t lastTransit = peer->stats.LastTransit;
+		bool hasTransit = peer->stats.HasTransit;
+		ResetPeerStats(&peer->stats);
+		peer->stats.LastTransit = lastTransit;
+		peer->stats.HasTransit = hasTransit;
+	}
+}
+
+// add to a counter for the peer and the same one for the whole host
+static void CountTraffic(TrafficCounter* peerCounter, TrafficCounter* hostCounter, size_t bytes)
+{
+	peerCounter->Count++;
+	peerCounter->Bytes += bytes;
+	hostCounter->Count++;
+	hostCounter->Bytes += bytes;
+}
+
+void CountProtocolCommand(ENetPeer* peer, uint8_t command, size_t bytes, bool sent)
+{
+	command &= ProtocolCommandSlots - 1;
+	if (sent)
+		CountTraffic(&peer->traffic.ProtocolSent[command], &peer->host->traffic.ProtocolSent[command], bytes);
+	else
+		CountTraffic(&peer->traffic.ProtocolReceived[command], &peer->host->traffic.ProtocolReceived[command], bytes);
+}
+
+void CountDatagramHeader(ENetPeer* peer, size_t bytes, bool sent)
+{
+	if (sent)
+		CountTraffic(&peer->traffic.HeadersSent, &peer->host->traffic.HeadersSent, bytes);
+	else
+		CountTraffic(&peer->traffic.HeadersReceived, &peer->host->traffic.HeadersReceived, bytes);
+}
+
+void CountMessageSent(ENetPeer* peer, const uint8_t* message, size_t length)
+{
+	if (length < 1)
+		return;
+
+	uint8_t command = message[0];
+	CountTraffic(&peer->traffic.MessagesSent[command], &peer->host->traffic.MessagesSent[command], length);
+}
+
+void CountMessageReceived(ENetPeer* peer, const uint8_t* message, size_t length)
+{
+	if (length < 1)
+		return;
+
+	uint8_t command = message[0];
+	CountTraffic(&peer->traffic.MessagesReceived[command], &peer->host->traffic.MessagesReceived[command], length);
+}
+
+const char* GetProtocolCommandName(uint8_t command)
+{
+	switch (command)
+	{
+	case ENET_PROTOCOL_COMMAND_ACKNOWLEDGE:
+		return "acknowledge";
+	case ENET_PROTOCOL_COMMAND_CONNECT:
+		return "connect";
+	case ENET_PROTOCOL_COMMAND_VERIFY_CONNECT:
+		return "verify_connect";
+	case ENET_PROTOCOL_COMMAND_DISCONNECT:
+		return "disconnect";
+	case ENET_PROTOCOL_COMMAND_PING:
+		return "ping";
+	case ENET_PROTOCOL_COMMAND_SEND_RELIABLE:
+		return "send_reliable";
+	case ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE:
+		return "send_unreliable";
+	case ENET_PROTOCOL_COMMAND_SEND_FRAGMENT:
+		return "send_fragment";
+	case ENET_PROTOCOL_COMMAND_SEND_UNSEQUENCED:
+		return "send_unsequenced";
+	case ENET_PROTOCOL_COMMAND_BANDWIDTH_LIMIT:
+		return "bandwidth_limit";
+	case ENET_PROTOCOL_COMMAND_THROTTLE_CONFIGURE:
+		return "throttle_configure";
+	case ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE_FRAGMENT:
+		return "send_unreliable_fragment";
+	case ENET_PROTOCOL_COMMAND_CONNECT_COOKIE:
+		return "connect_cookie";
+	default:
+		return "unknown";
+	}
+}
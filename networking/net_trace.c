@@ -0,0 +1,170 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "net_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef NET_TRACE
+
+// how many threads can trace, and how many events each one keeps
+#define TraceMaxThreads 32
+#define TraceBufferEvents (64 * 1024)
+
+#if defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+// one begin or end of a span
+typedef struct
+{
+	const char* Name;
+	double Time;
+	char Phase;
+}TraceEvent;
+
+// the ring buffer for one thread, only that thread ever writes to it
+typedef struct
+{
+	int ThreadIndex;
+	uint64_t Written;
+	TraceEvent Events[TraceBufferEvents];
+}TraceBuffer;
+
+bool TraceEnabled = false;
+
+static TraceBuffer* TraceBuffers[TraceMaxThreads] = { 0 };
+static volatile long TraceBufferCount = 0;
+
+// the buffer for the current thread, made the first time the thread records something
+static TRACE_THREAD_LOCAL TraceBuffer* ThreadTrace = NULL;
+
+// give this thread a buffer, this is the only place that needs to coordinate with other threads
+static TraceBuffer* GetThreadTrace()
+{
+	if (ThreadTrace != NULL)
+		return ThreadTrace;
+
+#if defined(_MSC_VER)
+	long index = InterlockedIncrement(&TraceBufferCount) - 1;
+#else
+	long index = __atomic_fetch_add(&TraceBufferCount, 1, __ATOMIC_RELAXED);
+#endif
+
+	// too many threads, this one just doesn't get traced
+	if (index >= TraceMaxThreads)
+		return NULL;
+
+	TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+	if (buffer == NULL)
+		return NULL;
+
+	buffer->ThreadIndex = (int)index;
+	TraceBuffers[index] = buffer;
+	ThreadTrace = buffer;
+	return buffer;
+}
+
+static void TraceRecord(const char* name, char phase)
+{
+	TraceBuffer* buffer = GetThreadTrace();
+	if (buffer == NULL)
+		return;
+
+	TraceEvent* event = &buffer->Events[buffer->Written % TraceBufferEvents];
+	event->Name = name;
+	event->Time = GetPreciseTime();
+	event->Phase = phase;
+	buffer->Written++;
+}
+
+void TraceBegin(const char* name)
+{
+	TraceRecord(name, 'B');
+}
+
+void TraceEnd(const char* name)
+{
+	TraceRecord(name, 'E');
+}
+
+void SetTraceEnabled(bool enabled)
+{
+	TraceEnabled = enabled;
+}
+
+bool WriteChromeTrace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+
+	fprintf(file, "{\"traceEvents\":[\n");
+
+	bool first = true;
+	long bufferCount = TraceBufferCount < TraceMaxThreads ? TraceBufferCount : TraceMaxThreads;
+	for (long i = 0; i < bufferCount; i++)
+	{
+		TraceBuffer* buffer = TraceBuffers[i];
+		if (buffer == NULL)
+			continue;
+
+		// once the ring has wrapped, the oldest event is the one that will be overwritten next
+		uint64_t start = buffer->Written > TraceBufferEvents ? buffer->Written - TraceBufferEvents : 0;
+		for (uint64_t e = start; e < buffer->Written; e++)
+		{
+			TraceEvent* event = &buffer->Events[e % TraceBufferEvents];
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", first ? "" : ",\n", event->Name, event->Phase, event->Time * 1000000.0, buffer->ThreadIndex);
+			first = false;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
+
+#else
+
+void SetTraceEnabled(bool enabled)
+{
+	(void)enabled;
+}
+
+bool WriteChromeTrace(const char* path)
+{
+	(void)path;
+	return false;
+}
+
+#endif
@@ -31,6 +31,12 @@ newoption
     default = "opengl33"
 }
 
+newoption
+{
+    trigger = "trace",
+    description = "compile in phase tracing of the network code (NET_TRACE)"
+}
+
 function string.starts(String,Start)
     return string.sub(String,1,string.len(Start))==Start
 end
@@ -140,6 +146,9 @@ workspace (workspaceName)
         defines { "NDEBUG" }
         optimize "On"
 
+    filter "options:trace"
+        defines { "NET_TRACE" }
+
     filter { "platforms:x64" }
         architecture "x86_64"
 
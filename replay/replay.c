@@ -0,0 +1,265 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// capture replay tool
+// feeds a capture made with the server's SERVER_CAPTURE option in to a host set up like the server's, and times how long it takes to handle
+// each sender in the capture gets its own local socket, so the host sees the same number of clients as when the capture was made,
+// and enet's clock is set to the captured time before every datagram, so the timestamps inside the datagrams still make sense
+// the datagrams go over loopback one at a time, and the host is serviced until it has handled each one, so every run does the same work
+// the events are handled like the server's receive path, but no game logic runs, so nothing is sent back but enet's own replies
+// usage: replay <capture file> [--fast] [--speed N]
+
+#define ENET_IMPLEMENTATION
+#include "net_common.h"
+#include "net_capture.h"
+#include "net_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define ReplaySleep(seconds) Sleep((DWORD)((seconds) * 1000))
+#else
+#include <time.h>
+static void ReplaySleep(double seconds)
+{
+	struct timespec wait = { 0 };
+	wait.tv_sec = (time_t)seconds;
+	wait.tv_nsec = (long)((seconds - (double)wait.tv_sec) * 1000000000.0);
+	nanosleep(&wait, NULL);
+}
+#endif
+
+// what happened during the replay, these should come out the same every run of the same capture
+typedef struct
+{
+	uint64_t Datagrams;
+	uint64_t Bytes;
+	uint64_t Connects;
+	uint64_t Disconnects;
+	uint64_t Messages;
+	uint64_t Commands[256];
+}ReplayCounts;
+
+// one socket for every sender in the capture, made the first time that sender shows up
+static ENetSocket Sockets[CaptureMaxSources];
+static int SocketCount = 0;
+
+static ENetSocket GetSourceSocket(uint16_t source)
+{
+	while (SocketCount <= source)
+	{
+		ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+		if (socket == ENET_SOCKET_NULL)
+			return ENET_SOCKET_NULL;
+
+		// let the socket send to IPv4 addresses too, like an enet host does
+		enet_socket_set_option(socket, ENET_SOCKOPT_IPV6_V6ONLY, 0);
+
+		// nobody reads what the host sends back, so don't let it block
+		enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+		Sockets[SocketCount++] = socket;
+	}
+
+	return Sockets[source];
+}
+
+// wait until it is time to send something, sleeping for most of it and spinning for the last bit so the timing stays close
+static void WaitUntil(double time)
+{
+	for (;;)
+	{
+		double remaining = time - GetPreciseTime();
+		if (remaining <= 0)
+			return;
+
+		if (remaining > 0.002)
+			ReplaySleep(remaining - 0.001);
+	}
+}
+
+// handle an event the same way the server reads it, without any of the game logic
+static void HandleReplayEvent(ENetEvent* event, ReplayCounts* counts)
+{
+	switch (event->type)
+	{
+	case ENET_EVENT_TYPE_CONNECT:
+		counts->Connects++;
+		break;
+
+	case ENET_EVENT_TYPE_DISCONNECT:
+	case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+		counts->Disconnects++;
+		break;
+
+	case ENET_EVENT_TYPE_RECEIVE:
+	{
+		// clients batch their messages, so unpack the packet and count each message by its own command
+		MessageReader reader = { 0 };
+		BeginReadMessages(&reader, event->packet);
+
+		size_t offset = 0;
+		size_t length = 0;
+		while ((length = ReadNextMessage(&reader, &offset)) > 0)
+		{
+			uint8_t command = ReadByte(event->packet, &offset);
+			counts->Messages++;
+			counts->Commands[command]++;
+
+			// read what the server would, the position and direction, and the trace if the input is timed
+			if (command == UpdateInput && length >= UpdateInputSize)
+			{
+				int shorts = length >= UpdateInputTracedSize ? 6 : 4;
+				for (int i = 0; i < shorts; i++)
+					ReadShort(event->packet, &offset);
+			}
+		}
+
+		enet_packet_destroy(event->packet);
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("usage: replay <capture file> [--fast] [--speed N]\n");
+		printf("  --fast     feed everything in as fast as possible\n");
+		printf("  --speed N  play back N times faster than it was captured\n");
+		return 1;
+	}
+
+	const char* path = argv[1];
+	bool fast = false;
+	double speed = 1;
+
+	for (int arg = 2; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], "--fast") == 0)
+			fast = true;
+		else if (strcmp(argv[arg], "--speed") == 0 && arg + 1 < argc)
+			speed = atof(argv[++arg]);
+	}
+
+	if (speed <= 0)
+		speed = 1;
+
+	if (enet_initialize() != 0)
+		return 1;
+
+	CaptureReader* reader = OpenCapture(path);
+	if (reader == NULL)
+	{
+		printf("Could not read capture %s\n", path);
+		return 1;
+	}
+
+	// the host is made the same way the server makes its host, but only listens on loopback, on any free port
+	ENetAddress address = { 0 };
+	enet_address_set_host(&address, "127.0.0.1");
+	address.port = 0;
+
+	ENetHost* host = enet_host_create(&address, MAX_PLAYERS, 1, 0, 0);
+	if (host == NULL)
+	{
+		printf("Could not create the replay host\n");
+		return 1;
+	}
+
+	enet_socket_get_address(host->socket, &address);
+
+	// this is a big struct, don't put it on the stack
+	static CapturedDatagram datagram;
+	static ReplayCounts counts;
+
+	uint64_t failed = 0;
+	double captureLength = 0;
+	double serviceTime = 0;
+	double start = GetPreciseTime();
+
+	while (ReadCapturedDatagram(reader, &datagram))
+	{
+		if (!fast)
+			WaitUntil(start + datagram.Time / speed);
+
+		ENetSocket socket = GetSourceSocket(datagram.Source);
+		if (socket == ENET_SOCKET_NULL)
+			break;
+
+		ENetBuffer buffer = { 0 };
+		buffer.data = datagram.Data;
+		buffer.dataLength = datagram.Length;
+		if (enet_socket_send(socket, &address, &buffer, 1) < 0)
+			failed++;
+
+		counts.Datagrams++;
+		counts.Bytes += datagram.Length;
+		captureLength = datagram.Time;
+
+		// put enet's clock back to when this datagram arrived originally, then let the host handle everything it can
+		enet_time_set(datagram.ServiceTime);
+
+		double serviceStart = GetPreciseTime();
+		ENetEvent event = { 0 };
+		while (enet_host_service(host, &event, 0) > 0)
+			HandleReplayEvent(&event, &counts);
+		serviceTime += GetPreciseTime() - serviceStart;
+	}
+
+	double elapsed = GetPreciseTime() - start;
+
+	printf("Replayed %llu datagrams (%llu bytes) from %d senders in %.3fs, captured over %.3fs\n",
+		(unsigned long long)counts.Datagrams, (unsigned long long)counts.Bytes, SocketCount, elapsed, captureLength);
+	printf("%llu connects, %llu disconnects, %llu messages\n",
+		(unsigned long long)counts.Connects, (unsigned long long)counts.Disconnects, (unsigned long long)counts.Messages);
+	for (int i = 0; i < 256; i++)
+	{
+		if (counts.Commands[i] > 0)
+			printf("  %s: %llu\n", GetCommandName((uint8_t)i), (unsigned long long)counts.Commands[i]);
+	}
+
+	if (counts.Datagrams > 0)
+		printf("%.3fs servicing the host, %.2fus per datagram\n", serviceTime, serviceTime * 1000000.0 / counts.Datagrams);
+	if (failed > 0)
+		printf("%llu sends failed\n", (unsigned long long)failed);
+
+	CloseCapture(reader);
+	for (int i = 0; i < SocketCount; i++)
+		enet_socket_destroy(Sockets[i]);
+
+	enet_host_destroy(host);
+	enet_deinitialize();
+	return 0;
+}
@@ -28,10 +28,28 @@
 
 // server code
 
+// rand_s is only declared when this is set before stdlib.h is included
+#ifdef _WIN32
+#define _CRT_RAND_S
+#endif
+
 #define ENET_IMPLEMENTATION
 #include "net_common.h"
+#include "net_rate.h"
+#include "server_movement.h"
+#include "server_metrics.h"
+#include "net_capture.h"
+#include "server_profiler.h"
+#include "server_priority.h"
+#include "server_lod.h"
+#include "server_session.h"
+#include "server_backpressure.h"
+#include "net_alloc.h"
+#include "net_batch.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -47,12 +65,67 @@ typedef struct
 	// the network connection they use
 	ENetPeer* Peer;
 
-	// the last known location in X and Y
-	int16_t X;
-	int16_t Y;
+	// when they last sent us input, so we know how far they could have moved since
+	double LastInputTime;
+
+	// bumped every time the player sends us a new position, so we know who has news to send out
+	uint32_t Version;
+
+	// the version of every other player that we last sent to this player
+	uint32_t SentVersions[MAX_PLAYERS];
+
+	// the tick every other player was last sent to this player, so players far away can be sent less often
+	uint64_t SentTicks[MAX_PLAYERS];
+
+	// how much each other player needs to be sent to this one, so the closest and fastest go first when not everyone fits
+	PriorityAccumulator Priority;
+
+	// how often and how much we send to this player, based on how well their connection is doing
+	RateControl Rate;
+
+	// how backed up their connection is, and how far their updates are cut back because of it
+	BackpressureControl Backpressure;
+
+	// the bytes of messages sent to this player since the last snapshot, checked against the byte budget
+	uint32_t TickBytes;
+
+	// messages waiting to go out to this player, they are all sent as one packet at the end of the tick
+	MessageBatch Outgoing;
+
+	// true while this player is still being sent the join snapshot of everyone who was already here
+	bool Joining;
+
+	// the next player slot to go in their join snapshot
+	int JoinCursor;
 
-	int16_t DX;
-	int16_t DY;
+	// how many messages this player has been sent on this connection, and the number of the last message that told them about each other player
+	// when they come back after a drop, this is checked against how many messages they got, to see what they missed
+	uint32_t MessagesSent;
+	uint32_t SentMessages[MAX_PLAYERS];
+
+	// the token the player can use to get this slot back if their connection drops
+	uint32_t SessionToken;
+
+	// true while the player's connection has dropped and their slot is being held for them, and when it dropped
+	// they stay in the world for everyone else until they come back or the grace period runs out
+	bool Suspended;
+	double SuspendTime;
+
+	// true from when a returning player gets their slot back until they tell us what they still have
+	bool Resuming;
+
+	// the last sampled input from this player that is being timed, and how long it took to get here, in input trace units
+	// it goes out to everyone else right behind the next update about this player they get, TraceId is 0 when there isn't one
+	uint16_t TraceId;
+	uint16_t TraceClientHold;
+	uint16_t TraceUplink;
+	double TraceReceiveTime;
+
+	// the last input trace of every other player that was sent to this player, so each one only goes out once
+	uint16_t SentTraces[MAX_PLAYERS];
+
+	// bumped every time the slot is given up, so latest only updates about whoever had it before are never replaced by ones about someone new
+	uint16_t SlotGeneration;
 }PlayerInfo;
 
 
@@ -61,6 +134,69 @@ typedef struct
 // this is what server code would check to see where all the players are and what they are doing
 PlayerInfo Players[MAX_PLAYERS] = { 0 };
 
+// where everyone is and how fast they are going, indexed by player id
+// the server moves everyone forward every tick, so this is the real position of each player, not just what they last told us
+MovementStore Movement = { 0 };
+
+// how often the server moves everyone forward and sends out snapshots (60 ticks a second)
+#define ServerTickInterval (1.0 / 60.0)
+
+// how often in seconds the trace file is written when tracing
+#define TraceWriteInterval 5.0
+
+// how often in seconds the connection stats for each player are logged
+#define StatsLogInterval 10.0
+
+// how far past their speed limit we let a player's position jump between inputs, to cover for network jitter
+#define MovementTolerance 20.0f
+
+// the limits for how fast and how much we send to each player
+RateControlConfig SnapshotRateConfig = { 0 };
+
+// how fast players build up priority to be in someone's snapshot
+PriorityConfig SnapshotPriorityConfig = { 0 };
+
+// how often players are sent to each other based on how far apart they are
+// this can be changed with the SERVER_LOD_TIERS environment variable, see ParseLodConfig
+LodConfig SnapshotLodConfig = { 0 };
+
+// how long to wait for network events before checking if anyone needs a snapshot, in milliseconds
+#define ServiceTimeout 5
+
+// times every tick, and tells us how much work to shed when ticks take too long
+TickProfiler Profiler = { 0 };
+
+// how much enet allocates each tick, when SERVER_TRACK_ALLOCS is set
+AllocTickTracker TickAllocations = { 0 };
+
+// what the server gives up as the load shedding level goes up
+// from the first level, work nobody is waiting on (answering metrics, flushing the capture) only happens every few ticks
+// from the second level, each player only gets a snapshot every <level> ticks, staggered so every tick does about the same work
+#define ShedNonCriticalLevel 1
+#define ShedSnapshotLevel 2
+#define NonCriticalTickInterval 8
+
+// how many bytes of messages each player can be sent per tick before snapshot updates are held back, about one datagram
+// important messages like adds and removes are always sent, but they count against the budget
+// this can be changed with the SERVER_PEER_BUDGET environment variable, 0 turns the budget off
+#define DefaultPeerTickBudget 1200
+uint32_t PeerTickBudget = DefaultPeerTickBudget;
+
+// when a player's connection backs up, their snapshot updates are sent latest only, then only a few times a second, and in the end they are disconnected
+// latest only updates each go in their own packet, and replace the last one about the same player if that is still waiting, so they get the newest positions instead of a queue of old ones
+BackpressureConfig SnapshotBackpressureConfig = { 0 };
+
+// how many join snapshot packets a new player can be sent each tick
+// a big world streams in over a few ticks instead of flooding the new player's reliable window all at once
+#define JoinChunksPerTick 4
+
+// where session tokens come from, keyed from a good random source at startup
+SessionTokenSource SessionTokens = { 0 };
+
+// what enet adds to each packet we send, the send reliable command in front of the data
+// messages are batched, so this is paid once per player per tick instead of once per message
+#define PacketOverhead sizeof(ENetProtocolSendReliable)
+
 // finds the player slot that goes with the player connection
 // the peer has the void* ENetPeer::data that can be used to store arbitary application data
 // but that involves managing structure pointers so it is kept out of this example
@@ -75,27 +211,747 @@ int GetPlayerId(ENetPeer* peer)
 	return -1;
 }
 
-// sends a packet over the network to every active player, except the one specified (usually the sender)
+// how many bytes sending a message to a player will add to what goes over the wire this tick
+// the first message in a batch also pays for the packet it goes in
+size_t GetSendCost(int playerId, size_t messageSize)
+{
+	const MessageBatch* batch = &Players[playerId].Outgoing;
+	return GetBatchedMessageCost(batch, messageSize) + (batch->Length == 0 ? PacketOverhead : 0);
+}
+
+// sends a message to one player, all sends go through here so they can be counted
+// the message is added to the player's batch, and goes out with everything else at the end of the tick
+void SendToPlayer(int playerId, const uint8_t* message, size_t messageSize)
+{
+	MetricsCountSent(message, messageSize, 1);
+	CountMessageSent(Players[playerId].Peer, message, messageSize);
+	Players[playerId].MessagesSent++;
+	Players[playerId].TickBytes += (uint32_t)GetSendCost(playerId, messageSize);
+	BatchMessage(&Players[playerId].Outgoing, Players[playerId].Peer, message, messageSize);
+}
+
+// true if a message of this size can still be sent to the player this tick without going over their byte budget
+bool FitsInBudget(int playerId, size_t messageSize)
+{
+	if (PeerTickBudget == 0)
+		return true;
+
+	return Players[playerId].TickBytes + GetSendCost(playerId, messageSize) <= PeerTickBudget;
+}
+
+// sends a message to every active player, except the one specified (usually the sender)
 // senders know what they sent so you can choose to not send them data they already know.
 // in a truly authoritative server you'd send back an acceptance message to all client input so they know it wasn't rejected.
-void SendToAllBut(ENetPacket* packet, int exceptPlayerId)
+void SendToAllBut(const uint8_t* message, size_t messageSize, int exceptPlayerId)
 {
 	for (int i = 0; i < MAX_PLAYERS; i++)
 	{
 		if (!Players[i].Active || i == exceptPlayerId)
 			continue;
 
-		enet_peer_send(Players[i].Peer, 0, packet);
+		SendToPlayer(i, message, messageSize);
+	}
+}
+
+// sends a message to one player as its own packet, for messages that are too big to go in a batch
+// anything already in their batch is sent first, so everything arrives in the order it was sent
+void SendPacketToPlayer(int playerId, const uint8_t* message, size_t messageSize)
+{
+	PlayerInfo* player = &Players[playerId];
+	MetricsCountSent(message, messageSize, 1);
+	CountMessageSent(player->Peer, message, messageSize);
+	player->MessagesSent++;
+	player->TickBytes += (uint32_t)(messageSize + PacketOverhead);
+
+	FlushMessageBatch(&player->Outgoing, player->Peer);
+
+	ENetPacket* packet = enet_packet_create(message, messageSize, ENET_PACKET_FLAG_RELIABLE);
+	if (packet != NULL && enet_peer_send(player->Peer, 0, packet) != 0)
+		enet_packet_destroy(packet);
+}
+
+// hand every player's batch of messages to enet as one packet each
+void FlushPlayerMessages()
+{
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (Players[i].Active)
+			FlushMessageBatch(&Players[i].Outgoing, Players[i].Peer);
+	}
+}
+
+// true if a player is in the world, even if their connection has dropped and we are holding their slot for them
+bool IsInWorld(int playerId)
+{
+	return (Players[playerId].Active || Players[playerId].Suspended) && Players[playerId].ValidPosition;
+}
+
+// pack up an add or update message with command, player and position
+void WritePlayerUpdate(uint8_t buffer[10], NetworkCommands command, int playerId)
+{
+	buffer[0] = (uint8_t)command;
+	buffer[1] = (uint8_t)playerId;
+	*(int16_t*)(buffer + 2) = (int16_t)Movement.X[playerId];
+	*(int16_t*)(buffer + 4) = (int16_t)Movement.Y[playerId];
+	*(int16_t*)(buffer + 6) = (int16_t)Movement.VX[playerId];
+	*(int16_t*)(buffer + 8) = (int16_t)Movement.VY[playerId];
+}
+
+// what a latest only update about a player is the latest of, see enet_peer_send_latest
+uint32_t GetLatestKey(int playerId)
+{
+	return ((uint32_t)Players[playerId].SlotGeneration << 16) | (uint32_t)(playerId + 1);
+}
+
+// tell a player how long the last timed input from another player took to get through the server, sent right behind an update about them
+// the time on the server goes until now, when the update is queued, so it counts waiting for the tick, the rate limit, the level of detail and the byte budget
+void SendInputTrace(int playerId, int tracedId)
+{
+	PlayerInfo* traced = &Players[tracedId];
+
+	uint8_t buffer[InputTraceSize] = { 0 };
+	buffer[0] = (uint8_t)InputTrace;
+	buffer[1] = (uint8_t)tracedId;
+	*(uint16_t*)(buffer + 2) = traced->TraceId;
+	*(uint16_t*)(buffer + 4) = traced->TraceClientHold;
+	*(uint16_t*)(buffer + 6) = traced->TraceUplink;
+	*(uint16_t*)(buffer + 8) = PackTraceTime(GetPreciseTime() - traced->TraceReceiveTime);
+	SendToPlayer(playerId, buffer, sizeof(buffer));
+
+	Players[playerId].SentTraces[tracedId] = traced->TraceId;
+}
+
+// stream everyone who was already in the game to the players who just joined, a few packets a tick
+// each packet holds as many players as fit in a datagram, and the last one is flagged so the client knows it has the whole world
+// players who came back after a drop only get the players they don't have the latest of
+void SendJoinSnapshots()
+{
+	for (int playerId = 0; playerId < MAX_PLAYERS; playerId++)
+	{
+		PlayerInfo* player = &Players[playerId];
+		if (!player->Active || !player->Joining)
+			continue;
+
+		for (int chunk = 0; chunk < JoinChunksPerTick && player->Joining; chunk++)
+		{
+			uint8_t buffer[MessageBatchCapacity] = { 0 };
+			size_t length = JoinSnapshotHeaderSize;
+			uint16_t count = 0;
+
+			int i = player->JoinCursor;
+			for (; i < MAX_PLAYERS && length + JoinSnapshotEntrySize <= sizeof(buffer); i++)
+			{
+				// only people who are in the world, not the new player, and that they don't already have
+				if (i == playerId || !IsInWorld(i) || player->SentVersions[i] == Players[i].Version)
+					continue;
+
+				// the same as an add player message, without the command
+				uint8_t entry[10] = { 0 };
+				WritePlayerUpdate(entry, AddPlayer, i);
+				*(uint16_t*)(buffer + length) = (uint16_t)i;
+				memcpy(buffer + length + 2, entry + 2, JoinSnapshotEntrySize - 2);
+
+				length += JoinSnapshotEntrySize;
+				count++;
+
+				// this packet goes out below as the next message
+				player->SentVersions[i] = Players[i].Version;
+				player->SentMessages[i] = player->MessagesSent + 1;
+			}
+
+			player->JoinCursor = i;
+			player->Joining = i < MAX_PLAYERS;
+
+			buffer[0] = (uint8_t)JoinSnapshot;
+			buffer[1] = player->Joining ? 0 : JoinSnapshotLast;
+			*(uint16_t*)(buffer + 2) = count;
+
+			SendPacketToPlayer(playerId, buffer, length);
+		}
+	}
+}
+
+// move everyone forward one tick, anyone who is moving has news for everyone else
+void SimulateTick(float deltaT)
+{
+	StepMovement(&Movement, deltaT, MaxPlayerSpeed);
+
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (Players[i].Active && Players[i].ValidPosition && (Movement.VX[i] != 0 || Movement.VY[i] != 0))
+			Players[i].Version++;
+	}
+}
+
+// sends the latest positions of other players to everyone whose rate controller says it's time
+// players on a bad connection get updates less often, and fewer players per update, so their connection can catch up
+// players far away are only sent every few ticks, based on the level of detail tiers
+// when not everyone fits, the players with the most priority go first, and the rest build up more priority for next time
+// when the server is shedding load, players take turns getting snapshots
+void SendSnapshots(double now, float deltaT, int shedLevel, uint64_t tick)
+{
+	for (int playerId = 0; playerId < MAX_PLAYERS; playerId++)
+	{
+		PlayerInfo* player = &Players[playerId];
+
+		// a returning player gets nothing until we know what they missed
+		if (!player->Active || player->Resuming)
+			continue;
+
+		// everyone with news for this player, who is due an update for how far away they are, builds up priority every tick, even when they don't get a snapshot
+		uint8_t changed[MAX_PLAYERS] = { 0 };
+		GetLodDue(&SnapshotLodConfig, &Movement, MAX_PLAYERS, Movement.X[playerId], Movement.Y[playerId], tick, player->SentTicks, changed);
+		for (int i = 0; i < MAX_PLAYERS; i++)
+			changed[i] = changed[i] && i != playerId && IsInWorld(i) && player->SentVersions[i] != Players[i].Version;
+
+		// while they are joining, they only get updates about players their join snapshot has already told them about
+		if (player->Joining)
+		{
+			for (int i = player->JoinCursor; i < MAX_PLAYERS; i++)
+				changed[i] = 0;
+		}
+
+		AccumulatePriorities(&player->Priority, &SnapshotPriorityConfig, &Movement, MAX_PLAYERS, Movement.X[playerId], Movement.Y[playerId], changed, deltaT);
+
+		if (shedLevel >= ShedSnapshotLevel && (tick + playerId) % shedLevel != 0)
+			continue;
+
+		bool latestOnly = false;
+		if (!BeginPeerSnapshot(&player->Backpressure, &SnapshotBackpressureConfig, &player->Rate, &SnapshotRateConfig, now, player->Peer, &player->Outgoing, &latestOnly))
+			continue;
+
+		// send up to the detail limit of the players with the most priority
+		int selected[MAX_PLAYERS] = { 0 };
+		int selectedCount = SelectTopPriorities(&player->Priority, MAX_PLAYERS, player->Rate.Detail, selected);
+
+		for (int pick = 0; pick < selectedCount; pick++)
+		{
+			int i = selected[pick];
+
+			// snapshots are the first thing to give up when a player is over budget, anyone not sent now keeps their priority and goes out next time
+			if (!FitsInBudget(playerId, 10))
+			{
+				MetricsCountBudgetCut();
+				break;
+			}
+
+			uint8_t buffer[10] = { 0 };
+			WritePlayerUpdate(buffer, UpdatePlayer, i);
+			SendToPlayer(playerId, buffer, sizeof(buffer));
+
+			player->SentVersions[i] = Players[i].Version;
+			player->SentMessages[i] = player->MessagesSent;
+			player->SentTicks[i] = tick;
+			ResetPriority(&player->Priority, i);
+
+			// if that update has a timed input in it they haven't heard about, say how long it has taken so far
+			if (Players[i].TraceId != 0 && player->SentTraces[i] != Players[i].TraceId)
+				SendInputTrace(playerId, i);
+
+			// the update and its trace go together, and replace the last ones about this player if those haven't gone out yet
+			// a replaced update was counted as a message they were sent, so if they drop, a resume sends them a little more than they missed, never less
+			if (EndSnapshotUpdate(&player->Outgoing, player->Peer, latestOnly, GetLatestKey(i)))
+				MetricsCountSuperseded();
+		}
+	}
+
+	// everyone starts the next tick with a fresh budget
+	for (int playerId = 0; playerId < MAX_PLAYERS; playerId++)
+		Players[playerId].TickBytes = 0;
+}
+
+// print the tail of each player's round trip time, jitter and resends since the last log, then start collecting again
+// the averages enet keeps look fine even when one packet in a hundred is late, p99 shows it
+void LogPlayerStats()
+{
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (!Players[i].Active)
+			continue;
+
+		PeerStats stats = { 0 };
+		SnapshotPeerStats(Players[i].Peer, &stats, true);
+
+		printf("Player %d rtt p50 %ums p99 %ums max %ums (%u samples), jitter p99 %ums, resends p99 %u max %u\n", i,
+			GetHistogramPercentile(&stats.RoundTrip, 50), GetHistogramPercentile(&stats.RoundTrip, 99), stats.RoundTrip.Max, stats.RoundTrip.Count,
+			GetHistogramPercentile(&stats.Jitter, 99),
+			GetHistogramPercentile(&stats.Retransmits, 99), stats.Retransmits.Max);
+	}
+}
+
+// print how much enet has been allocating since the last log
+// once everyone is connected and playing, a tick should not need to allocate anything
+void LogAllocationStats()
+{
+	if (!TrackingAllocations() || TickAllocations.Ticks == 0)
+		return;
+
+	AllocCounters counters = { 0 };
+	GetAllocCounters(&counters);
+
+	printf("Allocations %.1f/tick (%.0f bytes/tick), max %llu in one tick (%llu bytes), %llu of %llu ticks allocation free, %llu live (%llu bytes), peak %llu bytes\n",
+		(double)TickAllocations.Allocations / TickAllocations.Ticks, (double)TickAllocations.Bytes / TickAllocations.Ticks,
+		(unsigned long long)TickAllocations.PeakAllocations, (unsigned long long)TickAllocations.PeakBytes,
+		(unsigned long long)TickAllocations.QuietTicks, (unsigned long long)TickAllocations.Ticks,
+		(unsigned long long)counters.LiveAllocations, (unsigned long long)counters.LiveBytes, (unsigned long long)counters.PeakLiveBytes);
+
+	ResetAllocTickTracker(&TickAllocations);
+}
+
+// print where the time went in a slow tick, and what the server is doing about it
+void LogShedLevelChange(const TickRecord* record, int newLevel)
+{
+	printf("Tick took %.2fms of %.2fms (", record->Total * 1000.0, ServerTickInterval * 1000.0);
+	for (int i = 0; i < StageCount; i++)
+		printf("%s%s %.2fms", i > 0 ? ", " : "", GetTickStageName((TickStage)i), record->Stages[i] * 1000.0);
+	printf("), load shedding level %d -> %d\n", record->ShedLevel, newLevel);
+}
+
+// the name an event handler shows up as in a trace
+const char* GetEventTraceName(ENetEventType type)
+{
+	switch (type)
+	{
+	case ENET_EVENT_TYPE_CONNECT:
+		return "HandleConnect";
+	case ENET_EVENT_TYPE_RECEIVE:
+		return "HandleReceive";
+	case ENET_EVENT_TYPE_DISCONNECT:
+	case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+		return "HandleDisconnect";
+	default:
+		return "HandleNone";
+	}
+}
+
+// handle one message from a player, offset is where the message starts in the packet
+void HandlePlayerMessage(int playerId, ENetPacket* packet, size_t offset, size_t length)
+{
+	MetricsCountReceived(packet->data + offset, length);
+	CountMessageReceived(Players[playerId].Peer, packet->data + offset, length);
+
+	// read off the command the client wants us to process
+	NetworkCommands command = ReadByte(packet, &offset);
+
+	// we only accept one message from clients for now, so make sure this is what it is
+	if (command == UpdateInput && length >= UpdateInputSize)
+	{
+		// read what the client says their location and movement are
+		float x = ReadShort(packet, &offset);
+		float y = ReadShort(packet, &offset);
+		float dx = ReadShort(packet, &offset);
+		float dy = ReadShort(packet, &offset);
+
+		// we don't just trust the client, they can only be as far from where we think they are as they could have moved since their last input
+		// the speed limit and staying on the field are handled by the movement step
+		double now = enet_time_get() / 1000.0;
+		float maxStep = -1;
+		if (Players[playerId].ValidPosition)
+			maxStep = MaxPlayerSpeed * (float)(now - Players[playerId].LastInputTime) + MovementTolerance;
+
+		SetMovementInput(&Movement, playerId, x, y, dx, dy, maxStep);
+		Players[playerId].LastInputTime = now;
+
+		// there is news about this player for everyone else
+		Players[playerId].Version++;
+
+		// if the client is timing this input, keep how long it took to get here, the trip up is half the round trip time since our clocks don't agree
+		if (length >= UpdateInputTracedSize)
+		{
+			uint16_t traceId = (uint16_t)ReadShort(packet, &offset);
+			uint16_t clientHold = (uint16_t)ReadShort(packet, &offset);
+			if (traceId != 0)
+			{
+				Players[playerId].TraceId = traceId;
+				Players[playerId].TraceClientHold = clientHold;
+				Players[playerId].TraceUplink = PackTraceTime(Players[playerId].Peer->roundTripTime / 2000.0);
+				Players[playerId].TraceReceiveTime = GetPreciseTime();
+			}
+		}
+
+		// if they are new, send out an add player with the next batch, everyone else will get regular updates in the snapshots
+		if (!Players[playerId].ValidPosition)
+		{
+			// the player has sent us a position, they can be part of future regular updates
+			Players[playerId].ValidPosition = true;
+
+			// pack up the add message with command, player and position
+			uint8_t buffer[10] = { 0 };
+			WritePlayerUpdate(buffer, AddPlayer, playerId);
+
+			// send the data to everyone but the player who sent it
+			SendToAllBut(buffer, sizeof(buffer), playerId);
+
+			// everyone has the latest version now
+			for (int i = 0; i < MAX_PLAYERS; i++)
+			{
+				Players[i].SentVersions[playerId] = Players[playerId].Version;
+				Players[i].SentMessages[playerId] = Players[i].MessagesSent;
+			}
+		}
+	}
+	else if (command == ResumeSession && length >= ResumeSessionHeaderSize + ResumeKnownMaskSize && Players[playerId].Resuming)
+	{
+		PlayerInfo* player = &Players[playerId];
+
+		// how many messages they got on their old connection, and who they still have
+		uint32_t received = (uint32_t)ReadInt(packet, &offset);
+		const uint8_t* knownMask = packet->data + offset;
+
+		uint8_t present[MAX_PLAYERS] = { 0 };
+		uint32_t versions[MAX_PLAYERS] = { 0 };
+		for (int i = 0; i < MAX_PLAYERS; i++)
+		{
+			present[i] = i != playerId && IsInWorld(i);
+			versions[i] = Players[i].Version;
+		}
+
+		uint8_t remove[MAX_PLAYERS] = { 0 };
+		int resend = GetResumeDelta(MAX_PLAYERS, present, versions, player->SentVersions, player->SentMessages, received, knownMask, remove);
+
+		// tell them about anyone who left while they were away
+		int removed = 0;
+		for (int i = 0; i < MAX_PLAYERS; i++)
+		{
+			if (!remove[i])
+				continue;
+
+			removed++;
+
+			uint8_t buffer[2] = { 0 };
+			buffer[0] = (uint8_t)RemovePlayer;
+			buffer[1] = (uint8_t)i;
+			SendToPlayer(playerId, buffer, sizeof(buffer));
+		}
+
+		// the old connection's message numbers mean nothing on this one
+		for (int i = 0; i < MAX_PLAYERS; i++)
+			player->SentMessages[i] = 0;
+
+		// and send everyone they don't have the latest of as a join snapshot, the last part tells them they are caught up
+		player->Resuming = false;
+		player->Joining = true;
+		player->JoinCursor = 0;
+
+		printf("Player %d resumed, %d players to resend, %d to remove\n", playerId, resend, removed);
+	}
+}
+
+// start a new connection for a player in a slot, everything about the connection starts fresh
+// they are sent their id and a new session token, and whether they got their old slot back
+void StartPlayerConnection(int playerId, ENetPeer* peer, bool resumed)
+{
+	PlayerInfo* player = &Players[playerId];
+
+	// player is good, don't give away the slot
+	player->Active = true;
+	player->Suspended = false;
+	player->Peer = peer;
+
+	// they start out at the best rate we have, with nothing waiting to go out to them
+	ClearPriorities(&player->Priority);
+	player->TickBytes = 0;
+	player->MessagesSent = 0;
+	ResetMessageBatch(&player->Outgoing);
+	memset(player->SentTraces, 0, sizeof(player->SentTraces));
+	InitRateControl(&player->Rate, &SnapshotRateConfig);
+	InitBackpressure(&player->Backpressure);
+
+	// a new token for every connection, so a token can only be used once
+	player->SessionToken = NextSessionToken(&SessionTokens);
+
+	// pack up a message to send back to the client to tell them they have been accepted as a player
+	uint8_t buffer[AcceptPlayerSize] = { 0 };
+	buffer[0] = (uint8_t)AcceptPlayer;              // command for the client
+	buffer[1] = (uint8_t)playerId;                  // the player ID so they know who they are
+	buffer[2] = resumed ? AcceptResumed : 0;        // if they still have the world from before
+	*(uint32_t*)(buffer + 3) = player->SessionToken; // what they use to get this slot back if they drop
+
+	// send the data to the user, it goes out with the rest of their messages at the end of the tick
+	SendToPlayer(playerId, buffer, sizeof(buffer));
+}
+
+// find the slot that goes with a session token, -1 if there isn't one, or it has run out
+// the client can notice its connection is gone before we do, so the slot may still be on its old connection
+int FindSessionPlayer(uint32_t token, ENetPeer* peer)
+{
+	if (token == 0)
+		return -1;
+
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if ((Players[i].Suspended || (Players[i].Active && Players[i].Peer != peer)) && Players[i].SessionToken == token)
+			return i;
+	}
+	return -1;
+}
+
+// take a player out of the game for good, and tell everyone who is left
+void RemovePlayerFromGame(int playerId)
+{
+	// mark them as inactive and clear the peer pointer
+	Players[playerId].Active = false;
+	Players[playerId].Suspended = false;
+	Players[playerId].Resuming = false;
+	Players[playerId].ValidPosition = false;
+	Players[playerId].Peer = NULL;
+
+	// whoever gets the slot next starts their trace ids over, and their updates never replace ones about whoever had it before
+	Players[playerId].TraceId = 0;
+	Players[playerId].SlotGeneration++;
+	for (int i = 0; i < MAX_PLAYERS; i++)
+		Players[i].SentTraces[playerId] = 0;
+
+	// and make sure the movement step doesn't keep moving an empty slot around
+	StopMovement(&Movement, playerId);
+
+	// Tell everyone that someone left
+	uint8_t buffer[2] = { 0 };
+	buffer[0] = (uint8_t)RemovePlayer;
+	buffer[1] = (uint8_t)playerId;
+
+	// send it to everyone who is left
+	SendToAllBut(buffer, sizeof(buffer), -1);
+}
+
+// hold the slot of a player whose connection dropped, so they can get it back if they come back soon
+// they stay where they are in the world, so nobody else sees them leave unless they don't come back
+void SuspendPlayer(int playerId, double now)
+{
+	PlayerInfo* player = &Players[playerId];
+	player->Active = false;
+	player->Peer = NULL;
+	player->Suspended = true;
+	player->SuspendTime = now;
+	player->Joining = false;
+
+	// if they dropped again before telling us what they had, we can't tell what they got on either connection
+	if (player->Resuming)
+	{
+		for (int i = 0; i < MAX_PLAYERS; i++)
+			player->SentVersions[i] = 0;
+		player->Resuming = false;
+	}
+
+	// they stop where they are, and everyone else gets that as news
+	StopMovement(&Movement, playerId);
+	player->Version++;
+}
+
+// disconnect players whose connection has been too slow for too long, even with their updates cut back, or has too much waiting for it
+// enet throws away everything waiting for them, and their slot is held the same as if their connection dropped, so if they come back they only get what they missed
+// everyone's backpressure is read here, once a tick, and their snapshots are cut back to match
+void DropSlowPlayers(double now)
+{
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		PlayerInfo* player = &Players[i];
+		if (!player->Active)
+			continue;
+
+		if (!CheckSlowPeer(&player->Backpressure, &SnapshotBackpressureConfig, now, player->Peer))
+			continue;
+
+		const PeerBackpressure* pressure = &player->Backpressure.Last;
+		printf("Player %d is too slow, %zu bytes waiting for up to %.1f seconds, %.1f seconds to drain, disconnected\n", i, pressure->QueuedBytes + pressure->InTransitBytes, pressure->OldestWait, pressure->DrainTime);
+		MetricsCountSlowDisconnect();
+
+		// their slot is held the same as if their connection dropped
+		if (player->ValidPosition)
+			SuspendPlayer(i, now);
+		else
+			RemovePlayerFromGame(i);
+	}
+}
+
+// give up the slots of dropped players who didn't come back in time
+void ExpireSuspendedPlayers(double now)
+{
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (!Players[i].Suspended || now - Players[i].SuspendTime < SessionGracePeriod)
+			continue;
+
+		printf("Player %d did not come back\n", i);
+		RemovePlayerFromGame(i);
+		MetricsCountSessionExpired();
 	}
 }
 
+// handle one network event from the server host, a player connecting, sending us data, or leaving
+void HandleEvent(ENetEvent* event)
+{
+	// see what kind of event we have
+	switch (event->type)
+	{
+
+		// a new client is trying to connect
+		case ENET_EVENT_TYPE_CONNECT:
+		{
+			// a player whose connection dropped connects with the session token we gave them, in the connect data
+			// if we are still holding their slot they get it back, and only need what they missed
+			int playerId = FindSessionPlayer(event->data, event->peer);
+			if (playerId != -1)
+			{
+				printf("Player %d Reconnected\n", playerId);
+
+				// the old connection is dead to them, so drop it quietly the same way as if it had timed out
+				if (Players[playerId].Active)
+				{
+					enet_peer_reset(Players[playerId].Peer);
+					SuspendPlayer(playerId, enet_time_get() / 1000.0);
+				}
+
+				StartPlayerConnection(playerId, event->peer, true);
+
+				// they tell us what they still have first thing, until then we don't send them anything about the world
+				Players[playerId].Resuming = true;
+				MetricsCountSessionResumed();
+				break;
+			}
+
+			printf("Player Connected\n");
+
+			// find an empty slot
+			playerId = 0;
+			for (; playerId < MAX_PLAYERS; playerId++)
+			{
+				if (!Players[playerId].Active && !Players[playerId].Suspended)
+					break;
+			}
+
+			// if the only free slots are being held for players who dropped, someone who is here now is worth more, so give up the one held the longest
+			if (playerId == MAX_PLAYERS)
+			{
+				for (int i = 0; i < MAX_PLAYERS; i++)
+				{
+					if (Players[i].Suspended && (playerId == MAX_PLAYERS || Players[i].SuspendTime < Players[playerId].SuspendTime))
+						playerId = i;
+				}
+
+				if (playerId != MAX_PLAYERS)
+					RemovePlayerFromGame(playerId);
+			}
+
+			// we are full
+			if (playerId == MAX_PLAYERS)
+			{
+				// I said good day SIR!
+				enet_peer_disconnect(event->peer, 0);
+				break;
+			}
+
+			// don't send out an update to everyone until they give us a good position
+			Players[playerId].ValidPosition = false;
+			Players[playerId].Resuming = false;
+
+			// they have not been told about anyone yet
+			Players[playerId].Version = 0;
+			for (int i = 0; i < MAX_PLAYERS; i++)
+			{
+				Players[playerId].SentVersions[i] = 0;
+				Players[playerId].SentMessages[i] = 0;
+				Players[playerId].SentTicks[i] = 0;
+			}
+
+			StartPlayerConnection(playerId, event->peer, false);
+
+			// We have to tell the new client about all the other players that are already on the server
+			// so they get a join snapshot with everyone in it, starting next tick
+			// Optimally we'd also send other info like name, color, and other static player info.
+			Players[playerId].Joining = true;
+			Players[playerId].JoinCursor = 0;
+			break;
+		}
+
+		// someone sent us data
+		case ENET_EVENT_TYPE_RECEIVE:
+		{
+			// find the player who sent the data
+			// we don't need them to send us what ID they are, we know who they are by the peer
+			// we want to trust the client as little as possible so that people can't cheat/hack
+			// if we blindly accepted a player ID, a client could send you updates for someone else :(
+
+			int playerId = GetPlayerId(event->peer);
+			if (playerId == -1)
+			{
+				// they are not one of our peeple, boot them
+				enet_peer_disconnect(event->peer, 0);
+				break;
+			}
+
+			// a packet can have several messages in it, handle them all in order
+			MessageReader reader = { 0 };
+			BeginReadMessages(&reader, event->packet);
+
+			size_t offset = 0;
+			size_t length = 0;
+			while ((length = ReadNextMessage(&reader, &offset)) > 0)
+				HandlePlayerMessage(playerId, event->packet, offset, length);
+
+			// tell enet that it can recycle the inbound packet
+			enet_packet_destroy(event->packet);
+			break;
+		}
+		case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+		case ENET_EVENT_TYPE_DISCONNECT:
+		{
+			// a player was disconnected
+			printf("Player Disconnected\n");
+
+			// find them if they are a real player
+			int playerId = GetPlayerId(event->peer);
+			if (playerId == -1)
+				break;
+
+			// if their connection dropped, instead of them leaving, hold their slot in case they come back
+			// players who never made it into the world have nothing worth holding on to
+			if (event->type == ENET_EVENT_TYPE_DISCONNECT_TIMEOUT && Players[playerId].ValidPosition)
+				SuspendPlayer(playerId, enet_time_get() / 1000.0);
+			else
+				RemovePlayerFromGame(playerId);
+			break;
+		}
+
+		case ENET_EVENT_TYPE_NONE:
+			break;
+	}
+}
+
+// fill out random bytes for keys and seeds that must not be guessed, returns false if there is no good random source to get them from
+bool ReadRandomBytes(void* bytes, size_t size)
+{
+#ifndef _WIN32
+	FILE* random = fopen("/dev/urandom", "rb");
+	if (random == NULL)
+		return false;
+
+	bool read = fread(bytes, 1, size, random) == size;
+	fclose(random);
+	return read;
+#else
+	// rand_s comes from the system's secure random source, four bytes at a time
+	uint8_t* out = (uint8_t*)bytes;
+	for (size_t i = 0; i < size; i += sizeof(unsigned int))
+	{
+		unsigned int value = 0;
+		if (rand_s(&value) != 0)
+			return false;
+
+		size_t count = size - i < sizeof(value) ? size - i : sizeof(value);
+		memcpy(out + i, &value, count);
+	}
+	return true;
+#endif
+}
+
 // the main server loop
 int main()
 {
 	printf("Startup\n");
 
-	// set up networking
-	if (enet_initialize() != 0)
+	// set up networking, counting every allocation enet makes if SERVER_TRACK_ALLOCS is set
+	if (InitializeNetwork(getenv("SERVER_TRACK_ALLOCS") != NULL) != 0)
 		return 1;
 
 	printf("Initialized\n");
@@ -115,188 +971,203 @@ int main()
 
 	printf("Created\n");
 
+	// connects have to come back with a cookie before they get a player slot, so a flood of spoofed connects can't fill the server
+	// setting SERVER_CONNECT_COOKIES to 0 turns this off, which saves new players a round trip
+	const char* connectCookies = getenv("SERVER_CONNECT_COOKIES");
+	if (connectCookies == NULL || atoi(connectCookies) != 0)
+	{
+		uint8_t cookieKey[ENET_HOST_CONNECT_COOKIE_KEY_SIZE];
+		enet_host_connect_cookies(server, 1, ReadRandomBytes(cookieKey, sizeof(cookieKey)) ? cookieKey : NULL);
+	}
+
+	// session tokens have to be hard to guess, or anyone could take over the slot of a player whose connection dropped
+	// without a good random source there is nothing safe to make them from, so players can't resume sessions at all
+	uint8_t tokenKey[SessionTokenKeySize];
+	bool haveTokenKey = ReadRandomBytes(tokenKey, sizeof(tokenKey));
+	SeedSessionTokens(&SessionTokens, haveTokenKey ? tokenKey : NULL);
+	if (!haveTokenKey)
+		printf("No random source for session tokens, sessions can't be resumed\n");
+
+	// the metrics are nice to have, but we can run without them
+	if (StartMetrics(MetricsSocketPath))
+		printf("Metrics at %s\n", MetricsSocketPath);
+
+	SnapshotRateConfig = DefaultRateControlConfig();
+	SnapshotBackpressureConfig = DefaultBackpressureConfig();
+
+	// setting SERVER_LOAD_SHED to 0 keeps the tick profiler measuring, but never sheds any load
+	LoadShedConfig loadShedConfig = DefaultLoadShedConfig(ServerTickInterval);
+	const char* loadShed = getenv("SERVER_LOAD_SHED");
+	if (loadShed != NULL)
+		loadShedConfig.Enabled = atoi(loadShed) != 0;
+	InitTickProfiler(&Profiler, &loadShedConfig);
+
+	const char* budget = getenv("SERVER_PEER_BUDGET");
+	if (budget != NULL)
+		PeerTickBudget = (uint32_t)atoi(budget);
+
+	if (!InitMovementStore(&Movement, MAX_PLAYERS))
+		return 1;
+
+	SnapshotPriorityConfig = DefaultPriorityConfig();
+
+	SnapshotLodConfig = DefaultLodConfig();
+	const char* lodTiers = getenv("SERVER_LOD_TIERS");
+	if (lodTiers != NULL && !ParseLodConfig(lodTiers, &SnapshotLodConfig))
+		printf("SERVER_LOD_TIERS should look like 300:1,700:4,0:12, using the default tiers\n");
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (!InitPriorityAccumulator(&Players[i].Priority, MAX_PLAYERS))
+			return 1;
+	}
+
+	// when the server is built with tracing, setting SERVER_TRACE to a file name turns it on
+	// the trace is written out every few seconds, so it can be grabbed while the server is running
+	const char* traceFile = getenv("SERVER_TRACE");
+	double lastTraceWrite = enet_time_get() / 1000.0;
+	if (traceFile != NULL)
+	{
+		SetTraceEnabled(true);
+		printf("Tracing to %s\n", traceFile);
+	}
+
+	// setting SERVER_CAPTURE to a file name records every datagram the server gets, so the session can be played back with the replay tool
+	const char* captureFile = getenv("SERVER_CAPTURE");
+	if (captureFile != NULL)
+	{
+		if (StartCapture(server, captureFile))
+			printf("Capturing to %s\n", captureFile);
+		else
+			printf("Could not capture to %s\n", captureFile);
+	}
+
 	// the server will run forever. If we wanted a way to stop it, we'd set run to false using some code
 	bool run = true;
 
+	double lastTick = enet_time_get() / 1000.0;
+	double lastStatsLog = lastTick;
+
+	BeginAllocTick(&TickAllocations);
+
 	while (run)
 	{
-		ENetEvent event = { 0 };
+		// wait for something to arrive, but not past when the next tick is due
+		double untilTick = lastTick + ServerTickInterval - enet_time_get() / 1000.0;
+		if (untilTick > 0)
+		{
+			enet_uint32 waitCondition = ENET_SOCKET_WAIT_RECEIVE | ENET_SOCKET_WAIT_INTERRUPT;
+			enet_uint32 waitTime = (enet_uint32)(untilTick * 1000.0) + 1;
 
-		// see if there are any inbound network events, wait up to 1000ms before returning.
-		// if the server also did game logic, this timeout should be lowered
-		if (enet_host_service(server, &event, 1000) > 0)
+			TRACE_BEGIN("Wait");
+			enet_socket_wait(server->socket, &waitCondition, waitTime < ServiceTimeout ? waitTime : ServiceTimeout);
+			TRACE_END("Wait");
+		}
+
+		// handle everything that has come in, the waiting above isn't counted so this is just the work
+		// if the tick comes due we stop and leave the rest for after it, so a flood of traffic can't hold up the simulation
+		double receiveStart = GetPreciseTime();
+		for (;;)
 		{
-			// see what kind of event we have
-			switch (event.type)
-			{
+			ENetEvent event = { 0 };
 
-				// a new client is trying to connect
-				case ENET_EVENT_TYPE_CONNECT:
-				{
-					printf("Player Connected\n");
-
-					// find an empty slot, or disconnect them if we are full
-					int playerId = 0;
-					for (; playerId < MAX_PLAYERS; playerId++)
-					{
-						if (!Players[playerId].Active)
-							break;
-					}
-
-					// we are full
-					if (playerId == MAX_PLAYERS)
-					{
-						// I said good day SIR!
-						enet_peer_disconnect(event.peer, 0);
-						break;
-					}
-
-					// player is good, don't give away the slot
-					Players[playerId].Active = true;
-
-					// but don't send out an update to everyone until they give us a good position
-					Players[playerId].ValidPosition = false;
-					Players[playerId].Peer = event.peer;
-
-					// pack up a message to send back to the client to tell them they have been accepted as a player
-					uint8_t buffer[2] = { 0 };
-					buffer[0] = (uint8_t)AcceptPlayer;  // command for the client
-					buffer[1] = (uint8_t)playerId;      // the player ID so they know who they are
-
-					// copy the buffer into an enet packet (TODO : add write functions to go directly to a packet)
-					ENetPacket* packet = enet_packet_create(buffer, 2, ENET_PACKET_FLAG_RELIABLE);
-					// send the data to the user
-					enet_peer_send(event.peer, 0, packet);
-
-					// We have to tell the new client about all the other players that are already on the server
-					// so send them an add message for all existing active players.
-					for (int i = 0; i < MAX_PLAYERS; i++)
-					{
-						// only people who are valid and not the new player
-						if (i == playerId || !Players[i].ValidPosition)
-							continue;
-
-						// pack up an add player message with the ID and the last known position
-						uint8_t addBuffer[10] = { 0 };
-						addBuffer[0] = (uint8_t)AddPlayer;
-						addBuffer[1] = (uint8_t)i;
-						*(int16_t*)(addBuffer + 2) = (int16_t)Players[i].X;
-						*(int16_t*)(addBuffer + 4) = (int16_t)Players[i].Y;
-						*(int16_t*)(addBuffer + 6) = (int16_t)Players[i].DX;
-						*(int16_t*)(addBuffer + 8) = (int16_t)Players[i].DY;
-
-						// Optimally we'd also send other info like name, color, and other static player info.
-
-						// copy and send the message
-						packet = enet_packet_create(addBuffer, 10, ENET_PACKET_FLAG_RELIABLE);
-						enet_peer_send(event.peer, 0, packet);
-
-						// NOTE enet_host_service will handle releasing send packets when the network system has finally sent them,
-						// you don't have to destroy them
-					}
-					break;
-				}
+			TRACE_BEGIN("enet_host_service");
+			int serviceResult = enet_host_service(server, &event, 0);
+			TRACE_END("enet_host_service");
 
-				// someone sent us data
-				case ENET_EVENT_TYPE_RECEIVE:
-				{
-					// find the player who sent the data
-					// we don't need them to send us what ID they are, we know who they are by the peer
-					// we want to trust the client as little as possible so that people can't cheat/hack
-					// if we blindly accepted a player ID, a client could send you updates for someone else :(
-
-					int playerId = GetPlayerId(event.peer);
-					if (playerId == -1)
-					{
-						// they are not one of our peeple, boot them
-						enet_peer_disconnect(event.peer, 0);
-						break;
-					}
-
-					// keep track of how far into the message we are
-					size_t offset = 0;
-
-					// read off the command the client wants us to process
-					NetworkCommands command = ReadByte(event.packet, &offset);
-
-					// we only accept one message from clients for now, so make sure this is what it is
-					if (command == UpdateInput)
-					{
-						// update the location data with the new info
-						Players[playerId].X = ReadShort(event.packet, &offset);
-						Players[playerId].Y = ReadShort(event.packet, &offset);
-						Players[playerId].DX = ReadShort(event.packet, &offset);
-						Players[playerId].DY = ReadShort(event.packet, &offset);
-
-						// lets tell everyone about this new location
-						NetworkCommands outboundCommand = UpdatePlayer;
-
-						// if they are new, send this update as an add player instead of an update
-						if (!Players[playerId].ValidPosition)
-							outboundCommand = AddPlayer;
-
-						// the player has sent us a position, they can be part of future regular updates
-						Players[playerId].ValidPosition = true;
-
-						// pack up the update message with command, player and position
-						uint8_t buffer[10] = { 0 };
-						buffer[0] = (uint8_t)outboundCommand;
-						buffer[1] = (uint8_t)playerId;
-						*(int16_t*)(buffer + 2) = (int16_t)Players[playerId].X;
-						*(int16_t*)(buffer + 4) = (int16_t)Players[playerId].Y;
-						*(int16_t*)(buffer + 6) = (int16_t)Players[playerId].DX;
-						*(int16_t*)(buffer + 8) = (int16_t)Players[playerId].DY;
-
-
-						// Copy and send the data to everyone but the player who sent it  (TODO : add write functions to go directly to a packet)
-						ENetPacket* packet = enet_packet_create(buffer, 10, ENET_PACKET_FLAG_RELIABLE);
-						SendToAllBut(packet, playerId);
-
-						// NOTE enet_host_service will handle releasing send packets when the network system has finally sent them,
-						// you don't have to destroy them
-					}
-
-					// tell enet that it can recycle the inbound packet
-					enet_packet_destroy(event.packet);
-					break;
-				}
-				case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
-				case ENET_EVENT_TYPE_DISCONNECT:
-				{
-					// a player was disconnected
-					printf("Player Disconnected\n");
+			if (serviceResult <= 0)
+				break;
 
-					// find them if they are a real player
-					int playerId = GetPlayerId(event.peer);
-					if (playerId == -1)
-						break;
+			TRACE_BEGIN(GetEventTraceName(event.type));
+			HandleEvent(&event);
+			TRACE_END(GetEventTraceName(event.type));
 
-					// mark them as inactive and clear the peer pointer
-					Players[playerId].Active = false;
-					Players[playerId].Peer = NULL;
+			if (enet_time_get() / 1000.0 - lastTick >= ServerTickInterval)
+				break;
+		}
+		AddStageTime(&Profiler, StageReceive, GetPreciseTime() - receiveStart);
 
-					// Tell everyone that someone left
-					uint8_t buffer[2] = { 0 };
-					buffer[0] = (uint8_t)RemovePlayer;
-					buffer[1] = (uint8_t)playerId;
+		// once a tick, move everyone and send out any updates that are due
+		double now = enet_time_get() / 1000.0;
+		if (now - lastTick >= ServerTickInterval)
+		{
+			int shedLevel = Profiler.ShedLevel;
+			double stageStart = GetPreciseTime();
 
-					// Copy and send the data to everyone but the player who sent it  (TODO : add write functions to go directly to a packet)
-					ENetPacket* packet = enet_packet_create(buffer, 2, ENET_PACKET_FLAG_RELIABLE);
-					SendToAllBut(packet, -1);
+			float deltaT = (float)(now - lastTick);
 
-					// NOTE enet_host_service will handle releasing send packets when the network system has finally sent them,
-					// you don't have to destroy them
+			TRACE_BEGIN("SimulateTick");
+			ExpireSuspendedPlayers(now);
+			SimulateTick(deltaT);
+			lastTick = now;
+			TRACE_END("SimulateTick");
 
-					break;
-				}
+			double stageEnd = GetPreciseTime();
+			AddStageTime(&Profiler, StageSimulate, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-				case ENET_EVENT_TYPE_NONE:
-					break;
+			TRACE_BEGIN("SendSnapshots");
+			SendJoinSnapshots();
+			DropSlowPlayers(now);
+			SendSnapshots(now, deltaT, shedLevel, Profiler.TickCount);
+			TRACE_END("SendSnapshots");
+
+			stageEnd = GetPreciseTime();
+			AddStageTime(&Profiler, StageSerialize, stageEnd - stageStart);
+			stageStart = stageEnd;
+
+			// get the snapshots out now, one packet for each player, instead of waiting for the next time the host is serviced
+			TRACE_BEGIN("enet_host_flush");
+			FlushPlayerMessages();
+			enet_host_flush(server);
+			TRACE_END("enet_host_flush");
+
+			AddStageTime(&Profiler, StageSend, GetPreciseTime() - stageStart);
+
+			const TickRecord* record = EndTick(&Profiler, now);
+			MetricsRecordTick(record->Total);
+			MetricsRecordLoadShedding(Profiler.ShedLevel, record->Overrun);
+
+			if (Profiler.ShedLevel != shedLevel)
+				LogShedLevelChange(record, Profiler.ShedLevel);
+
+			// a tick's allocations include the receiving done since the last one
+			EndAllocTick(&TickAllocations);
+			BeginAllocTick(&TickAllocations);
+
+			// none of this is urgent, so it can wait when we are short on time
+			if (shedLevel < ShedNonCriticalLevel || Profiler.TickCount % NonCriticalTickInterval == 0)
+			{
+				TRACE_BEGIN("PollMetrics");
+				PollMetrics(server);
+				TRACE_END("PollMetrics");
+
+				FlushCapture();
 			}
 		}
+
+		if (now - lastStatsLog >= StatsLogInterval)
+		{
+			LogPlayerStats();
+			LogAllocationStats();
+			lastStatsLog = now;
+		}
+
+		if (traceFile != NULL && now - lastTraceWrite >= TraceWriteInterval)
+		{
+			WriteChromeTrace(traceFile);
+			lastTraceWrite = now;
+		}
 	}
 
 	// cleanup
+	if (traceFile != NULL)
+		WriteChromeTrace(traceFile);
+
+	StopCapture();
+	FreeMovementStore(&Movement);
+	for (int i = 0; i < MAX_PLAYERS; i++)
+		FreePriorityAccumulator(&Players[i].Priority);
+	StopMetrics();
 	enet_host_destroy(server);
 	enet_deinitialize();
 
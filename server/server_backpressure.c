@@ -0,0 +1,63 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "server_backpressure.h"
+#include "net_constants.h"
+
+bool CheckSlowPeer(BackpressureControl* control, const BackpressureConfig* config, double now, ENetPeer* peer)
+{
+	if (UpdateBackpressure(control, config, now, peer) != BackpressureDisconnect)
+		return false;
+
+	// the client keeps its session token, so it can come back and only get what it missed
+	// the disconnect event that comes back later is for a peer that isn't a player any more
+	enet_peer_disconnect(peer, DisconnectTooSlow);
+	return true;
+}
+
+bool BeginPeerSnapshot(BackpressureControl* control, const BackpressureConfig* config, RateControl* rate, const RateControlConfig* rateConfig, double now, ENetPeer* peer, MessageBatch* outgoing, bool* latestOnly)
+{
+	UpdateRateControl(rate, rateConfig, now, peer);
+
+	// backpressure only looks, so the rate controller doesn't use up a send on a snapshot that backpressure holds back
+	if (!BackpressureShouldSend(control, config, now) || !RateControlShouldSend(rate, now))
+		return false;
+	BackpressureMarkSent(control, now);
+
+	// everything already batched goes first, and then each update goes out on its own so a newer one can replace it
+	*latestOnly = control->Level >= BackpressureLatestOnly;
+	if (*latestOnly)
+		FlushMessageBatch(outgoing, peer);
+
+	return true;
+}
+
+bool EndSnapshotUpdate(MessageBatch* outgoing, ENetPeer* peer, bool latestOnly, uint32_t key)
+{
+	return latestOnly && FlushMessageBatchLatest(outgoing, peer, key) == 1;
+}
@@ -0,0 +1,77 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// what the server does with each player's snapshots when their connection backs up
+// the player's backpressure is read once a tick, see UpdateBackpressure in net_rate.h
+// a little backed up and their snapshot updates go out latest only, each in its own packet that replaces the last one about the same entity if it is still waiting
+// too slow to drain and they only get a few snapshots a second, and if that goes on for too long they are disconnected, so enet stops holding data for them
+// everyone else is read and cut back on their own, so a slow player never changes what a healthy one gets
+#pragma once
+
+#include "net_rate.h"
+#include "net_batch.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// <summary>
+/// Read a player's backpressure for this tick, and if they have been too slow for too long, disconnect them.
+/// enet throws away everything waiting for them, the caller still has to take them out of the game
+/// </summary>
+/// <param name="control">The backpressure state of the player</param>
+/// <param name="config">The limits the player is under</param>
+/// <param name="now">The current time in seconds</param>
+/// <param name="peer">The player's connection</param>
+/// <returns>True if the player was disconnected</returns>
+bool CheckSlowPeer(BackpressureControl* control, const BackpressureConfig* config, double now, ENetPeer* peer);
+
+/// <summary>
+/// Check if a player gets a snapshot now, from both their backpressure and their rate controller, and mark it sent if so.
+/// When it goes out latest only, everything already in their batch is sent first, so the updates can go out on their own
+/// </summary>
+/// <param name="control">The backpressure state of the player, read by CheckSlowPeer this tick</param>
+/// <param name="config">The limits the player is under</param>
+/// <param name="rate">The player's rate controller</param>
+/// <param name="rateConfig">The bounds of the rate controller</param>
+/// <param name="now">The current time in seconds</param>
+/// <param name="peer">The player's connection</param>
+/// <param name="outgoing">The player's batch of messages</param>
+/// <param name="latestOnly">Set to true if the snapshot's updates go out latest only</param>
+/// <returns>True if the player gets a snapshot now</returns>
+bool BeginPeerSnapshot(BackpressureControl* control, const BackpressureConfig* config, RateControl* rate, const RateControlConfig* rateConfig, double now, ENetPeer* peer, MessageBatch* outgoing, bool* latestOnly);
+
+/// <summary>
+/// Finish one update in a snapshot, after its messages are batched.
+/// Latest only updates go out now on their own, keyed by the entity they are about, everything else stays in the batch
+/// </summary>
+/// <param name="outgoing">The player's batch of messages, with the update in it</param>
+/// <param name="peer">The player's connection</param>
+/// <param name="latestOnly">What BeginPeerSnapshot said</param>
+/// <param name="key">What the update is the latest of, see enet_peer_send_latest</param>
+/// <returns>True if the update replaced an older one that hadn't gone out yet</returns>
+bool EndSnapshotUpdate(MessageBatch* outgoing, ENetPeer* peer, bool latestOnly, uint32_t key);
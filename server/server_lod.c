@@ -0,0 +1,131 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "server_lod.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+LodConfig DefaultLodConfig()
+{
+	// the field is 1280 by 800, so the near tier is about a quarter of it around the player
+	LodConfig config = { 0 };
+	config.Tiers[0] = (LodTier){ 300, 1 };
+	config.Tiers[1] = (LodTier){ 700, 4 };
+	config.Tiers[2] = (LodTier){ 0, 12 };
+	config.TierCount = 3;
+	return config;
+}
+
+bool ParseLodConfig(const char* text, LodConfig* config)
+{
+	LodConfig parsed = { 0 };
+
+	if (strcmp(text, "off") == 0)
+	{
+		parsed.Tiers[0] = (LodTier){ 0, 1 };
+		parsed.TierCount = 1;
+		*config = parsed;
+		return true;
+	}
+
+	const char* cursor = text;
+	while (*cursor != '\0')
+	{
+		if (parsed.TierCount == MaxLodTiers)
+			return false;
+
+		char* end = NULL;
+		float distance = strtof(cursor, &end);
+		if (end == cursor || *end != ':')
+			return false;
+
+		cursor = end + 1;
+		long interval = strtol(cursor, &end, 10);
+		if (end == cursor || interval < 1)
+			return false;
+
+		// tiers have to go out from the player, the last one can have any distance since it covers everything past the others
+		if (parsed.TierCount > 0 && distance <= parsed.Tiers[parsed.TierCount - 1].MaxDistance && *end != '\0')
+			return false;
+
+		parsed.Tiers[parsed.TierCount++] = (LodTier){ distance, (uint32_t)interval };
+
+		cursor = end;
+		if (*cursor == ',')
+			cursor++;
+		else if (*cursor != '\0')
+			return false;
+	}
+
+	if (parsed.TierCount == 0)
+		return false;
+
+	*config = parsed;
+	return true;
+}
+
+uint32_t GetLodInterval(const LodConfig* config, float distance)
+{
+	for (int i = 0; i < config->TierCount - 1; i++)
+	{
+		if (distance <= config->Tiers[i].MaxDistance)
+			return config->Tiers[i].Interval;
+	}
+
+	return config->TierCount > 0 ? config->Tiers[config->TierCount - 1].Interval : 1;
+}
+
+void GetLodDue(const LodConfig* config, const MovementStore* store, int count, float viewerX, float viewerY, uint64_t tick, const uint64_t* lastSent, uint8_t* due)
+{
+	if (config->TierCount <= 0)
+	{
+		memset(due, 1, count);
+		return;
+	}
+
+	// compare squared distances so there is no square root for each entity
+	float limits[MaxLodTiers] = { 0 };
+	for (int t = 0; t < config->TierCount - 1; t++)
+		limits[t] = config->Tiers[t].MaxDistance * config->Tiers[t].MaxDistance;
+
+	int lastTier = config->TierCount - 1;
+	for (int i = 0; i < count; i++)
+	{
+		float dx = store->X[i] - viewerX;
+		float dy = store->Y[i] - viewerY;
+		float distanceSquared = dx * dx + dy * dy;
+
+		// the tiers go out from the player, so the tier is how many limits the entity is past
+		int tier = 0;
+		for (int t = 0; t < lastTier; t++)
+			tier += distanceSquared > limits[t];
+
+		due[i] = tick - lastSent[i] >= config->Tiers[tier].Interval;
+	}
+}
@@ -0,0 +1,95 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// distance based level of detail for snapshot updates
+// a player needs to see what is right next to them move smoothly, but something across the field can be updated a lot less often without anyone noticing
+// so the distance from a player to an entity puts the entity in a tier, and each tier has how many ticks apart updates about it are sent to that player
+// the client extrapolates and smooths between updates, so longer gaps for far away entities just mean a little less accuracy where it doesn't matter
+#pragma once
+
+#include "server_movement.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// the most tiers a config can have
+#define MaxLodTiers 8
+
+// one band of distance, and how often entities in it are sent
+typedef struct
+{
+	// entities up to this far from the player, in pixels, are in this tier (if they are not in a closer one)
+	float MaxDistance;
+
+	// how many ticks apart updates are sent, 1 is every tick
+	uint32_t Interval;
+}LodTier;
+
+// the tiers, from closest to furthest
+// anything further than the last tier's distance still uses the last tier
+typedef struct
+{
+	LodTier Tiers[MaxLodTiers];
+	int TierCount;
+}LodConfig;
+
+/// <summary>
+/// Get the default tiers, every tick up close, every 4 ticks at mid range, and every 12 ticks far away
+/// </summary>
+/// <returns>The tiers</returns>
+LodConfig DefaultLodConfig();
+
+/// <summary>
+/// Read tiers from text like "300:1,700:4,0:12", a distance and interval for each tier from closest to furthest.
+/// "off" makes one tier that sends everything every tick
+/// </summary>
+/// <param name="text">The text to read</param>
+/// <param name="config">Filled in with the tiers, only changed if the text is good</param>
+/// <returns>False if the text is not a valid list of tiers</returns>
+bool ParseLodConfig(const char* text, LodConfig* config);
+
+/// <summary>
+/// Get how many ticks apart updates are sent for an entity at a distance
+/// </summary>
+/// <param name="config">The tiers</param>
+/// <param name="distance">How far the entity is from the player, in pixels</param>
+/// <returns>The interval of the tier the entity is in</returns>
+uint32_t GetLodInterval(const LodConfig* config, float distance);
+
+/// <summary>
+/// Work out which entities are due for an update to a player this tick
+/// </summary>
+/// <param name="config">The tiers</param>
+/// <param name="store">Where every entity is</param>
+/// <param name="count">How many entities to check, from the start of the store</param>
+/// <param name="viewerX">The X position of the player that is being sent to</param>
+/// <param name="viewerY">The Y position of the player that is being sent to</param>
+/// <param name="tick">The current tick</param>
+/// <param name="lastSent">The tick each entity was last sent to the player</param>
+/// <param name="due">Set to 1 for each entity that is due, 0 for the rest</param>
+void GetLodDue(const LodConfig* config, const MovementStore* store, int count, float viewerX, float viewerY, uint64_t tick, const uint64_t* lastSent, uint8_t* due);
@@ -0,0 +1,435 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "server_metrics.h"
+#include "net_rate.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// one counter slot for every possible command byte
+#define CommandSlots 256
+
+// the upper bounds of the tick time histogram buckets, in seconds
+static const double TickBuckets[] = { 0.0005, 0.001, 0.002, 0.005, 0.010, 0.0167, 0.033 };
+#define TickBucketCount (sizeof(TickBuckets) / sizeof(TickBuckets[0]))
+
+// everything we count
+// the server is single threaded, so these are just numbers, there is nothing to lock
+typedef struct
+{
+	uint64_t MessagesReceived[CommandSlots];
+	uint64_t BytesReceived[CommandSlots];
+	uint64_t MessagesSent[CommandSlots];
+	uint64_t BytesSent[CommandSlots];
+
+	// the host totals are only 32 bits and enet wants us to reset them, so we move them into these every poll
+	uint64_t HostSentData;
+	uint64_t HostSentPackets;
+	uint64_t HostReceivedData;
+	uint64_t HostReceivedPackets;
+	uint64_t HostConnectCookiesSent;
+
+	uint64_t BudgetCuts;
+	uint64_t Superseded;
+	uint64_t SlowDisconnects;
+
+	uint64_t SessionsResumed;
+	uint64_t SessionsExpired;
+
+	int ShedLevel;
+	uint64_t TickOverruns;
+
+	uint64_t TickCount;
+	uint64_t TickBucketCounts[TickBucketCount];
+	double TickSum;
+	double TickLast;
+	double TickMax;
+}ServerMetrics;
+
+static ServerMetrics Metrics = { 0 };
+
+// the text we send out is built here, so answering a request doesn't allocate either
+static char MetricsText[64 * 1024];
+static size_t MetricsTextLength = 0;
+
+#ifndef _WIN32
+static int MetricsSocket = -1;
+static char MetricsPath[sizeof(((struct sockaddr_un*)0)->sun_path)] = { 0 };
+#endif
+
+void MetricsCountReceived(const uint8_t* message, size_t length)
+{
+	if (length < 1)
+		return;
+
+	uint8_t command = message[0];
+	Metrics.MessagesReceived[command]++;
+	Metrics.BytesReceived[command] += length;
+}
+
+void MetricsCountSent(const uint8_t* message, size_t length, int peerCount)
+{
+	if (length < 1)
+		return;
+
+	uint8_t command = message[0];
+	Metrics.MessagesSent[command] += peerCount;
+	Metrics.BytesSent[command] += length * peerCount;
+}
+
+void MetricsCountBudgetCut()
+{
+	Metrics.BudgetCuts++;
+}
+
+void MetricsCountSuperseded()
+{
+	Metrics.Superseded++;
+}
+
+void MetricsCountSlowDisconnect()
+{
+	Metrics.SlowDisconnects++;
+}
+
+void MetricsCountSessionResumed()
+{
+	Metrics.SessionsResumed++;
+}
+
+void MetricsCountSessionExpired()
+{
+	Metrics.SessionsExpired++;
+}
+
+void MetricsRecordLoadShedding(int shedLevel, bool overrun)
+{
+	Metrics.ShedLevel = shedLevel;
+	if (overrun)
+		Metrics.TickOverruns++;
+}
+
+void MetricsRecordTick(double seconds)
+{
+	Metrics.TickCount++;
+	Metrics.TickSum += seconds;
+	Metrics.TickLast = seconds;
+	if (seconds > Metrics.TickMax)
+		Metrics.TickMax = seconds;
+
+	for (size_t i = 0; i < TickBucketCount; i++)
+	{
+		if (seconds <= TickBuckets[i])
+			Metrics.TickBucketCounts[i]++;
+	}
+}
+
+// add some text to the output, anything that doesn't fit is cut off
+static void AppendMetrics(const char* format, ...)
+{
+	if (MetricsTextLength >= sizeof(MetricsText))
+		return;
+
+	va_list args;
+	va_start(args, format);
+	int written = vsnprintf(MetricsText + MetricsTextLength, sizeof(MetricsText) - MetricsTextLength, format, args);
+	va_end(args);
+
+	if (written > 0)
+		MetricsTextLength += (size_t)written;
+
+	if (MetricsTextLength > sizeof(MetricsText))
+		MetricsTextLength = sizeof(MetricsText);
+}
+
+// write out the per command counters for one direction
+static void AppendCommandCounters(const char* name, const char* help, const uint64_t* counters)
+{
+	AppendMetrics("# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+	for (int i = 0; i < CommandSlots; i++)
+	{
+		if (counters[i] != 0)
+			AppendMetrics("%s{command=\"%s\",id=\"%d\"} %llu\n", name, GetCommandName((uint8_t)i), i, (unsigned long long)counters[i]);
+	}
+}
+
+// write out the enet protocol and header traffic of a peer or the host, the help and type lines are written by the caller
+static void AppendProtocolTraffic(const char* name, const char* labels, const TrafficCounter* counters, const TrafficCounter* headers)
+{
+	for (int i = 0; i < ProtocolCommandSlots; i++)
+	{
+		if (counters[i].Bytes != 0)
+			AppendMetrics("%s{%scommand=\"%s\"} %llu\n", name, labels, GetProtocolCommandName((uint8_t)i), (unsigned long long)counters[i].Bytes);
+	}
+	AppendMetrics("%s{%scommand=\"header\"} %llu\n", name, labels, (unsigned long long)headers->Bytes);
+}
+
+// write out the application message traffic of a peer, the help and type lines are written by the caller
+static void AppendMessageTraffic(const char* name, const char* labels, const TrafficCounter* counters)
+{
+	for (int i = 0; i < MessageCommandSlots; i++)
+	{
+		if (counters[i].Bytes != 0)
+			AppendMetrics("%s{%scommand=\"%s\",id=\"%d\"} %llu\n", name, labels, GetCommandName((uint8_t)i), i, (unsigned long long)counters[i].Bytes);
+	}
+}
+
+// write the traffic of every connected peer with one of the functions above
+#define AppendPeerTraffic(name, help, append, ...) \
+	do { \
+		AppendMetrics("# HELP %s %s\n# TYPE %s counter\n", name, help, name); \
+		for (size_t i = 0; i < host->peerCount; i++) \
+		{ \
+			ENetPeer* peer = &host->peers[i]; \
+			if (peer->state != ENET_PEER_STATE_CONNECTED) \
+				continue; \
+			char labels[32]; \
+			snprintf(labels, sizeof(labels), "peer=\"%u\",", (unsigned)peer->incomingPeerID); \
+			append(name, labels, __VA_ARGS__); \
+		} \
+	} while (0)
+
+// write out a gauge or counter for every connected peer
+#define AppendPeerMetric(name, type, help, format, value) \
+	do { \
+		AppendMetrics("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type); \
+		for (size_t i = 0; i < host->peerCount; i++) \
+		{ \
+			ENetPeer* peer = &host->peers[i]; \
+			if (peer->state != ENET_PEER_STATE_CONNECTED) \
+				continue; \
+			AppendMetrics("%s{peer=\"%u\"} " format "\n", name, (unsigned)peer->incomingPeerID, value); \
+		} \
+	} while (0)
+
+// what is waiting to go out to each peer, read once per peer for all of the backpressure metrics, indexed like host->peers
+// a host can't have more peers than this, and keeping it here means answering a request still doesn't allocate
+static PeerBackpressure PeerPressure[ENET_PROTOCOL_MAXIMUM_PEER_ID];
+
+// build the full text of the metrics
+static void BuildMetricsText(ENetHost* host)
+{
+	MetricsTextLength = 0;
+
+	AppendMetrics("# HELP raylib_server_sent_bytes_total UDP payload bytes sent by the host\n# TYPE raylib_server_sent_bytes_total counter\nraylib_server_sent_bytes_total %llu\n", (unsigned long long)Metrics.HostSentData);
+	AppendMetrics("# HELP raylib_server_sent_packets_total UDP packets sent by the host\n# TYPE raylib_server_sent_packets_total counter\nraylib_server_sent_packets_total %llu\n", (unsigned long long)Metrics.HostSentPackets);
+	AppendMetrics("# HELP raylib_server_received_bytes_total UDP payload bytes received by the host\n# TYPE raylib_server_received_bytes_total counter\nraylib_server_received_bytes_total %llu\n", (unsigned long long)Metrics.HostReceivedData);
+	AppendMetrics("# HELP raylib_server_received_packets_total UDP packets received by the host\n# TYPE raylib_server_received_packets_total counter\nraylib_server_received_packets_total %llu\n", (unsigned long long)Metrics.HostReceivedPackets);
+	AppendMetrics("# HELP raylib_server_connect_cookies_sent_total Connect cookies sent to connects that did not have one\n# TYPE raylib_server_connect_cookies_sent_total counter\nraylib_server_connect_cookies_sent_total %llu\n", (unsigned long long)Metrics.HostConnectCookiesSent);
+	AppendMetrics("# HELP raylib_server_connected_peers Peers that are connected\n# TYPE raylib_server_connected_peers gauge\nraylib_server_connected_peers %u\n", (unsigned)host->connectedPeers);
+
+	AppendPeerMetric("raylib_server_peer_rtt_ms", "gauge", "Smoothed round trip time", "%u", (unsigned)peer->roundTripTime);
+	AppendPeerMetric("raylib_server_peer_rtt_variance_ms", "gauge", "Round trip time variance", "%u", (unsigned)peer->roundTripTimeVariance);
+	AppendPeerMetric("raylib_server_peer_packet_loss_ratio", "gauge", "Mean reliable packet loss", "%f", peer->packetLoss / (double)ENET_PEER_PACKET_LOSS_SCALE);
+	AppendPeerMetric("raylib_server_peer_packets_sent_total", "counter", "Packets sent to the peer", "%llu", (unsigned long long)peer->totalPacketsSent);
+	AppendPeerMetric("raylib_server_peer_packets_lost_total", "counter", "Packets to the peer that were lost", "%llu", (unsigned long long)peer->totalPacketsLost);
+	AppendPeerMetric("raylib_server_peer_sent_bytes_total", "counter", "Bytes sent to the peer", "%llu", (unsigned long long)peer->totalDataSent);
+	AppendPeerMetric("raylib_server_peer_received_bytes_total", "counter", "Bytes received from the peer", "%llu", (unsigned long long)peer->totalDataReceived);
+	AppendPeerMetric("raylib_server_peer_reliable_in_transit_bytes", "gauge", "Reliable data sent and not acknowledged yet", "%u", (unsigned)peer->reliableDataInTransit);
+
+	// each metric has to be written for every peer before the next one starts, so the readings are taken first and shared
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		if (host->peers[i].state == ENET_PEER_STATE_CONNECTED)
+			GetPeerBackpressure(&host->peers[i], &PeerPressure[i]);
+	}
+	AppendMetrics("# HELP raylib_server_peer_queued_bytes Data waiting to be sent to the peer\n# TYPE raylib_server_peer_queued_bytes gauge\n");
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		if (host->peers[i].state == ENET_PEER_STATE_CONNECTED)
+			AppendMetrics("raylib_server_peer_queued_bytes{peer=\"%u\"} %zu\n", (unsigned)host->peers[i].incomingPeerID, PeerPressure[i].QueuedBytes);
+	}
+	AppendMetrics("# HELP raylib_server_peer_queued_commands Commands waiting to be sent to the peer\n# TYPE raylib_server_peer_queued_commands gauge\n");
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		if (host->peers[i].state == ENET_PEER_STATE_CONNECTED)
+			AppendMetrics("raylib_server_peer_queued_commands{peer=\"%u\"} %u\n", (unsigned)host->peers[i].incomingPeerID, PeerPressure[i].QueuedCommands);
+	}
+	AppendMetrics("# HELP raylib_server_peer_drain_seconds How long the data waiting for the peer and in transit should take to get through\n# TYPE raylib_server_peer_drain_seconds gauge\n");
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		if (host->peers[i].state == ENET_PEER_STATE_CONNECTED)
+			AppendMetrics("raylib_server_peer_drain_seconds{peer=\"%u\"} %f\n", (unsigned)host->peers[i].incomingPeerID, PeerPressure[i].DrainTime);
+	}
+
+	AppendMetrics("# HELP raylib_server_protocol_sent_bytes_total Bytes sent by enet protocol command, including message data, before compression\n# TYPE raylib_server_protocol_sent_bytes_total counter\n");
+	AppendProtocolTraffic("raylib_server_protocol_sent_bytes_total", "", host->traffic.ProtocolSent, &host->traffic.HeadersSent);
+	AppendMetrics("# HELP raylib_server_protocol_received_bytes_total Bytes received by enet protocol command, including message data, before compression\n# TYPE raylib_server_protocol_received_bytes_total counter\n");
+	AppendProtocolTraffic("raylib_server_protocol_received_bytes_total", "", host->traffic.ProtocolReceived, &host->traffic.HeadersReceived);
+
+	AppendPeerTraffic("raylib_server_peer_protocol_sent_bytes_total", "Bytes sent to the peer by enet protocol command", AppendProtocolTraffic, peer->traffic.ProtocolSent, &peer->traffic.HeadersSent);
+	AppendPeerTraffic("raylib_server_peer_protocol_received_bytes_total", "Bytes received from the peer by enet protocol command", AppendProtocolTraffic, peer->traffic.ProtocolReceived, &peer->traffic.HeadersReceived);
+	AppendPeerTraffic("raylib_server_peer_message_sent_bytes_total", "Message bytes sent to the peer by command", AppendMessageTraffic, peer->traffic.MessagesSent);
+	AppendPeerTraffic("raylib_server_peer_message_received_bytes_total", "Message bytes received from the peer by command", AppendMessageTraffic, peer->traffic.MessagesReceived);
+
+	AppendMetrics("# HELP raylib_server_budget_cuts_total Snapshots cut short because the player was over their byte budget\n# TYPE raylib_server_budget_cuts_total counter\nraylib_server_budget_cuts_total %llu\n", (unsigned long long)Metrics.BudgetCuts);
+	AppendMetrics("# HELP raylib_server_superseded_updates_total Latest only updates that replaced an older one about the same player before it was sent\n# TYPE raylib_server_superseded_updates_total counter\nraylib_server_superseded_updates_total %llu\n", (unsigned long long)Metrics.Superseded);
+	AppendMetrics("# HELP raylib_server_slow_disconnects_total Players disconnected because their connection could not keep up\n# TYPE raylib_server_slow_disconnects_total counter\nraylib_server_slow_disconnects_total %llu\n", (unsigned long long)Metrics.SlowDisconnects);
+	AppendMetrics("# HELP raylib_server_sessions_resumed_total Players who got their slot back after their connection dropped\n# TYPE raylib_server_sessions_resumed_total counter\nraylib_server_sessions_resumed_total %llu\n", (unsigned long long)Metrics.SessionsResumed);
+	AppendMetrics("# HELP raylib_server_sessions_expired_total Players whose connection dropped and who did not come back in time\n# TYPE raylib_server_sessions_expired_total counter\nraylib_server_sessions_expired_total %llu\n", (unsigned long long)Metrics.SessionsExpired);
+	AppendMetrics("# HELP raylib_server_tick_overruns_total Ticks that took longer than the tick period\n# TYPE raylib_server_tick_overruns_total counter\nraylib_server_tick_overruns_total %llu\n", (unsigned long long)Metrics.TickOverruns);
+	AppendMetrics("# HELP raylib_server_load_shed_level How much work the server is skipping to keep up, 0 is none\n# TYPE raylib_server_load_shed_level gauge\nraylib_server_load_shed_level %d\n", Metrics.ShedLevel);
+
+	AppendCommandCounters("raylib_server_messages_received_total", "Messages received by command", Metrics.MessagesReceived);
+	AppendCommandCounters("raylib_server_message_bytes_received_total", "Message bytes received by command", Metrics.BytesReceived);
+	AppendCommandCounters("raylib_server_messages_sent_total", "Messages sent by command, counting each peer", Metrics.MessagesSent);
+	AppendCommandCounters("raylib_server_message_bytes_sent_total", "Message bytes sent by command, counting each peer", Metrics.BytesSent);
+
+	AppendMetrics("# HELP raylib_server_tick_seconds Time spent in a server tick\n# TYPE raylib_server_tick_seconds histogram\n");
+	for (size_t i = 0; i < TickBucketCount; i++)
+		AppendMetrics("raylib_server_tick_seconds_bucket{le=\"%g\"} %llu\n", TickBuckets[i], (unsigned long long)Metrics.TickBucketCounts[i]);
+	AppendMetrics("raylib_server_tick_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)Metrics.TickCount);
+	AppendMetrics("raylib_server_tick_seconds_sum %f\nraylib_server_tick_seconds_count %llu\n", Metrics.TickSum, (unsigned long long)Metrics.TickCount);
+	AppendMetrics("# HELP raylib_server_tick_last_seconds Time the last tick took\n# TYPE raylib_server_tick_last_seconds gauge\nraylib_server_tick_last_seconds %f\n", Metrics.TickLast);
+	AppendMetrics("# HELP raylib_server_tick_max_seconds Longest tick so far\n# TYPE raylib_server_tick_max_seconds gauge\nraylib_server_tick_max_seconds %f\n", Metrics.TickMax);
+}
+
+// move the host totals into our 64 bit counters before the 32 bit ones can wrap
+static void CollectHostTotals(ENetHost* host)
+{
+	Metrics.HostSentData += host->totalSentData;
+	Metrics.HostSentPackets += host->totalSentPackets;
+	Metrics.HostReceivedData += host->totalReceivedData;
+	Metrics.HostReceivedPackets += host->totalReceivedPackets;
+	Metrics.HostConnectCookiesSent += host->totalConnectCookiesSent;
+	host->totalSentData = 0;
+	host->totalSentPackets = 0;
+	host->totalReceivedData = 0;
+	host->totalReceivedPackets = 0;
+	host->totalConnectCookiesSent = 0;
+}
+
+#ifndef _WIN32
+
+bool StartMetrics(const char* path)
+{
+	struct sockaddr_un address = { 0 };
+	if (strlen(path) >= sizeof(address.sun_path))
+		return false;
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	MetricsSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (MetricsSocket < 0)
+		return false;
+
+	// clean up a socket file left behind by an old server
+	unlink(path);
+
+	// polling must never block the server loop
+	fcntl(MetricsSocket, F_SETFL, fcntl(MetricsSocket, F_GETFL, 0) | O_NONBLOCK);
+
+	if (bind(MetricsSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(MetricsSocket, 4) != 0)
+	{
+		close(MetricsSocket);
+		MetricsSocket = -1;
+		return false;
+	}
+
+	strcpy(MetricsPath, path);
+	return true;
+}
+
+void StopMetrics()
+{
+	if (MetricsSocket < 0)
+		return;
+
+	close(MetricsSocket);
+	MetricsSocket = -1;
+	unlink(MetricsPath);
+}
+
+// send the metrics to one reader, as a minimal HTTP response so curl and scrapers that speak HTTP over a UNIX socket can read it
+static void AnswerMetrics(int connection)
+{
+	char header[128];
+	int headerLength = snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %u\r\n\r\n", (unsigned)MetricsTextLength);
+
+	int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+	flags |= MSG_NOSIGNAL;
+#endif
+
+	// a reader that can't take it all right away just gets cut off, we never wait on them
+	if (send(connection, header, headerLength, flags) == headerLength)
+		send(connection, MetricsText, MetricsTextLength, flags);
+}
+
+void PollMetrics(ENetHost* host)
+{
+	CollectHostTotals(host);
+
+	if (MetricsSocket < 0)
+		return;
+
+	int connection = accept(MetricsSocket, NULL, NULL);
+	if (connection < 0)
+		return;
+
+#ifdef SO_NOSIGPIPE
+	int noSignal = 1;
+	setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+
+	BuildMetricsText(host);
+	AnswerMetrics(connection);
+	close(connection);
+}
+
+#else
+
+// UNIX domain sockets are not available on every version of windows, so there is no endpoint there, the counters still work
+
+bool StartMetrics(const char* path)
+{
+	(void)path;
+	return false;
+}
+
+void StopMetrics()
+{
+}
+
+void PollMetrics(ENetHost* host)
+{
+	CollectHostTotals(host);
+}
+
+#endif
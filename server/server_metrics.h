@@ -0,0 +1,113 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// live server metrics
+// counters are plain numbers that the server bumps as it works, nothing on that path locks or allocates
+// once a tick the server polls a local UNIX domain socket, and anyone who connects gets a copy of the metrics in the Prometheus text format
+// for example: curl --unix-socket /tmp/raylib_networking_server.sock http://localhost/metrics
+#pragma once
+
+#include "net_common.h"
+
+#include <stdbool.h>
+
+// where the metrics socket is created
+#define MetricsSocketPath "/tmp/raylib_networking_server.sock"
+
+/// <summary>
+/// Create the metrics socket. If it can't be made the server keeps running without it
+/// </summary>
+/// <param name="path">The file path to create the socket at</param>
+/// <returns>True if the socket is listening</returns>
+bool StartMetrics(const char* path);
+
+/// <summary>
+/// Close the metrics socket and remove it
+/// </summary>
+void StopMetrics();
+
+/// <summary>
+/// Count a message we got from a client
+/// </summary>
+/// <param name="message">The message that was received, the first byte is the command</param>
+/// <param name="length">The size of the message</param>
+void MetricsCountReceived(const uint8_t* message, size_t length);
+
+/// <summary>
+/// Count a message we are sending
+/// </summary>
+/// <param name="message">The message that is being sent, the first byte is the command</param>
+/// <param name="length">The size of the message</param>
+/// <param name="peerCount">How many peers it is being sent to</param>
+void MetricsCountSent(const uint8_t* message, size_t length, int peerCount);
+
+/// <summary>
+/// Count a time a player's snapshot was cut short because they were over their byte budget
+/// </summary>
+void MetricsCountBudgetCut();
+
+/// <summary>
+/// Count a latest only update that replaced an older one about the same player before it was sent
+/// </summary>
+void MetricsCountSuperseded();
+
+/// <summary>
+/// Count a player who was disconnected because their connection couldn't keep up, even with their updates cut back
+/// </summary>
+void MetricsCountSlowDisconnect();
+
+/// <summary>
+/// Count a player who came back after their connection dropped, and got their old slot back
+/// </summary>
+void MetricsCountSessionResumed();
+
+/// <summary>
+/// Count a player whose connection dropped and who didn't come back before their slot was given up
+/// </summary>
+void MetricsCountSessionExpired();
+
+/// <summary>
+/// Record how long one server tick took
+/// </summary>
+/// <param name="seconds">The time the tick took</param>
+void MetricsRecordTick(double seconds);
+
+/// <summary>
+/// Record the load shedding state after a tick
+/// </summary>
+/// <param name="shedLevel">The current load shedding level, 0 when nothing is being shed</param>
+/// <param name="overrun">True if the tick took longer than the tick period</param>
+void MetricsRecordLoadShedding(int shedLevel, bool overrun);
+
+/// <summary>
+/// Move the host traffic totals into the metrics and answer anyone waiting on the metrics socket.
+/// Call this once a tick
+/// </summary>
+/// <param name="host">The server host</param>
+void PollMetrics(ENetHost* host);
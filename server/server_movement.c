@@ -0,0 +1,225 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "server_movement.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// use SSE when the compiler says we have it, every x64 CPU does, and NEON on 64 bit ARM
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOVEMENT_USE_SSE
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MOVEMENT_USE_NEON
+#include <arm_neon.h>
+#endif
+
+// the field limits for the top left corner of a player
+#define MovementMaxX ((float)(FieldSizeWidth - PlayerSize))
+#define MovementMaxY ((float)(FieldSizeHeight - PlayerSize))
+
+bool InitMovementStore(MovementStore* store, int capacity)
+{
+	// round up to a whole number of blocks of 4
+	store->Capacity = (capacity + 3) & ~3;
+
+	store->X = (float*)calloc(store->Capacity, sizeof(float));
+	store->Y = (float*)calloc(store->Capacity, sizeof(float));
+	store->VX = (float*)calloc(store->Capacity, sizeof(float));
+	store->VY = (float*)calloc(store->Capacity, sizeof(float));
+
+	if (store->X == NULL || store->Y == NULL || store->VX == NULL || store->VY == NULL)
+	{
+		FreeMovementStore(store);
+		return false;
+	}
+
+	return true;
+}
+
+void FreeMovementStore(MovementStore* store)
+{
+	free(store->X);
+	free(store->Y);
+	free(store->VX);
+	free(store->VY);
+
+	memset(store, 0, sizeof(MovementStore));
+}
+
+// keep a value within a distance of where it was
+static float ClampStep(float value, float current, float maxStep)
+{
+	if (value > current + maxStep)
+		return current + maxStep;
+
+	if (value < current - maxStep)
+		return current - maxStep;
+
+	return value;
+}
+
+void SetMovementInput(MovementStore* store, int index, float x, float y, float vx, float vy, float maxStep)
+{
+	if (index < 0 || index >= store->Capacity)
+		return;
+
+	if (maxStep >= 0)
+	{
+		x = ClampStep(x, store->X[index], maxStep);
+		y = ClampStep(y, store->Y[index], maxStep);
+	}
+
+	store->X[index] = x;
+	store->Y[index] = y;
+	store->VX[index] = vx;
+	store->VY[index] = vy;
+}
+
+void StopMovement(MovementStore* store, int index)
+{
+	if (index < 0 || index >= store->Capacity)
+		return;
+
+	store->VX[index] = 0;
+	store->VY[index] = 0;
+}
+
+#ifdef MOVEMENT_USE_SSE
+
+void StepMovement(MovementStore* store, float deltaT, float maxSpeed)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 dt = _mm_set1_ps(deltaT);
+	const __m128 speed = _mm_set1_ps(maxSpeed);
+	const __m128 speedSquared = _mm_set1_ps(maxSpeed * maxSpeed);
+	const __m128 maxX = _mm_set1_ps(MovementMaxX);
+	const __m128 maxY = _mm_set1_ps(MovementMaxY);
+
+	for (int i = 0; i < store->Capacity; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(store->X + i);
+		__m128 y = _mm_loadu_ps(store->Y + i);
+		__m128 vx = _mm_loadu_ps(store->VX + i);
+		__m128 vy = _mm_loadu_ps(store->VY + i);
+
+		// scale down anything going faster than the limit, the mask keeps everyone else (and anyone standing still) at a scale of 1
+		__m128 lengthSquared = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+		__m128 tooFast = _mm_cmpgt_ps(lengthSquared, speedSquared);
+		__m128 limit = _mm_div_ps(speed, _mm_sqrt_ps(_mm_max_ps(lengthSquared, speedSquared)));
+		__m128 scale = _mm_or_ps(_mm_and_ps(tooFast, limit), _mm_andnot_ps(tooFast, _mm_set1_ps(1.0f)));
+		vx = _mm_mul_ps(vx, scale);
+		vy = _mm_mul_ps(vy, scale);
+
+		// move and keep them on the field
+		x = _mm_add_ps(x, _mm_mul_ps(vx, dt));
+		y = _mm_add_ps(y, _mm_mul_ps(vy, dt));
+		x = _mm_min_ps(_mm_max_ps(x, zero), maxX);
+		y = _mm_min_ps(_mm_max_ps(y, zero), maxY);
+
+		_mm_storeu_ps(store->X + i, x);
+		_mm_storeu_ps(store->Y + i, y);
+		_mm_storeu_ps(store->VX + i, vx);
+		_mm_storeu_ps(store->VY + i, vy);
+	}
+}
+
+#elif defined(MOVEMENT_USE_NEON)
+
+void StepMovement(MovementStore* store, float deltaT, float maxSpeed)
+{
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t speed = vdupq_n_f32(maxSpeed);
+	const float32x4_t speedSquared = vdupq_n_f32(maxSpeed * maxSpeed);
+	const float32x4_t maxX = vdupq_n_f32(MovementMaxX);
+	const float32x4_t maxY = vdupq_n_f32(MovementMaxY);
+
+	for (int i = 0; i < store->Capacity; i += 4)
+	{
+		float32x4_t x = vld1q_f32(store->X + i);
+		float32x4_t y = vld1q_f32(store->Y + i);
+		float32x4_t vx = vld1q_f32(store->VX + i);
+		float32x4_t vy = vld1q_f32(store->VY + i);
+
+		// scale down anything going faster than the limit, the select keeps everyone else at a scale of 1
+		float32x4_t lengthSquared = vmlaq_f32(vmulq_f32(vx, vx), vy, vy);
+		uint32x4_t tooFast = vcgtq_f32(lengthSquared, speedSquared);
+		float32x4_t limit = vdivq_f32(speed, vsqrtq_f32(vmaxq_f32(lengthSquared, speedSquared)));
+		float32x4_t scale = vbslq_f32(tooFast, limit, vdupq_n_f32(1.0f));
+		vx = vmulq_f32(vx, scale);
+		vy = vmulq_f32(vy, scale);
+
+		// move and keep them on the field
+		x = vminq_f32(vmaxq_f32(vmlaq_n_f32(x, vx, deltaT), zero), maxX);
+		y = vminq_f32(vmaxq_f32(vmlaq_n_f32(y, vy, deltaT), zero), maxY);
+
+		vst1q_f32(store->X + i, x);
+		vst1q_f32(store->Y + i, y);
+		vst1q_f32(store->VX + i, vx);
+		vst1q_f32(store->VY + i, vy);
+	}
+}
+
+#else
+
+// plain C version, written so the compiler can vectorize it on its own
+// there are no branches and the arrays are marked restrict so the compiler knows they don't overlap
+// GCC and Clang will only vectorize the square root when math errno and FP trapping are turned off (-O3 -fno-math-errno -fno-trapping-math)
+void StepMovement(MovementStore* store, float deltaT, float maxSpeed)
+{
+	float* restrict x = store->X;
+	float* restrict y = store->Y;
+	float* restrict vx = store->VX;
+	float* restrict vy = store->VY;
+
+	const float speedSquared = maxSpeed * maxSpeed;
+	const int count = store->Capacity;
+
+	for (int i = 0; i < count; i++)
+	{
+		// the limit is worked out for everyone and then picked with a select, so there is no branch for the compiler to trip on
+		float lengthSquared = vx[i] * vx[i] + vy[i] * vy[i];
+		float limit = maxSpeed / sqrtf(lengthSquared > speedSquared ? lengthSquared : speedSquared);
+		float scale = lengthSquared > speedSquared ? limit : 1.0f;
+		vx[i] *= scale;
+		vy[i] *= scale;
+
+		// these are written as compares instead of fminf/fmaxf so they map straight onto vector min/max instructions
+		float newX = x[i] + vx[i] * deltaT;
+		float newY = y[i] + vy[i] * deltaT;
+		newX = newX < 0.0f ? 0.0f : newX;
+		newY = newY < 0.0f ? 0.0f : newY;
+		x[i] = newX > MovementMaxX ? MovementMaxX : newX;
+		y[i] = newY > MovementMaxY ? MovementMaxY : newY;
+	}
+}
+
+#endif
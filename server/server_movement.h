@@ -0,0 +1,99 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// server side movement simulation
+// player state is kept as a structure of arrays, one array per value, so that the whole world can be moved in one tight loop
+// that the compiler (or the SSE code below) can run on several players at a time
+#pragma once
+
+#include "net_constants.h"
+
+#include <stdbool.h>
+
+// the fastest anyone is allowed to move, in pixels per second
+// the client moves at 200, the extra is slack for frame timing
+#define MaxPlayerSpeed 250.0f
+
+// the movement state of every entity in the world
+typedef struct
+{
+	// how many entities there is room for, this is always a multiple of 4 so the loops never have a partial block
+	int Capacity;
+
+	// the position of each entity on the field
+	float* X;
+	float* Y;
+
+	// the velocity of each entity in pixels per second
+	float* VX;
+	float* VY;
+}MovementStore;
+
+/// <summary>
+/// Allocate the arrays for a movement store, every entity starts at 0,0 and is not moving
+/// </summary>
+/// <param name="store">The store to set up</param>
+/// <param name="capacity">How many entities it needs to hold</param>
+/// <returns>False if we are out of memory</returns>
+bool InitMovementStore(MovementStore* store, int capacity);
+
+/// <summary>
+/// Free the arrays for a movement store
+/// </summary>
+/// <param name="store">The store to clean up</param>
+void FreeMovementStore(MovementStore* store);
+
+/// <summary>
+/// Take a position and velocity that a client sent us.
+/// The position is only allowed to be maxStep away from where we think the entity is, on each axis, so clients can't teleport
+/// </summary>
+/// <param name="store">The store the entity is in</param>
+/// <param name="index">The entity the input is for</param>
+/// <param name="x">The X position the client says it is at</param>
+/// <param name="y">The Y position the client says it is at</param>
+/// <param name="vx">The X velocity the client says it is moving at</param>
+/// <param name="vy">The Y velocity the client says it is moving at</param>
+/// <param name="maxStep">How far the position can move from where we think it is, use a negative value to accept any position</param>
+void SetMovementInput(MovementStore* store, int index, float x, float y, float vx, float vy, float maxStep);
+
+/// <summary>
+/// Stop an entity where it is
+/// </summary>
+/// <param name="store">The store the entity is in</param>
+/// <param name="index">The entity to stop</param>
+void StopMovement(MovementStore* store, int index);
+
+/// <summary>
+/// Move every entity in the store forward by one tick.
+/// Velocities are limited to maxSpeed, then added to the positions, then the positions are kept inside the field
+/// </summary>
+/// <param name="store">The store to update</param>
+/// <param name="deltaT">How long the tick is in seconds</param>
+/// <param name="maxSpeed">The fastest anything can move in pixels per second</param>
+void StepMovement(MovementStore* store, float deltaT, float maxSpeed);
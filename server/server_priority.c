@@ -0,0 +1,212 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "server_priority.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+PriorityConfig DefaultPriorityConfig()
+{
+	PriorityConfig config = { 0 };
+	config.BaseRate = 1.0f;
+	config.VelocityRate = 1.0f / MaxPlayerSpeed;   // moving at full speed along one axis doubles the rate
+	config.HalfDistance = 400.0f;                  // about a third of the field
+	return config;
+}
+
+bool InitPriorityAccumulator(PriorityAccumulator* accumulator, int capacity)
+{
+	accumulator->Capacity = capacity;
+	accumulator->Priority = (float*)calloc(capacity, sizeof(float));
+	accumulator->Candidates = (PriorityCandidate*)calloc(capacity, sizeof(PriorityCandidate));
+
+	if (accumulator->Priority == NULL || accumulator->Candidates == NULL)
+	{
+		FreePriorityAccumulator(accumulator);
+		return false;
+	}
+
+	return true;
+}
+
+void FreePriorityAccumulator(PriorityAccumulator* accumulator)
+{
+	free(accumulator->Priority);
+	free(accumulator->Candidates);
+
+	memset(accumulator, 0, sizeof(PriorityAccumulator));
+}
+
+void ClearPriorities(PriorityAccumulator* accumulator)
+{
+	memset(accumulator->Priority, 0, accumulator->Capacity * sizeof(float));
+}
+
+void AccumulatePriorities(PriorityAccumulator* accumulator, const PriorityConfig* config, const MovementStore* store, int count,
+	float viewerX, float viewerY, const uint8_t* changed, float deltaT)
+{
+	if (count > accumulator->Capacity)
+		count = accumulator->Capacity;
+
+	float halfDistanceSquared = config->HalfDistance * config->HalfDistance;
+	float baseRate = config->BaseRate * deltaT;
+	float velocityRate = config->VelocityRate * deltaT;
+	float* priority = accumulator->Priority;
+
+	// no branches and no square roots so the compiler can vectorize this
+	// the distance weight is h^2 / (h^2 + d^2), 1 right next to the viewer, 0.5 at the half distance, and dropping off quickly after that
+	// speed is |vx| + |vy|, which is never more than 1.5 times the real speed, close enough for deciding who goes first
+	for (int i = 0; i < count; i++)
+	{
+		float dx = store->X[i] - viewerX;
+		float dy = store->Y[i] - viewerY;
+		float distanceSquared = dx * dx + dy * dy;
+		float speed = fabsf(store->VX[i]) + fabsf(store->VY[i]);
+
+		float grown = priority[i] + (baseRate + velocityRate * speed) * halfDistanceSquared / (halfDistanceSquared + distanceSquared);
+		priority[i] = changed[i] ? grown : 0.0f;
+	}
+}
+
+// swap two entries in the candidate list
+static void SwapCandidates(PriorityCandidate* candidates, int a, int b)
+{
+	PriorityCandidate temp = candidates[a];
+	candidates[a] = candidates[b];
+	candidates[b] = temp;
+}
+
+// put the candidates with more priority than a pivot in front of it, and the rest after, returns where the pivot ended up
+static int PartitionCandidates(PriorityCandidate* candidates, int first, int last)
+{
+	// the middle is a good enough pivot, and doesn't fall over when the list is already sorted
+	SwapCandidates(candidates, (first + last) / 2, last);
+	float pivot = candidates[last].Priority;
+
+	int store = first;
+	for (int i = first; i < last; i++)
+	{
+		if (candidates[i].Priority > pivot)
+			SwapCandidates(candidates, i, store++);
+	}
+	SwapCandidates(candidates, store, last);
+	return store;
+}
+
+// quickselect, moves the keep candidates with the most priority to the front of the list
+// afterwards the last one kept has the least priority of them
+static void KeepTopCandidates(PriorityCandidate* candidates, int count, int keep)
+{
+	int first = 0;
+	int last = count - 1;
+	while (first < last)
+	{
+		int pivot = PartitionCandidates(candidates, first, last);
+		if (pivot == keep - 1)
+			break;
+		else if (pivot < keep - 1)
+			first = pivot + 1;
+		else
+			last = pivot - 1;
+	}
+}
+
+// sort by priority, highest first, only used on the few that are picked
+static void SortCandidates(PriorityCandidate* candidates, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		PriorityCandidate candidate = candidates[i];
+		int j = i;
+		for (; j > 0 && candidates[j - 1].Priority < candidate.Priority; j--)
+			candidates[j] = candidates[j - 1];
+		candidates[j] = candidate;
+	}
+}
+
+int SelectTopPriorities(PriorityAccumulator* accumulator, int count, int maxSelected, int* selected)
+{
+	if (count > accumulator->Capacity)
+		count = accumulator->Capacity;
+	if (maxSelected > accumulator->Capacity)
+		maxSelected = accumulator->Capacity;
+
+	if (maxSelected <= 0)
+		return 0;
+
+	const float* priority = accumulator->Priority;
+	PriorityCandidate* candidates = accumulator->Candidates;
+
+	// collect anything that could be in the top in a buffer twice the size we need, and when it fills up, cut it back to the best half
+	// the least priority that survives the cut is the new bar to get in, so after the first few cuts almost every entity is turned away by one compare
+	// that keeps this about linear in the number of entities, sorting them all, or keeping a heap of the best, is much slower when there are thousands
+	int bufferSize = maxSelected * 2 < accumulator->Capacity ? maxSelected * 2 : accumulator->Capacity;
+	int candidateCount = 0;
+	float threshold = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		float value = priority[i];
+		if (value <= threshold)
+			continue;
+
+		if (candidateCount == bufferSize)
+		{
+			KeepTopCandidates(candidates, candidateCount, maxSelected);
+			candidateCount = maxSelected;
+			threshold = candidates[maxSelected - 1].Priority;
+
+			if (value <= threshold)
+				continue;
+		}
+
+		candidates[candidateCount].Priority = value;
+		candidates[candidateCount].Index = i;
+		candidateCount++;
+	}
+
+	if (candidateCount > maxSelected)
+	{
+		KeepTopCandidates(candidates, candidateCount, maxSelected);
+		candidateCount = maxSelected;
+	}
+
+	SortCandidates(candidates, candidateCount);
+	for (int i = 0; i < candidateCount; i++)
+		selected[i] = candidates[i].Index;
+
+	return candidateCount;
+}
+
+void ResetPriority(PriorityAccumulator* accumulator, int index)
+{
+	if (index >= 0 && index < accumulator->Capacity)
+		accumulator->Priority[index] = 0;
+}
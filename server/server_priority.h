@@ -0,0 +1,128 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// priority accumulator for snapshot updates
+// when a player's snapshot can't fit everything that changed, something has to wait, and this decides what
+// every entity with news for a player builds up priority each tick, faster when it is close to the player and when it is moving quickly
+// each snapshot sends the entities with the most priority that fit, and resets them to 0, so anything left out keeps growing until it gets a turn
+// priorities are one array per player, in the same order as the movement store, so growing them is one tight loop even with thousands of entities
+#pragma once
+
+#include "server_movement.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// how fast priority builds up
+typedef struct
+{
+	// priority per second that every entity with news gets
+	float BaseRate;
+
+	// extra priority per second, for each pixel per second the entity is moving on each axis
+	float VelocityRate;
+
+	// how far away, in pixels, an entity's priority builds at half the rate of one right next to the player
+	float HalfDistance;
+}PriorityConfig;
+
+// an entity that could be picked, with its priority copied next to it so picking doesn't jump around in memory
+typedef struct
+{
+	float Priority;
+	int Index;
+}PriorityCandidate;
+
+// the priority of every entity, from the point of view of one player
+typedef struct
+{
+	int Capacity;
+
+	// how much priority each entity has built up since it was last sent, 0 if the player is up to date on it
+	float* Priority;
+
+	// room for the entities SelectTopPriorities is picking from
+	PriorityCandidate* Candidates;
+}PriorityAccumulator;
+
+/// <summary>
+/// Get the default settings for how fast priority builds up
+/// </summary>
+/// <returns>The settings</returns>
+PriorityConfig DefaultPriorityConfig();
+
+/// <summary>
+/// Allocate the arrays for a priority accumulator, everything starts with no priority
+/// </summary>
+/// <param name="accumulator">The accumulator to set up</param>
+/// <param name="capacity">How many entities it needs to hold</param>
+/// <returns>False if we are out of memory</returns>
+bool InitPriorityAccumulator(PriorityAccumulator* accumulator, int capacity);
+
+/// <summary>
+/// Free the arrays for a priority accumulator
+/// </summary>
+/// <param name="accumulator">The accumulator to clean up</param>
+void FreePriorityAccumulator(PriorityAccumulator* accumulator);
+
+/// <summary>
+/// Set every entity's priority back to 0
+/// </summary>
+/// <param name="accumulator">The accumulator to clear</param>
+void ClearPriorities(PriorityAccumulator* accumulator);
+
+/// <summary>
+/// Build up priority for one tick. Entities that have news grow based on their distance from the viewer and their speed, the rest go to 0
+/// </summary>
+/// <param name="accumulator">The accumulator for the player that is being sent to</param>
+/// <param name="config">How fast priority builds up</param>
+/// <param name="store">Where every entity is and how fast it is going</param>
+/// <param name="count">How many entities to update, from the start of the store</param>
+/// <param name="viewerX">The X position of the player that is being sent to</param>
+/// <param name="viewerY">The Y position of the player that is being sent to</param>
+/// <param name="changed">For each entity, non zero if it has news the player hasn't been sent</param>
+/// <param name="deltaT">How long since priorities were last built up, in seconds</param>
+void AccumulatePriorities(PriorityAccumulator* accumulator, const PriorityConfig* config, const MovementStore* store, int count,
+	float viewerX, float viewerY, const uint8_t* changed, float deltaT);
+
+/// <summary>
+/// Pick the entities with the most priority, highest first
+/// </summary>
+/// <param name="accumulator">The accumulator to pick from</param>
+/// <param name="count">How many entities to look at, from the start of the accumulator</param>
+/// <param name="maxSelected">The most entities to pick</param>
+/// <param name="selected">Filled in with the picked entities, must have room for maxSelected</param>
+/// <returns>How many entities were picked, only entities with some priority are picked</returns>
+int SelectTopPriorities(PriorityAccumulator* accumulator, int count, int maxSelected, int* selected);
+
+/// <summary>
+/// Mark an entity as sent, its priority starts building again from 0
+/// </summary>
+/// <param name="accumulator">The accumulator for the player it was sent to</param>
+/// <param name="index">The entity that was sent</param>
+void ResetPriority(PriorityAccumulator* accumulator, int index);
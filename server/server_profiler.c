@@ -0,0 +1,128 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "server_profiler.h"
+
+#include <string.h>
+
+LoadShedConfig DefaultLoadShedConfig(double tickPeriod)
+{
+	LoadShedConfig config = { 0 };
+	config.Enabled = true;
+	config.TickPeriod = tickPeriod;
+	config.OverrunFraction = 1.0;   // using the whole period means the next tick is going to be late
+	config.RecoverFraction = 0.5;   // with half the period to spare, it is safe to do more again
+	config.RecoverTicks = 120;      // two seconds at 60 ticks a second, so the level doesn't flap
+	config.MaxLevel = 4;
+	return config;
+}
+
+void InitTickProfiler(TickProfiler* profiler, const LoadShedConfig* config)
+{
+	memset(profiler, 0, sizeof(TickProfiler));
+	profiler->Config = *config;
+}
+
+void AddStageTime(TickProfiler* profiler, TickStage stage, double seconds)
+{
+	profiler->Current[stage] += (float)seconds;
+}
+
+const TickRecord* EndTick(TickProfiler* profiler, double time)
+{
+	TickRecord* record = &profiler->History[profiler->TickCount % TickHistorySize];
+	profiler->TickCount++;
+
+	record->Time = time;
+	record->Total = 0;
+	for (int i = 0; i < StageCount; i++)
+	{
+		record->Stages[i] = profiler->Current[i];
+		record->Total += profiler->Current[i];
+		profiler->Current[i] = 0;
+	}
+
+	const LoadShedConfig* config = &profiler->Config;
+	record->ShedLevel = profiler->ShedLevel;
+	record->Overrun = record->Total > config->TickPeriod * config->OverrunFraction;
+
+	if (record->Overrun)
+		profiler->Overruns++;
+
+	if (!config->Enabled)
+		return record;
+
+	// back off quickly when we are overloaded, but only recover after a good run of fast ticks
+	if (record->Overrun)
+	{
+		profiler->CalmTicks = 0;
+		if (profiler->ShedLevel < config->MaxLevel)
+			profiler->ShedLevel++;
+	}
+	else if (record->Total < config->TickPeriod * config->RecoverFraction)
+	{
+		profiler->CalmTicks++;
+		if (profiler->CalmTicks >= config->RecoverTicks && profiler->ShedLevel > 0)
+		{
+			profiler->ShedLevel--;
+			profiler->CalmTicks = 0;
+		}
+	}
+	else
+	{
+		profiler->CalmTicks = 0;
+	}
+
+	return record;
+}
+
+const TickRecord* GetTickRecord(const TickProfiler* profiler, int ticksAgo)
+{
+	if (ticksAgo < 0 || (uint64_t)ticksAgo >= profiler->TickCount || ticksAgo >= TickHistorySize)
+		return NULL;
+
+	return &profiler->History[(profiler->TickCount - 1 - ticksAgo) % TickHistorySize];
+}
+
+const char* GetTickStageName(TickStage stage)
+{
+	switch (stage)
+	{
+	case StageReceive:
+		return "receive";
+	case StageSimulate:
+		return "simulate";
+	case StageSerialize:
+		return "serialize";
+	case StageSend:
+		return "send";
+	default:
+		return "unknown";
+	}
+}
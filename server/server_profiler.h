@@ -0,0 +1,148 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+// server tick profiler
+// times each stage of every tick (receiving, simulating, building snapshots and sending) and keeps the last few hundred ticks in a ring buffer
+// when a tick takes longer than the tick period the server is overloaded, so the profiler raises a load shedding level that the server
+// uses to cut back on work that can wait, and lowers it again once ticks have been comfortably fast for a while
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// how many ticks of history are kept
+#define TickHistorySize 256
+
+// the parts of a tick that are timed
+typedef enum
+{
+	StageReceive = 0,   // handling network events since the last tick
+	StageSimulate,      // moving everyone forward
+	StageSerialize,     // working out and building the snapshots
+	StageSend,          // flushing everything out to the network
+	StageCount
+}TickStage;
+
+// the timing of one tick
+typedef struct
+{
+	// when the tick happened, in seconds
+	double Time;
+
+	// how long each stage took, and all of them together, in seconds
+	float Stages[StageCount];
+	float Total;
+
+	// the load shedding level the tick ran at
+	int ShedLevel;
+
+	// true if the tick took longer than the tick period
+	bool Overrun;
+}TickRecord;
+
+// when to shed load and when to stop
+typedef struct
+{
+	// false to only measure, and never shed load
+	bool Enabled;
+
+	// how long a tick is meant to take, in seconds
+	double TickPeriod;
+
+	// a tick that takes longer than this fraction of the period is an overrun, and raises the shed level
+	double OverrunFraction;
+
+	// ticks must be faster than this fraction of the period, for RecoverTicks in a row, to lower the shed level
+	double RecoverFraction;
+	int RecoverTicks;
+
+	// the highest shed level
+	int MaxLevel;
+}LoadShedConfig;
+
+// the profiler state
+typedef struct
+{
+	LoadShedConfig Config;
+
+	// the stage times of the tick that is in progress
+	float Current[StageCount];
+
+	TickRecord History[TickHistorySize];
+	uint64_t TickCount;
+	uint64_t Overruns;
+
+	int ShedLevel;
+	int CalmTicks;
+}TickProfiler;
+
+/// <summary>
+/// Get the default load shedding settings for a tick period
+/// </summary>
+/// <param name="tickPeriod">How long a tick is meant to take, in seconds</param>
+/// <returns>The settings</returns>
+LoadShedConfig DefaultLoadShedConfig(double tickPeriod);
+
+/// <summary>
+/// Set up a profiler with no history
+/// </summary>
+/// <param name="profiler">The profiler to set up</param>
+/// <param name="config">The load shedding settings to use</param>
+void InitTickProfiler(TickProfiler* profiler, const LoadShedConfig* config);
+
+/// <summary>
+/// Add time to a stage of the current tick. A stage can be added to more than once, receiving usually is
+/// </summary>
+/// <param name="profiler">The profiler</param>
+/// <param name="stage">The stage the time was spent in</param>
+/// <param name="seconds">How long it took</param>
+void AddStageTime(TickProfiler* profiler, TickStage stage, double seconds);
+
+/// <summary>
+/// Finish the current tick, store it in the history, and update the load shedding level
+/// </summary>
+/// <param name="profiler">The profiler</param>
+/// <param name="time">When the tick happened, in seconds</param>
+/// <returns>The record of the tick that was just finished</returns>
+const TickRecord* EndTick(TickProfiler* profiler, double time);
+
+/// <summary>
+/// Get a tick from the history
+/// </summary>
+/// <param name="profiler">The profiler</param>
+/// <param name="ticksAgo">0 for the last finished tick, 1 for the one before that, and so on</param>
+/// <returns>The tick, or NULL if it is not in the history</returns>
+const TickRecord* GetTickRecord(const TickProfiler* profiler, int ticksAgo);
+
+/// <summary>
+/// Get the name of a tick stage, for logs
+/// </summary>
+/// <param name="stage">The stage</param>
+/// <returns>The name of the stage</returns>
+const char* GetTickStageName(TickStage stage);
@@ -0,0 +1,86 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "server_session.h"
+#include "net_common.h"
+
+#include <string.h>
+
+void SeedSessionTokens(SessionTokenSource* source, const uint8_t* key)
+{
+	memset(source, 0, sizeof(SessionTokenSource));
+	if (key == NULL)
+		return;
+
+	memcpy(source->Key, key, SessionTokenKeySize);
+	source->Enabled = true;
+}
+
+uint32_t NextSessionToken(SessionTokenSource* source)
+{
+	if (!source->Enabled)
+		return 0;
+
+	// the same keyed hash that signs connect cookies, a new counter every call so no two tokens come from the same input
+	for (;;)
+	{
+		uint64_t counter = ++source->Counter;
+		uint64_t hash = enet_siphash(source->Key, (const uint8_t*)&counter, sizeof(counter));
+
+		uint32_t token = (uint32_t)(hash ^ (hash >> 32));
+		if (token != 0)
+			return token;
+	}
+}
+
+int GetResumeDelta(int count, const uint8_t* present, const uint32_t* versions, uint32_t* sentVersions, const uint32_t* sentMessages, uint32_t messagesReceived, const uint8_t* knownMask, uint8_t* remove)
+{
+	int resend = 0;
+	for (int i = 0; i < count; i++)
+	{
+		bool known = (knownMask[i / 8] & (1 << (i % 8))) != 0;
+
+		// gone while they were away, or gone before they heard about it
+		if (!present[i])
+		{
+			remove[i] = known;
+			sentVersions[i] = 0;
+			continue;
+		}
+		remove[i] = 0;
+
+		// the messages are reliable and in order, so if they got the message that had our last update, they have that version
+		if (!known || sentMessages[i] > messagesReceived)
+			sentVersions[i] = 0;
+
+		if (sentVersions[i] != versions[i])
+			resend++;
+	}
+
+	return resend;
+}
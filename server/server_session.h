@@ -0,0 +1,84 @@
+/**********************************************************************************************
+*
+*   raylib_networking_smaple * a sample network game using raylib and enet
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2023 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+// session resumption
+// when a player's connection drops, their slot is held for them for a while instead of being given up right away
+// if they come back in time with the session token they were given, they get the same slot back, and everyone else never sees them leave
+// the client keeps its copy of the world while it reconnects, so the server only has to send what the client missed, not the whole world again
+// the client says how many messages it got on its last connection, and which entities it still has, and that is checked against what the server sent
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// how long a dropped player's slot is held for them, in seconds
+#define SessionGracePeriod 15.0
+
+// the size of the secret key session tokens are made with
+#define SessionTokenKeySize 16
+
+// where session tokens come from, a SipHash of a counter with a secret key
+// anyone can get as many tokens of their own as they like, so without the key they must say nothing about anyone else's
+typedef struct
+{
+	uint64_t Key[2];
+	uint64_t Counter;
+
+	// false when there was no good random source for the key, then nobody gets a token and sessions can't be resumed
+	bool Enabled;
+}SessionTokenSource;
+
+/// <summary>
+/// Set up the source of session tokens
+/// </summary>
+/// <param name="source">The token source to set up</param>
+/// <param name="key">SessionTokenKeySize bytes from a good random source, or NULL if there isn't one, which turns sessions off</param>
+void SeedSessionTokens(SessionTokenSource* source, const uint8_t* key);
+
+/// <summary>
+/// Make a new session token, never 0 unless sessions are off, since 0 means a client doesn't have one
+/// </summary>
+/// <param name="source">The token source, moved forward</param>
+/// <returns>The token</returns>
+uint32_t NextSessionToken(SessionTokenSource* source);
+
+/// <summary>
+/// Work out what a returning player missed while they were away.
+/// Anything the client had, but that we sent after the last message it got, or that has changed since, needs to be sent again.
+/// Anything the client has that is gone needs to be removed
+/// </summary>
+/// <param name="count">How many entities there are</param>
+/// <param name="present">1 for each entity that is in the world now, not counting the player</param>
+/// <param name="versions">The current version of each entity</param>
+/// <param name="sentVersions">The version of each entity we last sent to the player, set to 0 for every entity the client doesn't have a good copy of</param>
+/// <param name="sentMessages">For each entity, the number of the message on the old connection that last told the player about it</param>
+/// <param name="messagesReceived">How many messages the client says it got on the old connection</param>
+/// <param name="knownMask">One bit for each entity the client still has</param>
+/// <param name="remove">Set to 1 for each entity the client has that needs to be removed, 0 for the rest</param>
+/// <returns>How many entities need to be sent</returns>
+int GetResumeDelta(int count, const uint8_t* present, const uint32_t* versions, uint32_t* sentVersions, const uint32_t* sentMessages, uint32_t messagesReceived, const uint8_t* knownMask, uint8_t* remove);